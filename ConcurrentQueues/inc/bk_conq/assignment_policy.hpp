@@ -0,0 +1,170 @@
+/*
+* File:   assignment_policy.hpp
+* Author: Barath Kannan
+* Policies that decide which subqueue a producer thread of a multi queue uses,
+* and the order in which a consumer thread visits the subqueues.
+* An assignment policy is constructed with the number of subqueues and provides
+* acquire(), which assigns a subqueue to the calling producer thread, release(index),
+* which is called when that thread exits, hitlist(), which returns the initial
+* subqueue visiting order for the calling consumer thread, and home(), which assigns
+* a subqueue to a consumer thread that owns one (see dequeue_policy.hpp).
+* Created on 14 October 2026 9:30 PM
+*/
+
+#ifndef BK_CONQ_ASSIGNMENT_POLICY_HPP
+#define BK_CONQ_ASSIGNMENT_POLICY_HPP
+
+#include <vector>
+#include <mutex>
+#include <numeric>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <bk_conq/details/bits.hpp>
+#include <bk_conq/details/xorshift.hpp>
+#include <bk_conq/details/topology.hpp>
+
+namespace bk_conq {
+
+//subqueues are handed out in turn, released subqueues are reused first
+//lock-free, released subqueues are tracked in a bitmask, so a subqueue that is released
+//several times before it is reused is only handed out once ahead of the round robin
+class round_robin_assignment {
+public:
+    round_robin_assignment(size_t subqueues) : _subqueues(subqueues), _released((subqueues + 63) / 64) {}
+
+    size_t acquire() {
+        for (size_t w = 0; w < _released.size(); ++w) {
+            uint64_t word = _released[w].load(std::memory_order_relaxed);
+            while (word) {
+                if (_released[w].compare_exchange_weak(word, word & (word - 1), std::memory_order_acquire)) {
+                    return w * 64 + details::lowest_set_bit(word);
+                }
+            }
+        }
+        return _index.fetch_add(1, std::memory_order_relaxed) % _subqueues;
+    }
+
+    void release(size_t index) {
+        _released[index / 64].fetch_or(uint64_t(1) << (index % 64), std::memory_order_release);
+    }
+
+    std::vector<size_t> hitlist() {
+        std::vector<size_t> hitlist(_subqueues);
+        std::iota(hitlist.begin(), hitlist.end(), 0);
+        return hitlist;
+    }
+
+    size_t home() {
+        return _home_index.fetch_add(1, std::memory_order_relaxed) % _subqueues;
+    }
+
+private:
+    const size_t _subqueues;
+    std::vector<std::atomic<uint64_t>> _released;
+    std::atomic<size_t> _index{ 0 };
+    std::atomic<size_t> _home_index{ 0 };
+};
+
+//each producer thread is given a subqueue at random when it first enqueues, and keeps it
+//suited to the relaxed two_choice_dequeue, where it spreads producers without coordination between them
+class random_assignment {
+public:
+    random_assignment(size_t subqueues) : _subqueues(subqueues) {}
+
+    size_t acquire() {
+        return pick();
+    }
+
+    void release(size_t) {}
+
+    std::vector<size_t> hitlist() {
+        std::vector<size_t> hitlist(_subqueues);
+        std::iota(hitlist.begin(), hitlist.end(), 0);
+        return hitlist;
+    }
+
+    size_t home() {
+        return pick();
+    }
+
+private:
+    //the thread seed is mixed with a counter, so that consecutive calls from one thread differ
+    size_t pick() {
+        details::xorshift rng(details::xorshift::thread_seed() ^ (_calls.fetch_add(1, std::memory_order_relaxed) * 0x9e3779b97f4a7c15ull));
+        return rng.next() % _subqueues;
+    }
+
+    const size_t _subqueues;
+    std::atomic<uint64_t> _calls{ 0 };
+};
+
+//subqueues are grouped by the NUMA node or L3 cache domain of LEVEL
+//producers are given the least used subqueue of the domain they are running on when they first enqueue,
+//and consumers visit the subqueues of their own domain before those of other domains
+//when there are fewer subqueues than domains, domains share subqueues
+template <topology_level LEVEL = topology_level::numa_node>
+class topology_assignment {
+public:
+    topology_assignment(size_t subqueues) :
+        _topology(details::cpu_topology::get(LEVEL)),
+        _groups(_topology.domains()),
+        _producers(subqueues, 0),
+        _homes(_groups.size(), 0)
+    {
+        size_t domains = _groups.size();
+        if (subqueues >= domains) {
+            for (size_t i = 0; i < subqueues; ++i) _groups[i % domains].push_back(i);
+        }
+        else {
+            for (size_t d = 0; d < domains; ++d) _groups[d].push_back(d % subqueues);
+        }
+    }
+
+    size_t acquire() {
+        const std::vector<size_t>& local = _groups[_topology.current_domain() % _groups.size()];
+        std::lock_guard<std::mutex> lock(_m);
+        size_t ret = *std::min_element(local.begin(), local.end(), [&](size_t a, size_t b) {
+            return _producers[a] < _producers[b];
+        });
+        ++_producers[ret];
+        return ret;
+    }
+
+    void release(size_t index) {
+        std::lock_guard<std::mutex> lock(_m);
+        --_producers[index];
+    }
+
+    std::vector<size_t> hitlist() {
+        const std::vector<size_t>& local = _groups[_topology.current_domain() % _groups.size()];
+        std::vector<size_t> hitlist(local);
+        for (size_t i = 0; i < _producers.size(); ++i) {
+            if (std::find(local.begin(), local.end(), i) == local.end()) hitlist.push_back(i);
+        }
+        return hitlist;
+    }
+
+    //consumers are spread over the subqueues of their own domain
+    size_t home() {
+        size_t domain = _topology.current_domain() % _groups.size();
+        std::lock_guard<std::mutex> lock(_m);
+        return _groups[domain][(_homes[domain]++) % _groups[domain].size()];
+    }
+
+private:
+    const details::cpu_topology& _topology;
+    std::vector<std::vector<size_t>> _groups;
+    //number of live producer threads assigned to each subqueue
+    std::vector<size_t> _producers;
+    //number of consumers given a home in each domain
+    std::vector<size_t> _homes;
+    std::mutex _m;
+};
+
+typedef topology_assignment<topology_level::numa_node> numa_assignment;
+
+}//namespace bk_conq
+
+#endif // BK_CONQ_ASSIGNMENT_POLICY_HPP
@@ -0,0 +1,311 @@
+/*
+ * File:   async_queue.hpp
+ * Author: Barath Kannan
+ * Adapter providing awaitable enqueue/dequeue operations for C++20 coroutines,
+ * the sibling of the blocking adapters for code that must not block a thread.
+ * co_await q.dequeue() suspends the coroutine while the queue is empty, and
+ * co_await q.enqueue(x) suspends it while a bounded queue is full. A suspended
+ * coroutine is parked in a lock-free waiter list of its side of the queue, the
+ * thread whose operation makes progress possible retries the parked operations
+ * and resumes the coroutines that succeed through the executor, which is any
+ * callable taking a std::coroutine_handle<>.
+ * Only available when the compiler supports coroutines, BK_CONQ_HAS_COROUTINES
+ * is then defined, the header is empty otherwise so C++14 builds are unaffected.
+ * Created on 14 October 2026 11:59 PM
+ */
+
+#ifndef BK_CONQ_ASYNC_QUEUE_HPP
+#define BK_CONQ_ASYNC_QUEUE_HPP
+
+#if defined(__has_include)
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#define BK_CONQ_HAS_COROUTINES
+#endif
+#endif
+
+#ifdef BK_CONQ_HAS_COROUTINES
+
+#include <bk_conq/bounded_queue.hpp>
+#include <bk_conq/unbounded_queue.hpp>
+#include <bk_conq/wait_policy.hpp>
+#include <atomic>
+#include <coroutine>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace bk_conq {
+
+//resumes the coroutine on the thread that made its operation possible
+class inline_executor {
+public:
+    void operator()(std::coroutine_handle<> handle) const {
+        handle.resume();
+    }
+};
+
+//EXECUTOR may be a reference type, so that an executor owned elsewhere is shared by several queues
+template <typename T, typename EXECUTOR = inline_executor>
+class async_queue : private T {
+    static constexpr bool bounded = std::is_base_of<bk_conq::bounded_queue_tag, T>::value;
+
+    //a suspended operation, the thread that takes it from a waiter list owns it until it is resumed or parked again
+    class waiter {
+    public:
+        virtual bool complete() = 0;
+
+        waiter* _next = nullptr;
+        std::coroutine_handle<> _handle;
+
+    protected:
+        ~waiter() = default;
+    };
+
+    //a stack of waiters that is only ever taken as a whole, so no waiter is read once it has been resumed
+    class waiter_list {
+    public:
+        void push(waiter* first, waiter* last) {
+            waiter* head = _head.load(std::memory_order_relaxed);
+            do {
+                last->_next = head;
+            } while (!_head.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        waiter* take() {
+            return _head.exchange(nullptr, std::memory_order_seq_cst);
+        }
+
+        //a waker holds the waiters it has taken until it parks them again, so a notifier that finds a waker
+        //active wakes as well, and the epoch it advances makes the active wakers retry their waiters
+        size_t begin_wake() {
+            _wakers.fetch_add(1, std::memory_order_seq_cst);
+            return _epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+        }
+
+        void end_wake() {
+            _wakers.fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        size_t epoch() const {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return _epoch.load(std::memory_order_relaxed);
+        }
+
+        //pairs with the fences in park and wake, so either the notifier sees the waiters
+        //or the waiter's check of the queue sees the notifier's change
+        bool has_waiters() const {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return _head.load(std::memory_order_relaxed) != nullptr || _wakers.load(std::memory_order_relaxed) != 0;
+        }
+
+    private:
+        std::atomic<waiter*> _head{ nullptr };
+        std::atomic<size_t> _wakers{ 0 };
+        std::atomic<size_t> _epoch{ 0 };
+    };
+
+public:
+    typedef typename T::value_type value_type;
+
+    class dequeue_awaiter : private waiter {
+    public:
+        dequeue_awaiter(const dequeue_awaiter&) = delete;
+        void operator=(const dequeue_awaiter&) = delete;
+
+        bool await_ready() {
+            return complete();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            this->_handle = handle;
+            return _q->park(this, _q->_consumers);
+        }
+
+        //an empty optional means the queue was closed and is empty
+        std::optional<value_type> await_resume() {
+            if (_item) _q->dequeued();
+            return std::move(_item);
+        }
+
+    private:
+        friend async_queue;
+
+        explicit dequeue_awaiter(async_queue* q) : _q(q) {}
+
+        bool complete() override {
+            return _q->T::mc_consume([this](value_type& item) { _item.emplace(std::move(item)); }) || _q->is_closed();
+        }
+
+        async_queue* _q;
+        std::optional<value_type> _item;
+    };
+
+    class enqueue_awaiter : private waiter {
+    public:
+        enqueue_awaiter(const enqueue_awaiter&) = delete;
+        void operator=(const enqueue_awaiter&) = delete;
+
+        bool await_ready() {
+            return complete();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            this->_handle = handle;
+            return _q->park(this, _q->_producers);
+        }
+
+        queue_status await_resume() {
+            if (!_enqueued) return queue_status::closed;
+            _q->notify(_q->_consumers);
+            return queue_status::success;
+        }
+
+    private:
+        friend async_queue;
+
+        template <typename R>
+        enqueue_awaiter(async_queue* q, R&& input) : _q(q), _item(std::forward<R>(input)) {}
+
+        //the item is left untouched by a failed enqueue, so the operation can be retried
+        bool complete() override {
+            if constexpr (bounded) {
+                return _q->is_closed() || (_enqueued = _q->T::mp_emplace(std::move(_item)));
+            }
+            else {
+                _q->T::mp_emplace(std::move(_item));
+                return _enqueued = true;
+            }
+        }
+
+        async_queue* _q;
+        value_type _item;
+        bool _enqueued = false;
+    };
+
+    template <typename... Args>
+    async_queue(EXECUTOR executor, Args&&... args) : T(args...), _executor(std::forward<EXECUTOR>(executor)) {
+        static_assert(bounded || std::is_base_of<bk_conq::unbounded_queue_tag, T>::value, "T must be a bounded or unbounded queue");
+    }
+
+    //coroutines still parked when the queue is destroyed are never resumed, close the queue and let them finish first
+    virtual ~async_queue() {};
+
+    //resumes every parked coroutine, dequeues return an empty optional once the queue is empty and enqueues
+    //to a bounded queue return queue_status::closed without enqueueing
+    void close() {
+        _closed.store(true, std::memory_order_seq_cst);
+        wake(_consumers);
+        wake(_producers);
+    }
+
+    bool is_closed() const {
+        return _closed.load(std::memory_order_acquire);
+    }
+
+    using T::size_approx;
+    using T::empty_approx;
+
+    dequeue_awaiter dequeue() {
+        return dequeue_awaiter(this);
+    }
+
+    //the item is held by the awaiter until it is enqueued, an unbounded queue never suspends
+    template <typename R>
+    enqueue_awaiter enqueue(R&& input) {
+        return enqueue_awaiter(this, std::forward<R>(input));
+    }
+
+    template <typename R>
+    bool try_dequeue(R& output) {
+        if (!T::mc_dequeue(output)) return false;
+        dequeued();
+        return true;
+    }
+
+    template <typename R>
+    bool try_enqueue(R&& input) {
+        if constexpr (bounded) {
+            if (!T::mp_enqueue(std::forward<R>(input))) return false;
+        }
+        else {
+            T::mp_enqueue(std::forward<R>(input));
+        }
+        notify(_consumers);
+        return true;
+    }
+
+private:
+    //whether an operation parked on list may now succeed
+    bool ready(const waiter_list& list) const {
+        if (is_closed()) return true;
+        if (&list == &_consumers) return !T::empty_approx();
+        if constexpr (bounded) {
+            return T::size_approx() < T::capacity();
+        }
+        else {
+            return true;
+        }
+    }
+
+    //parks w, and if the queue may have changed before w was visible to the notifiers, makes a pass over the
+    //waiters in which w may complete here. returns whether the coroutine suspends, w is not touched again
+    //once it may have been taken
+    bool park(waiter* w, waiter_list& list) {
+        list.push(w, w);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return !(ready(list) && wake(list, w));
+    }
+
+    void notify(waiter_list& list) {
+        if (list.has_waiters()) wake(list);
+    }
+
+    void dequeued() {
+        if constexpr (bounded) {
+            notify(_producers);
+        }
+    }
+
+    //takes the waiters parked on list and retries their operations, those that succeed are resumed through
+    //the executor and the rest are parked again. another pass is only made if a notifier arrived meanwhile.
+    //returns whether self was taken and succeeded, it is then left to the caller rather than resumed
+    bool wake(waiter_list& list, waiter* self = nullptr) {
+        bool self_completed = false;
+        size_t epoch = list.begin_wake();
+        while (true) {
+            waiter* first = nullptr;
+            waiter* last = nullptr;
+            for (waiter* w = list.take(); w; ) {
+                waiter* next = w->_next;
+                if (!w->complete()) {
+                    w->_next = first;
+                    first = w;
+                    if (!last) last = w;
+                }
+                else if (w == self) {
+                    self_completed = true;
+                }
+                else {
+                    _executor(w->_handle);
+                }
+                w = next;
+            }
+            if (first) list.push(first, last);
+            size_t current = list.epoch();
+            if (current == epoch) break;
+            epoch = current;
+        }
+        list.end_wake();
+        return self_completed;
+    }
+
+    EXECUTOR _executor;
+    std::atomic<bool> _closed{ false };
+    waiter_list _consumers;
+    waiter_list _producers;
+};
+}//namespace bk_conq
+
+#endif // BK_CONQ_HAS_COROUTINES
+
+#endif /* BK_CONQ_ASYNC_QUEUE_HPP */
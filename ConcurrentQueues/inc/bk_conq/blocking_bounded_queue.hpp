@@ -9,14 +9,17 @@
 #define BK_CONQ_BLOCKINGBOUNDEDQUEUE_HPP
 
 #include <bk_conq/bounded_queue.hpp>
-#include <mutex>
-#include <condition_variable>
+#include <bk_conq/wait_policy.hpp>
+#include <bk_conq/details/consume_iterator.hpp>
+#include <bk_conq/details/ref_iterator.hpp>
 #include <atomic>
+#include <chrono>
 #include <type_traits>
+#include <iterator>
 
 namespace bk_conq {
 
-template <typename T>
+template <typename T, typename WAIT = eventcount_wait_policy<>>
 class blocking_bounded_queue : private T {
 public:
 
@@ -27,93 +30,326 @@ public:
 
     virtual ~blocking_bounded_queue() {};
 
+    //wakes all blocked producers and consumers
+    //blocking enqueues return queue_status::closed without enqueueing
+    //blocking dequeues return queue_status::closed once the queue is empty
+    void close() {
+        _closed.store(true, std::memory_order_seq_cst);
+        _not_empty.notify_all();
+        _not_full.notify_all();
+    }
+
+    bool is_closed() const {
+        return _closed.load(std::memory_order_acquire);
+    }
+
+    using T::size_approx;
+    using T::empty_approx;
+    using T::capacity;
+
     template <typename R>
     bool try_sp_enqueue(R&& input) {
         if (T::sp_enqueue(std::forward<R>(input))) {
-            _cv.notify_one();
+            _not_empty.notify_one();
             return true;
         }
         return false;
     }
 
     template <typename R>
-    void sp_enqueue(R&& input) {
-        if (!T::sp_enqueue(std::forward<R>(input))) {
-            std::unique_lock<std::mutex> lock(_m2);
-            while (!T::sp_enqueue(std::forward<R>(input))) {
-                _cv2.wait(lock);
-            }
+    queue_status sp_enqueue(R&& input) {
+        bool enqueued = false;
+        _not_full.wait([&]() { return is_closed() || (enqueued = T::sp_enqueue(std::forward<R>(input))); });
+        return enqueued_status(enqueued);
+    }
+
+    template <typename R, typename Clock, typename Duration>
+    queue_status sp_enqueue_until(R&& input, const std::chrono::time_point<Clock, Duration>& deadline) {
+        bool enqueued = false;
+        if (!_not_full.wait_until([&]() { return is_closed() || (enqueued = T::sp_enqueue(std::forward<R>(input))); }, deadline)) {
+            return queue_status::timeout;
         }
-        _cv.notify_one();
+        return enqueued_status(enqueued);
+    }
+
+    template <typename R, typename Rep, typename Period>
+    queue_status sp_enqueue_for(R&& input, const std::chrono::duration<Rep, Period>& timeout) {
+        return sp_enqueue_until(std::forward<R>(input), std::chrono::steady_clock::now() + timeout);
     }
 
     template <typename R>
     bool try_mp_enqueue(R&& input) {
         if (T::mp_enqueue(std::forward<R>(input))) {
-            _cv.notify_one();
+            _not_empty.notify_one();
             return true;
         }
         return false;
     }
 
     template <typename R>
-    void mp_enqueue(R&& input) {
-        if (!T::mp_enqueue(std::forward<R>(input))) {
-            std::unique_lock<std::mutex> lock(_m2);
-            while (!T::mp_enqueue(std::forward<R>(input))) {
-                _cv2.wait(lock);
-            }
+    queue_status mp_enqueue(R&& input) {
+        bool enqueued = false;
+        _not_full.wait([&]() { return is_closed() || (enqueued = T::mp_enqueue(std::forward<R>(input))); });
+        return enqueued_status(enqueued);
+    }
+
+    template <typename R, typename Clock, typename Duration>
+    queue_status mp_enqueue_until(R&& input, const std::chrono::time_point<Clock, Duration>& deadline) {
+        bool enqueued = false;
+        if (!_not_full.wait_until([&]() { return is_closed() || (enqueued = T::mp_enqueue(std::forward<R>(input))); }, deadline)) {
+            return queue_status::timeout;
+        }
+        return enqueued_status(enqueued);
+    }
+
+    template <typename R, typename Rep, typename Period>
+    queue_status mp_enqueue_for(R&& input, const std::chrono::duration<Rep, Period>& timeout) {
+        return mp_enqueue_until(std::forward<R>(input), std::chrono::steady_clock::now() + timeout);
+    }
+
+    //args are only consumed by the attempt that succeeds, so they can be retried while blocked
+    template <typename... Args>
+    bool try_sp_emplace(Args&&... args) {
+        if (T::sp_emplace(std::forward<Args>(args)...)) {
+            _not_empty.notify_one();
+            return true;
         }
-        _cv.notify_one();
+        return false;
+    }
+
+    template <typename... Args>
+    queue_status sp_emplace(Args&&... args) {
+        bool enqueued = false;
+        _not_full.wait([&]() { return is_closed() || (enqueued = T::sp_emplace(std::forward<Args>(args)...)); });
+        return enqueued_status(enqueued);
+    }
+
+    template <typename... Args>
+    bool try_mp_emplace(Args&&... args) {
+        if (T::mp_emplace(std::forward<Args>(args)...)) {
+            _not_empty.notify_one();
+            return true;
+        }
+        return false;
+    }
+
+    template <typename... Args>
+    queue_status mp_emplace(Args&&... args) {
+        bool enqueued = false;
+        _not_full.wait([&]() { return is_closed() || (enqueued = T::mp_emplace(std::forward<Args>(args)...)); });
+        return enqueued_status(enqueued);
+    }
+
+    //a single notification is issued for each batch that is enqueued
+    template <typename IT>
+    size_t try_sp_enqueue_bulk(IT first, IT last) {
+        size_t count = T::sp_enqueue_bulk(first, last);
+        if (count) _not_empty.notify_all();
+        return count;
+    }
+
+    //blocks until the whole range has been enqueued or the queue is closed, returns the number enqueued
+    template <typename IT>
+    size_t sp_enqueue_bulk(IT first, IT last) {
+        size_t total = 0;
+        _not_full.wait([&]() {
+            if (is_closed()) return true;
+            size_t count = try_sp_enqueue_bulk(first, last);
+            std::advance(first, count);
+            total += count;
+            return first == last;
+        });
+        return total;
+    }
+
+    template <typename IT>
+    size_t try_mp_enqueue_bulk(IT first, IT last) {
+        size_t count = T::mp_enqueue_bulk(first, last);
+        if (count) _not_empty.notify_all();
+        return count;
+    }
+
+    //blocks until the whole range has been enqueued or the queue is closed, returns the number enqueued
+    template <typename IT>
+    size_t mp_enqueue_bulk(IT first, IT last) {
+        size_t total = 0;
+        _not_full.wait([&]() {
+            if (is_closed()) return true;
+            size_t count = try_mp_enqueue_bulk(first, last);
+            std::advance(first, count);
+            total += count;
+            return first == last;
+        });
+        return total;
     }
 
     template <typename R>
     bool try_sc_dequeue(R& output) {
         if (T::sc_dequeue(output)) {
-            _cv2.notify_one();
+            _not_full.notify_one();
             return true;
         }
         return false;
     }
 
     template <typename R>
-    void sc_dequeue(R& output) {
-        if (!T::sc_dequeue(output)) {
-            std::unique_lock<std::mutex> lock(_m);
-            while (!T::sc_dequeue(output)) {
-                _cv.wait(lock);
-            }
+    queue_status sc_dequeue(R& output) {
+        bool dequeued = false;
+        _not_empty.wait([&]() { return (dequeued = T::sc_dequeue(output)) || is_closed(); });
+        return dequeued_status(dequeued);
+    }
+
+    template <typename R, typename Clock, typename Duration>
+    queue_status sc_dequeue_until(R& output, const std::chrono::time_point<Clock, Duration>& deadline) {
+        bool dequeued = false;
+        if (!_not_empty.wait_until([&]() { return (dequeued = T::sc_dequeue(output)) || is_closed(); }, deadline)) {
+            return queue_status::timeout;
         }
-        _cv2.notify_one();
+        return dequeued_status(dequeued);
+    }
+
+    template <typename R, typename Rep, typename Period>
+    queue_status sc_dequeue_for(R& output, const std::chrono::duration<Rep, Period>& timeout) {
+        return sc_dequeue_until(output, std::chrono::steady_clock::now() + timeout);
     }
 
     template <typename R>
     bool try_mc_dequeue(R& output) {
         if (T::mc_dequeue(output)) {
-            _cv2.notify_one();
+            _not_full.notify_one();
             return true;
         }
         return false;
     }
 
     template <typename R>
-    void mc_dequeue(R& output) {
-        if (!T::mc_dequeue(output)) {
-            std::unique_lock<std::mutex> lock(_m);
-            while (!T::mc_dequeue(output)) {
-                _cv.wait(lock);
-            }
+    queue_status mc_dequeue(R& output) {
+        bool dequeued = false;
+        _not_empty.wait([&]() { return (dequeued = T::mc_dequeue(output)) || is_closed(); });
+        return dequeued_status(dequeued);
+    }
+
+    template <typename R, typename Clock, typename Duration>
+    queue_status mc_dequeue_until(R& output, const std::chrono::time_point<Clock, Duration>& deadline) {
+        bool dequeued = false;
+        if (!_not_empty.wait_until([&]() { return (dequeued = T::mc_dequeue(output)) || is_closed(); }, deadline)) {
+            return queue_status::timeout;
         }
-        _cv2.notify_one();
+        return dequeued_status(dequeued);
+    }
+
+    template <typename R, typename Rep, typename Period>
+    queue_status mc_dequeue_for(R& output, const std::chrono::duration<Rep, Period>& timeout) {
+        return mc_dequeue_until(output, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename IT>
+    size_t try_sc_dequeue_bulk(IT output, size_t max) {
+        size_t count = T::sc_dequeue_bulk(output, max);
+        if (count) _not_full.notify_all();
+        return count;
+    }
+
+    //blocks until at least one item is available, returns 0 if the queue is closed and empty
+    template <typename IT>
+    size_t sc_dequeue_bulk(IT output, size_t max) {
+        size_t count = 0;
+        _not_empty.wait([&]() { return (count = T::sc_dequeue_bulk(output, max)) != 0 || is_closed(); });
+        if (count) _not_full.notify_all();
+        return count;
+    }
+
+    template <typename IT>
+    size_t try_mc_dequeue_bulk(IT output, size_t max) {
+        size_t count = T::mc_dequeue_bulk(output, max);
+        if (count) _not_full.notify_all();
+        return count;
+    }
+
+    //blocks until at least one item is available, returns 0 if the queue is closed and empty
+    template <typename IT>
+    size_t mc_dequeue_bulk(IT output, size_t max) {
+        size_t count = 0;
+        _not_empty.wait([&]() { return (count = T::mc_dequeue_bulk(output, max)) != 0 || is_closed(); });
+        if (count) _not_full.notify_all();
+        return count;
+    }
+
+    //collects up to max items, returning once max have been collected, the deadline has passed, or the queue is closed
+    //and empty, with the number collected. Items are taken in bulk as they arrive and the thread is parked by WAIT in
+    //between, so that batches fill at load and are returned at the deadline otherwise
+    template <typename IT, typename Clock, typename Duration>
+    size_t sc_dequeue_batch_until(IT output, size_t max, const std::chrono::time_point<Clock, Duration>& deadline) {
+        return dequeue_batch_until(output, max, deadline, [this](auto it, size_t n) { return T::sc_dequeue_bulk(it, n); });
+    }
+
+    template <typename IT, typename Rep, typename Period>
+    size_t sc_dequeue_batch_for(IT output, size_t max, const std::chrono::duration<Rep, Period>& timeout) {
+        return sc_dequeue_batch_until(output, max, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename IT, typename Clock, typename Duration>
+    size_t mc_dequeue_batch_until(IT output, size_t max, const std::chrono::time_point<Clock, Duration>& deadline) {
+        return dequeue_batch_until(output, max, deadline, [this](auto it, size_t n) { return T::mc_dequeue_bulk(it, n); });
+    }
+
+    template <typename IT, typename Rep, typename Period>
+    size_t mc_dequeue_batch_for(IT output, size_t max, const std::chrono::duration<Rep, Period>& timeout) {
+        return mc_dequeue_batch_until(output, max, std::chrono::steady_clock::now() + timeout);
+    }
+
+    //blocks until an item is available and invokes f on it in place, returns false if the queue is closed and empty
+    template <typename F>
+    bool sc_consume(F&& f) {
+        return sc_dequeue_bulk(details::make_consume_iterator(f), 1) == 1;
+    }
+
+    template <typename F>
+    bool mc_consume(F&& f) {
+        return mc_dequeue_bulk(details::make_consume_iterator(f), 1) == 1;
+    }
+
+    //blocks until at least one item is available, returns 0 if the queue is closed and empty
+    template <typename F>
+    size_t sc_consume_bulk(F&& f, size_t max) {
+        return sc_dequeue_bulk(details::make_consume_iterator(f), max);
+    }
+
+    template <typename F>
+    size_t mc_consume_bulk(F&& f, size_t max) {
+        return mc_dequeue_bulk(details::make_consume_iterator(f), max);
     }
 
 private:
-    std::mutex _m;
-    std::condition_variable _cv;
-    std::mutex _m2;
-    std::condition_variable _cv2;
+    //a closed queue ends the batch once a bulk dequeue finds it empty
+    template <typename IT, typename Clock, typename Duration, typename BULK>
+    size_t dequeue_batch_until(IT& output, size_t max, const std::chrono::time_point<Clock, Duration>& deadline, BULK bulk) {
+        size_t count = 0;
+        _not_empty.wait_until([&]() {
+            size_t dequeued = bulk(details::make_ref_iterator(output), max - count);
+            if (dequeued) _not_full.notify_all();
+            count += dequeued;
+            return count == max || (!dequeued && is_closed());
+        }, deadline);
+        return count;
+    }
+
+    queue_status enqueued_status(bool enqueued) {
+        if (!enqueued) return queue_status::closed;
+        _not_empty.notify_one();
+        return queue_status::success;
+    }
+
+    queue_status dequeued_status(bool dequeued) {
+        if (!dequeued) return queue_status::closed;
+        _not_full.notify_one();
+        return queue_status::success;
+    }
+
+    WAIT _not_empty;
+    WAIT _not_full;
+    std::atomic<bool> _closed{ false };
 };
 }//namespace bk_conq
 
 #endif /* BK_CONQ_BLOCKINGBOUNDEDQUEUE_HPP */
-
@@ -9,14 +9,16 @@
 #define BK_CONQ_BLOCKINGUNBOUNDEDQUEUE_HPP
 
 #include <bk_conq/unbounded_queue.hpp>
-#include <mutex>
-#include <condition_variable>
+#include <bk_conq/wait_policy.hpp>
+#include <bk_conq/details/consume_iterator.hpp>
+#include <bk_conq/details/ref_iterator.hpp>
 #include <atomic>
+#include <chrono>
 #include <type_traits>
 
 namespace bk_conq {
 
-template <typename T>
+template <typename T, typename WAIT = eventcount_wait_policy<>>
 class blocking_unbounded_queue : private T {
 public:
     template <typename... Args>
@@ -26,16 +28,55 @@ public:
 
     virtual ~blocking_unbounded_queue() {};
 
+    //wakes all blocked consumers, blocking dequeues return queue_status::closed once the queue is empty
+    //enqueues are still accepted, so that items in flight can be drained
+    void close() {
+        _closed.store(true, std::memory_order_seq_cst);
+        _not_empty.notify_all();
+    }
+
+    bool is_closed() const {
+        return _closed.load(std::memory_order_acquire);
+    }
+
+    using T::size_approx;
+    using T::empty_approx;
+
     template <typename R>
     void sp_enqueue(R&& input) {
         T::sp_enqueue(std::forward<R>(input));
-        _cv.notify_one();
+        _not_empty.notify_one();
     }
 
     template <typename R>
     void mp_enqueue(R&& input) {
         T::mp_enqueue(std::forward<R>(input));
-        _cv.notify_one();
+        _not_empty.notify_one();
+    }
+
+    template <typename... Args>
+    void sp_emplace(Args&&... args) {
+        T::sp_emplace(std::forward<Args>(args)...);
+        _not_empty.notify_one();
+    }
+
+    template <typename... Args>
+    void mp_emplace(Args&&... args) {
+        T::mp_emplace(std::forward<Args>(args)...);
+        _not_empty.notify_one();
+    }
+
+    //a single notification is issued for the whole batch
+    template <typename IT>
+    void sp_enqueue_bulk(IT first, IT last) {
+        T::sp_enqueue_bulk(first, last);
+        _not_empty.notify_all();
+    }
+
+    template <typename IT>
+    void mp_enqueue_bulk(IT first, IT last) {
+        T::mp_enqueue_bulk(first, last);
+        _not_empty.notify_all();
     }
 
     template <typename R>
@@ -44,12 +85,24 @@ public:
     }
 
     template <typename R>
-    void sc_dequeue(R& output) {
-        if (T::sc_dequeue(output)) return;
-        std::unique_lock<std::mutex> lock(_m);
-        while (!T::sc_dequeue(output)) {
-            _cv.wait(lock);
+    queue_status sc_dequeue(R& output) {
+        bool dequeued = false;
+        _not_empty.wait([&]() { return (dequeued = T::sc_dequeue(output)) || is_closed(); });
+        return dequeued ? queue_status::success : queue_status::closed;
+    }
+
+    template <typename R, typename Clock, typename Duration>
+    queue_status sc_dequeue_until(R& output, const std::chrono::time_point<Clock, Duration>& deadline) {
+        bool dequeued = false;
+        if (!_not_empty.wait_until([&]() { return (dequeued = T::sc_dequeue(output)) || is_closed(); }, deadline)) {
+            return queue_status::timeout;
         }
+        return dequeued ? queue_status::success : queue_status::closed;
+    }
+
+    template <typename R, typename Rep, typename Period>
+    queue_status sc_dequeue_for(R& output, const std::chrono::duration<Rep, Period>& timeout) {
+        return sc_dequeue_until(output, std::chrono::steady_clock::now() + timeout);
     }
 
     template <typename R>
@@ -58,17 +111,112 @@ public:
     }
 
     template <typename R>
-    void mc_dequeue(R& output) {
-        if (T::mc_dequeue(output)) return;
-        std::unique_lock<std::mutex> lock(_m);
-        while (T::mc_dequeue(output)) {
-            _cv.wait(lock);
+    queue_status mc_dequeue(R& output) {
+        bool dequeued = false;
+        _not_empty.wait([&]() { return (dequeued = T::mc_dequeue(output)) || is_closed(); });
+        return dequeued ? queue_status::success : queue_status::closed;
+    }
+
+    template <typename R, typename Clock, typename Duration>
+    queue_status mc_dequeue_until(R& output, const std::chrono::time_point<Clock, Duration>& deadline) {
+        bool dequeued = false;
+        if (!_not_empty.wait_until([&]() { return (dequeued = T::mc_dequeue(output)) || is_closed(); }, deadline)) {
+            return queue_status::timeout;
         }
+        return dequeued ? queue_status::success : queue_status::closed;
+    }
+
+    template <typename R, typename Rep, typename Period>
+    queue_status mc_dequeue_for(R& output, const std::chrono::duration<Rep, Period>& timeout) {
+        return mc_dequeue_until(output, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename IT>
+    size_t try_sc_dequeue_bulk(IT output, size_t max) {
+        return T::sc_dequeue_bulk(output, max);
+    }
+
+    //blocks until at least one item is available, returns 0 if the queue is closed and empty
+    template <typename IT>
+    size_t sc_dequeue_bulk(IT output, size_t max) {
+        size_t count = 0;
+        _not_empty.wait([&]() { return (count = T::sc_dequeue_bulk(output, max)) != 0 || is_closed(); });
+        return count;
+    }
+
+    template <typename IT>
+    size_t try_mc_dequeue_bulk(IT output, size_t max) {
+        return T::mc_dequeue_bulk(output, max);
+    }
+
+    //blocks until at least one item is available, returns 0 if the queue is closed and empty
+    template <typename IT>
+    size_t mc_dequeue_bulk(IT output, size_t max) {
+        size_t count = 0;
+        _not_empty.wait([&]() { return (count = T::mc_dequeue_bulk(output, max)) != 0 || is_closed(); });
+        return count;
+    }
+
+    //collects up to max items, returning once max have been collected, the deadline has passed, or the queue is closed
+    //and empty, with the number collected. Items are taken in bulk as they arrive and the thread is parked by WAIT in
+    //between, so that batches fill at load and are returned at the deadline otherwise
+    template <typename IT, typename Clock, typename Duration>
+    size_t sc_dequeue_batch_until(IT output, size_t max, const std::chrono::time_point<Clock, Duration>& deadline) {
+        return dequeue_batch_until(output, max, deadline, [this](auto it, size_t n) { return T::sc_dequeue_bulk(it, n); });
+    }
+
+    template <typename IT, typename Rep, typename Period>
+    size_t sc_dequeue_batch_for(IT output, size_t max, const std::chrono::duration<Rep, Period>& timeout) {
+        return sc_dequeue_batch_until(output, max, std::chrono::steady_clock::now() + timeout);
+    }
+
+    template <typename IT, typename Clock, typename Duration>
+    size_t mc_dequeue_batch_until(IT output, size_t max, const std::chrono::time_point<Clock, Duration>& deadline) {
+        return dequeue_batch_until(output, max, deadline, [this](auto it, size_t n) { return T::mc_dequeue_bulk(it, n); });
+    }
+
+    template <typename IT, typename Rep, typename Period>
+    size_t mc_dequeue_batch_for(IT output, size_t max, const std::chrono::duration<Rep, Period>& timeout) {
+        return mc_dequeue_batch_until(output, max, std::chrono::steady_clock::now() + timeout);
+    }
+
+    //blocks until an item is available and invokes f on it in place, returns false if the queue is closed and empty
+    template <typename F>
+    bool sc_consume(F&& f) {
+        return sc_dequeue_bulk(details::make_consume_iterator(f), 1) == 1;
+    }
+
+    template <typename F>
+    bool mc_consume(F&& f) {
+        return mc_dequeue_bulk(details::make_consume_iterator(f), 1) == 1;
+    }
+
+    //blocks until at least one item is available, returns 0 if the queue is closed and empty
+    template <typename F>
+    size_t sc_consume_bulk(F&& f, size_t max) {
+        return sc_dequeue_bulk(details::make_consume_iterator(f), max);
+    }
+
+    template <typename F>
+    size_t mc_consume_bulk(F&& f, size_t max) {
+        return mc_dequeue_bulk(details::make_consume_iterator(f), max);
     }
 
 private:
-    std::mutex _m;
-    std::condition_variable _cv;
+    //a closed queue ends the batch once a bulk dequeue finds it empty
+    template <typename IT, typename Clock, typename Duration, typename BULK>
+    size_t dequeue_batch_until(IT& output, size_t max, const std::chrono::time_point<Clock, Duration>& deadline, BULK bulk) {
+        size_t count = 0;
+        _not_empty.wait_until([&]() {
+            size_t dequeued = bulk(details::make_ref_iterator(output), max - count);
+            count += dequeued;
+            return count == max || (!dequeued && is_closed());
+        }, deadline);
+        return count;
+    }
+
+    WAIT _not_empty;
+    std::atomic<bool> _closed{ false };
 };
 }//namespace bk_conq
 
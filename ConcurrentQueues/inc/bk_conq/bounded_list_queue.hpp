@@ -7,6 +7,9 @@
  * as a linked list, where nodes are stored in a freelist after being dequeued.
  * Enqueue operations will attempt to acquire items from the freelist or return false
  * if no node is available.
+ * Contended dequeues wait between retries using WAIT_STRATEGY. Nodes are obtained
+ * from ALLOCATOR, see page_allocator for huge page and NUMA aware storage.
+ * Items are constructed in their node on enqueue and destroyed on dequeue.
  * Created on 30 January 2017, 08:36 PM
  */
 
@@ -16,14 +19,18 @@
 #include <atomic>
 #include <thread>
 #include <initializer_list>
+#include <vector>
+#include <memory>
 #include <bk_conq/bounded_queue.hpp>
+#include <bk_conq/wait_strategy.hpp>
+#include <bk_conq/details/uninitialized.hpp>
 
 namespace bk_conq {
-template<typename T>
-class bounded_list_queue : public bounded_queue<T, bounded_list_queue<T>> {
-    friend bounded_queue<T, bounded_list_queue<T>>;
+template<typename T, typename WAIT_STRATEGY = yield_strategy, typename ALLOCATOR = std::allocator<T>, producers P = producers::multi, consumers C = consumers::multi>
+class bounded_list_queue : public bounded_queue<T, bounded_list_queue<T, WAIT_STRATEGY, ALLOCATOR, P, C>, P, C> {
+    friend bounded_queue<T, bounded_list_queue<T, WAIT_STRATEGY, ALLOCATOR, P, C>, P, C>;
 public:
-    bounded_list_queue(size_t N) : _data(N) {
+    bounded_list_queue(size_t N, const ALLOCATOR& allocator = ALLOCATOR()) : _data(N, node_allocator_t(allocator)) {
         _free_list_head.store(&_data[1], std::memory_order_relaxed);
         _free_list_tail.store(_free_list_head.load(std::memory_order_relaxed));
         for (size_t i = 2; i < N; ++i) {
@@ -33,7 +40,12 @@ public:
         }
     }
 
-    virtual ~bounded_list_queue() {}
+    //items still in the queue are destroyed, no operations may be in progress
+    virtual ~bounded_list_queue() {
+        for (list_node_t* node = _tail.load(std::memory_order_relaxed)->next.load(std::memory_order_relaxed); node; node = node->next.load(std::memory_order_relaxed)) {
+            node->data.destroy();
+        }
+    }
 
     bounded_list_queue(const bounded_list_queue&) = delete;
     void operator=(const bounded_list_queue&) = delete;
@@ -42,48 +54,89 @@ public:
 protected:
     template <typename R>
     bool sp_enqueue_impl(R&& input) {
+        return sp_emplace_impl(std::forward<R>(input));
+    }
+
+    template <typename R>
+    bool mp_enqueue_impl(R&& input) {
+        return mp_emplace_impl(std::forward<R>(input));
+    }
+
+    //the item is only constructed once a node has been taken from the freelist
+    template <typename... Args>
+    bool sp_emplace_impl(Args&&... args) {
         list_node_t *node = freelist_try_dequeue();
         if (!node) return false;
-        node->data = std::forward<R>(input);
+        node->data.construct(std::forward<Args>(args)...);
         node->next.store(nullptr, std::memory_order_relaxed);
         _head.load(std::memory_order_relaxed)->next.store(node, std::memory_order_release);
         _head.store(node, std::memory_order_relaxed);
+        exclusive_add(_enqueued, 1);
         return true;
     }
 
-    template <typename R>
-    bool mp_enqueue_impl(R&& input) {
+    template <typename... Args>
+    bool mp_emplace_impl(Args&&... args) {
         list_node_t *node = freelist_try_dequeue();
         if (!node) return false;
-        node->data = std::forward<R>(input);
+        node->data.construct(std::forward<Args>(args)...);
         node->next.store(nullptr, std::memory_order_relaxed);
         list_node_t* prev_head = _head.exchange(node, std::memory_order_acq_rel);
         prev_head->next.store(node, std::memory_order_release);
+        _enqueued.fetch_add(1, std::memory_order_relaxed);
         return true;
     }
 
+    //as many nodes as are available are linked into a private chain and published with a single exchange
+    template <typename IT>
+    size_t sp_enqueue_bulk_impl(IT first, IT last) {
+        list_node_t *chain_tail = nullptr;
+        list_node_t *chain_head = nullptr;
+        size_t count = acquire_chain(first, last, chain_head, chain_tail);
+        if (!count) return 0;
+        _head.load(std::memory_order_relaxed)->next.store(chain_head, std::memory_order_release);
+        _head.store(chain_tail, std::memory_order_relaxed);
+        exclusive_add(_enqueued, count);
+        return count;
+    }
+
+    template <typename IT>
+    size_t mp_enqueue_bulk_impl(IT first, IT last) {
+        list_node_t *chain_tail = nullptr;
+        list_node_t *chain_head = nullptr;
+        size_t count = acquire_chain(first, last, chain_head, chain_tail);
+        if (!count) return 0;
+        list_node_t* prev_head = _head.exchange(chain_tail, std::memory_order_acq_rel);
+        prev_head->next.store(chain_head, std::memory_order_release);
+        _enqueued.fetch_add(count, std::memory_order_relaxed);
+        return count;
+    }
+
     bool sc_dequeue_impl(T& output) {
         list_node_t* tail = _tail.load(std::memory_order_relaxed);
         list_node_t* next = tail->next.load(std::memory_order_acquire);
         if (!next) return false;
-        output = std::move(next->data);
+        next->data.move_to(output);
+        exclusive_add(_dequeued, 1);
         _tail.store(next, std::memory_order_release);
         freelist_enqueue(tail);
         return true;
     }
 
-    //yield spin on dequeue contention
+    //spin on dequeue contention
     bool mc_dequeue_impl(T& output) {
         list_node_t *tail;
+        WAIT_STRATEGY strategy;
         for (tail = _tail.exchange(nullptr, std::memory_order_acq_rel); !tail; tail = _tail.exchange(nullptr, std::memory_order_acq_rel)) {
-            std::this_thread::yield();
+            strategy.wait();
         }
         list_node_t *next = tail->next.load(std::memory_order_acquire);
         if (!next) {
             _tail.exchange(tail, std::memory_order_acq_rel);
             return false;
         }
-        output = std::move(next->data);
+        next->data.move_to(output);
+        exclusive_add(_dequeued, 1);
         _tail.store(next, std::memory_order_release);
         freelist_enqueue(tail);
         return true;
@@ -98,28 +151,81 @@ protected:
             _tail.exchange(tail, std::memory_order_acq_rel);
             return false;
         }
-        output = std::move(next->data);
+        next->data.move_to(output);
+        exclusive_add(_dequeued, 1);
         _tail.store(next, std::memory_order_release);
         freelist_enqueue(tail);
         return true;
     }
 
+    template <typename IT>
+    size_t sc_dequeue_bulk_impl(IT output, size_t max) {
+        list_node_t* tail = _tail.load(std::memory_order_relaxed);
+        list_node_t* released_head = tail;
+        list_node_t* released_tail;
+        size_t count = take_run(tail, released_tail, output, max);
+        if (!count) return 0;
+        exclusive_add(_dequeued, count);
+        _tail.store(tail, std::memory_order_release);
+        freelist_enqueue_chain(released_head, released_tail);
+        return count;
+    }
+
+    //spin on dequeue contention
+    template <typename IT>
+    size_t mc_dequeue_bulk_impl(IT output, size_t max) {
+        list_node_t *tail;
+        WAIT_STRATEGY strategy;
+        for (tail = _tail.exchange(nullptr, std::memory_order_acq_rel); !tail; tail = _tail.exchange(nullptr, std::memory_order_acq_rel)) {
+            strategy.wait();
+        }
+        list_node_t* released_head = tail;
+        list_node_t* released_tail;
+        size_t count = take_run(tail, released_tail, output, max);
+        exclusive_add(_dequeued, count);
+        _tail.store(tail, std::memory_order_release);
+        if (count) freelist_enqueue_chain(released_head, released_tail);
+        return count;
+    }
+
+    size_t size_approx_impl() const {
+        size_t dequeued = _dequeued.load(std::memory_order_relaxed);
+        size_t enqueued = _enqueued.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    //one node is the sentinel of the queue and one the sentinel of the freelist
+    size_t capacity_impl() const {
+        return _data.size() - 2;
+    }
+
 private:
+    //data is live from enqueue until the node is passed by a dequeue
     struct list_node_t {
-        T data;
+        details::uninitialized<T> data;
         std::atomic<list_node_t*> next{ nullptr };
-
-        template<typename R>
-        list_node_t(R&& input) : data(input) {}
-        list_node_t() {}
     };
 
+    typedef typename std::allocator_traits<ALLOCATOR>::template rebind_alloc<list_node_t> node_allocator_t;
+
+    //for counters that are only written by the holder of the head or tail
+    static void exclusive_add(std::atomic<size_t>& counter, size_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
     inline void freelist_enqueue(list_node_t *item) {
         item->next.store(nullptr, std::memory_order_relaxed);
         list_node_t * free_list_prev_head = _free_list_head.exchange(item, std::memory_order_acq_rel);
         free_list_prev_head->next.store(item, std::memory_order_release);
     }
 
+    //the released nodes are still linked in dequeue order, so they go back on the freelist as one chain
+    inline void freelist_enqueue_chain(list_node_t *first, list_node_t *last) {
+        last->next.store(nullptr, std::memory_order_relaxed);
+        list_node_t * free_list_prev_head = _free_list_head.exchange(last, std::memory_order_acq_rel);
+        free_list_prev_head->next.store(first, std::memory_order_release);
+    }
+
     inline list_node_t* freelist_try_dequeue() {
         list_node_t* node = _free_list_tail.load(std::memory_order_relaxed);
         for (list_node_t *next = node->next.load(std::memory_order_acquire); next != nullptr; next = node->next.load(std::memory_order_acquire)) {
@@ -128,12 +234,40 @@ private:
         return nullptr;
     }
 
-    std::vector<list_node_t> _data;
+    template <typename IT>
+    size_t acquire_chain(IT first, IT last, list_node_t*& chain_head, list_node_t*& chain_tail) {
+        size_t count = 0;
+        for (list_node_t *node; first != last && (node = freelist_try_dequeue()) != nullptr; ++first, ++count) {
+            node->data.construct(*first);
+            node->next.store(nullptr, std::memory_order_relaxed);
+            if (count == 0) chain_head = node;
+            else chain_tail->next.store(node, std::memory_order_relaxed);
+            chain_tail = node;
+        }
+        return count;
+    }
+
+    //moves up to max items out from behind tail, leaving tail at the new sentinel and released_tail at the last node passed over
+    template <typename IT>
+    size_t take_run(list_node_t*& tail, list_node_t*& released_tail, IT output, size_t max) {
+        size_t count = 0;
+        for (list_node_t *next; count < max && (next = tail->next.load(std::memory_order_acquire)) != nullptr; ++count, ++output) {
+            next->data.move_to(*output);
+            released_tail = tail;
+            tail = next;
+        }
+        return count;
+    }
+
+    std::vector<list_node_t, node_allocator_t> _data;
     char _padding2[64];
     std::atomic<list_node_t*> _head{ &_data[0] };
+    //the item counters share a cache line with the end of the list whose operations update them
+    std::atomic<size_t> _enqueued{ 0 };
     std::atomic<list_node_t*> _free_list_tail{ nullptr };
     char _padding[64];
     std::atomic<list_node_t*> _tail{ _head.load(std::memory_order_relaxed) };
+    std::atomic<size_t> _dequeued{ 0 };
     std::atomic<list_node_t*> _free_list_head{ nullptr };
 };
 }//namespace bk_conq
@@ -8,6 +8,12 @@
 #ifndef BK_CONQ_BOUNDEDQUEUE_HPP
 #define BK_CONQ_BOUNDEDQUEUE_HPP
 
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <bk_conq/cardinality.hpp>
+#include <bk_conq/details/consume_iterator.hpp>
+
 namespace bk_conq {
 
 class bounded_queue_tag {};
@@ -15,9 +21,13 @@ class bounded_queue_tag {};
 template <typename T>
 class bounded_queue_typed_tag {};
 
-template <typename T, typename BASE>
+template <typename T, typename BASE, producers P = producers::multi, consumers C = consumers::multi>
 class bounded_queue : public bounded_queue_typed_tag<T>, public bounded_queue_tag {
 public:
+    typedef T value_type;
+    static constexpr producers producer_cardinality = P;
+    static constexpr consumers consumer_cardinality = C;
+
     bool sp_enqueue(T&& input) {
         return base()->sp_enqueue_impl(std::move(input));
     }
@@ -26,30 +36,200 @@ public:
         return base()->sp_enqueue_impl(input);
     }
 
+    //with a single producer the multi-producer operations use the single-producer algorithm
     bool mp_enqueue(T&& input) {
-        return base()->mp_enqueue_impl(std::move(input));
+        return enqueue_selected(details::single_producer<P>(), std::move(input));
     }
 
     bool mp_enqueue(const T& input) {
-        return base()->mp_enqueue_impl(input);
+        return enqueue_selected(details::single_producer<P>(), input);
+    }
+
+    //constructs the item in place from args, which are left untouched if the queue is full
+    template <typename... Args>
+    bool sp_emplace(Args&&... args) {
+        return base()->sp_emplace_impl(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    bool mp_emplace(Args&&... args) {
+        return emplace_selected(details::single_producer<P>(), std::forward<Args>(args)...);
+    }
+
+    template <typename IT>
+    size_t sp_enqueue_bulk(IT first, IT last) {
+        return base()->sp_enqueue_bulk_impl(first, last);
+    }
+
+    template <typename IT>
+    size_t mp_enqueue_bulk(IT first, IT last) {
+        return enqueue_bulk_selected(details::single_producer<P>(), first, last);
     }
 
     bool sc_dequeue(T& output) {
         return base()->sc_dequeue_impl(output);
     }
 
+    //with a single consumer the multi-consumer operations use the single-consumer algorithm
     bool mc_dequeue(T& output) {
-        return base()->mc_dequeue_impl(output);
+        return dequeue_selected(details::single_consumer<C>(), output);
     }
 
     bool mc_dequeue_uncontended(T& output) {
-        return base()->mc_dequeue_uncontended_impl(output);
+        return dequeue_uncontended_selected(details::single_consumer<C>(), output);
+    }
+
+    template <typename IT>
+    size_t sc_dequeue_bulk(IT output, size_t max) {
+        return base()->sc_dequeue_bulk_impl(output, max);
+    }
+
+    template <typename IT>
+    size_t mc_dequeue_bulk(IT output, size_t max) {
+        return dequeue_bulk_selected(details::single_consumer<C>(), output, max);
+    }
+
+    //invokes f with a reference to the item while it is still held by the queue, the item is destroyed and
+    //its slot released once f returns. f should be short and must not throw, as the slot is claimed while it runs
+    template <typename F>
+    bool sc_consume(F&& f) {
+        return base()->sc_dequeue_bulk_impl(details::make_consume_iterator(f), 1) == 1;
+    }
+
+    template <typename F>
+    bool mc_consume(F&& f) {
+        return dequeue_bulk_selected(details::single_consumer<C>(), details::make_consume_iterator(f), 1) == 1;
+    }
+
+    //invokes f on up to max items in turn, returning the number consumed
+    template <typename F>
+    size_t sc_consume_bulk(F&& f, size_t max) {
+        return base()->sc_dequeue_bulk_impl(details::make_consume_iterator(f), max);
+    }
+
+    template <typename F>
+    size_t mc_consume_bulk(F&& f, size_t max) {
+        return dequeue_bulk_selected(details::single_consumer<C>(), details::make_consume_iterator(f), max);
+    }
+
+    //the operations selected by the declared cardinality, which are the multi-producer and multi-consumer
+    //operations unless a side is single
+    bool enqueue(T&& input) {
+        return mp_enqueue(std::move(input));
+    }
+
+    bool enqueue(const T& input) {
+        return mp_enqueue(input);
+    }
+
+    template <typename... Args>
+    bool emplace(Args&&... args) {
+        return mp_emplace(std::forward<Args>(args)...);
+    }
+
+    template <typename IT>
+    size_t enqueue_bulk(IT first, IT last) {
+        return mp_enqueue_bulk(first, last);
+    }
+
+    bool dequeue(T& output) {
+        return mc_dequeue(output);
+    }
+
+    template <typename IT>
+    size_t dequeue_bulk(IT output, size_t max) {
+        return mc_dequeue_bulk(output, max);
+    }
+
+    template <typename F>
+    bool consume(F&& f) {
+        return mc_consume(std::forward<F>(f));
+    }
+
+    template <typename F>
+    size_t consume_bulk(F&& f, size_t max) {
+        return mc_consume_bulk(std::forward<F>(f), max);
+    }
+
+    //the approximate number of queued items, wait-free, concurrent operations may not be reflected
+    size_t size_approx() const {
+        return base()->size_approx_impl();
+    }
+
+    bool empty_approx() const {
+        return size_approx() == 0;
+    }
+
+    //the maximum number of items the queue can hold
+    size_t capacity() const {
+        return base()->capacity_impl();
     }
 
 private:
+    //only the selected algorithm is instantiated, so a queue may leave out what the other one needs
+    template <typename R>
+    bool enqueue_selected(std::true_type, R&& input) {
+        return base()->sp_enqueue_impl(std::forward<R>(input));
+    }
+
+    template <typename R>
+    bool enqueue_selected(std::false_type, R&& input) {
+        return base()->mp_enqueue_impl(std::forward<R>(input));
+    }
+
+    template <typename... Args>
+    bool emplace_selected(std::true_type, Args&&... args) {
+        return base()->sp_emplace_impl(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    bool emplace_selected(std::false_type, Args&&... args) {
+        return base()->mp_emplace_impl(std::forward<Args>(args)...);
+    }
+
+    template <typename IT>
+    size_t enqueue_bulk_selected(std::true_type, IT first, IT last) {
+        return base()->sp_enqueue_bulk_impl(first, last);
+    }
+
+    template <typename IT>
+    size_t enqueue_bulk_selected(std::false_type, IT first, IT last) {
+        return base()->mp_enqueue_bulk_impl(first, last);
+    }
+
+    bool dequeue_selected(std::true_type, T& output) {
+        return base()->sc_dequeue_impl(output);
+    }
+
+    bool dequeue_selected(std::false_type, T& output) {
+        return base()->mc_dequeue_impl(output);
+    }
+
+    bool dequeue_uncontended_selected(std::true_type, T& output) {
+        return base()->sc_dequeue_impl(output);
+    }
+
+    bool dequeue_uncontended_selected(std::false_type, T& output) {
+        return base()->mc_dequeue_uncontended_impl(output);
+    }
+
+    template <typename IT>
+    size_t dequeue_bulk_selected(std::true_type, IT output, size_t max) {
+        return base()->sc_dequeue_bulk_impl(output, max);
+    }
+
+    template <typename IT>
+    size_t dequeue_bulk_selected(std::false_type, IT output, size_t max) {
+        return base()->mc_dequeue_bulk_impl(output, max);
+    }
+
     inline BASE* base() {
         return static_cast<BASE*>(this);
     }
+
+    inline const BASE* base() const {
+        return static_cast<const BASE*>(this);
+    }
 };
 
 }//namespace bk_conq
@@ -0,0 +1,282 @@
+/*
+ * File:   broadcast_queue.hpp
+ * Author: Barath Kannan
+ * This is a bounded broadcast queue, every subscriber receives every item that is
+ * enqueued after it subscribes, so an item is written once however many subscribers
+ * read it. The ring uses the sequence numbers of vector_queue to publish items,
+ * producers share a single write sequence and each subscriber has a read cursor of
+ * its own. Producers are gated by the slowest active subscriber, an enqueue fails
+ * rather than overwrite an item that a subscriber has not read yet.
+ * A subscriber can be made to depend on others, it then only reads an item once
+ * every subscriber it depends on has read it, forming a pipeline of stages.
+ * Subscribers are registered while no enqueue is in progress, they may
+ * unsubscribe (by destroying their subscriber) at any time. Each subscriber is
+ * used by one thread at a time. Items are destroyed when their slot is reused
+ * or with the queue. The size of the queue must be a power of 2.
+ * Created on 14 October 2026 11:59 PM
+ */
+
+#ifndef BK_CONQ_BROADCAST_QUEUE_HPP
+#define BK_CONQ_BROADCAST_QUEUE_HPP
+
+#include <atomic>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <bk_conq/details/slot_storage.hpp>
+#include <bk_conq/details/consume_iterator.hpp>
+
+namespace bk_conq {
+template<typename T, slot_layout LAYOUT = slot_layout::packed, typename ALLOCATOR = std::allocator<T>>
+class broadcast_queue {
+    struct cursor_t {
+        char _pad0[details::cache_line_size];
+        std::atomic<size_t> seq{ 0 };
+        std::atomic<bool> active{ true };
+        char _pad1[details::cache_line_size];
+    };
+
+public:
+    typedef T value_type;
+
+    //the read position of a subscriber, which unsubscribes when it is destroyed
+    class subscriber {
+    public:
+        subscriber(subscriber&& other) : _cursor(other._cursor), _dependencies(std::move(other._dependencies)), _limit(other._limit) {
+            other._cursor = nullptr;
+        }
+
+        subscriber(const subscriber&) = delete;
+        void operator=(const subscriber&) = delete;
+
+        ~subscriber() {
+            if (_cursor) _cursor->active.store(false, std::memory_order_release);
+        }
+
+    private:
+        friend broadcast_queue;
+
+        subscriber(cursor_t* cursor, std::vector<const cursor_t*> dependencies) :
+            _cursor(cursor), _dependencies(std::move(dependencies)), _limit(cursor->seq.load(std::memory_order_relaxed)) {}
+
+        cursor_t* _cursor;
+        std::vector<const cursor_t*> _dependencies;
+        //the dependencies are known to have read every item before this sequence
+        size_t _limit;
+    };
+
+    broadcast_queue(size_t N, const ALLOCATOR& allocator = ALLOCATOR()) : _slots(checked_size(N), allocator), _sm1(N - 1) {
+        for (size_t i = 0; i < N; ++i) {
+            _slots.seq(i).store(0, std::memory_order_relaxed);
+        }
+    }
+
+    //items still in the ring are destroyed, no operations may be in progress
+    ~broadcast_queue() {
+        size_t head_seq = _head_seq.load(std::memory_order_relaxed);
+        for (size_t seq = head_seq > _sm1 ? head_seq - _sm1 - 1 : 0; seq != head_seq; ++seq) {
+            _slots.data(seq & _sm1).destroy();
+        }
+    }
+
+    broadcast_queue(const broadcast_queue&) = delete;
+    void operator=(const broadcast_queue&) = delete;
+
+    //Registers a subscriber that receives every item enqueued from now on. If dependencies are given the
+    //subscriber only reads an item once each of them has, and its dependencies must outlive it.
+    //Must not be called while an enqueue is in progress.
+    subscriber subscribe(std::initializer_list<const subscriber*> dependencies = {}) {
+        std::vector<const cursor_t*> cursors;
+        for (const subscriber* dependency : dependencies) cursors.push_back(dependency->_cursor);
+        //the cursor of a subscriber that has unsubscribed is reused
+        auto it = std::find_if(_cursors.begin(), _cursors.end(), [](auto& cursor) { return !cursor->active.load(std::memory_order_acquire); });
+        if (it == _cursors.end()) it = _cursors.insert(it, std::unique_ptr<cursor_t>(new cursor_t));
+        cursor_t* cursor = it->get();
+        cursor->seq.store(_head_seq.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        cursor->active.store(true, std::memory_order_release);
+        return subscriber(cursor, std::move(cursors));
+    }
+
+    bool sp_enqueue(T&& input) {
+        return sp_emplace(std::move(input));
+    }
+
+    bool sp_enqueue(const T& input) {
+        return sp_emplace(input);
+    }
+
+    bool mp_enqueue(T&& input) {
+        return mp_emplace(std::move(input));
+    }
+
+    bool mp_enqueue(const T& input) {
+        return mp_emplace(input);
+    }
+
+    //constructs the item in place from args, which are left untouched if the queue is full
+    template <typename... Args>
+    bool sp_emplace(Args&&... args) {
+        size_t head_seq = _head_seq.load(std::memory_order_relaxed);
+        if (free_run(head_seq, 1) == 0) return false;
+        _head_seq.store(head_seq + 1, std::memory_order_relaxed);
+        publish(head_seq, std::forward<Args>(args)...);
+        return true;
+    }
+
+    template <typename... Args>
+    bool mp_emplace(Args&&... args) {
+        size_t head_seq = _head_seq.load(std::memory_order_relaxed);
+        do {
+            if (free_run(head_seq, 1) == 0) return false;
+        } while (!_head_seq.compare_exchange_weak(head_seq, head_seq + 1, std::memory_order_relaxed));
+        publish(head_seq, std::forward<Args>(args)...);
+        return true;
+    }
+
+    //claims as many slots as are free, up to the size of the range, with a single operation on the write sequence
+    template <typename IT>
+    size_t sp_enqueue_bulk(IT first, IT last) {
+        size_t head_seq = _head_seq.load(std::memory_order_relaxed);
+        size_t count = free_run(head_seq, std::distance(first, last));
+        if (count == 0) return 0;
+        _head_seq.store(head_seq + count, std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i, ++first) publish(head_seq + i, *first);
+        return count;
+    }
+
+    template <typename IT>
+    size_t mp_enqueue_bulk(IT first, IT last) {
+        size_t requested = std::distance(first, last);
+        size_t head_seq = _head_seq.load(std::memory_order_relaxed);
+        size_t count;
+        do {
+            count = free_run(head_seq, requested);
+            if (count == 0) return 0;
+        } while (!_head_seq.compare_exchange_weak(head_seq, head_seq + count, std::memory_order_relaxed));
+        for (size_t i = 0; i < count; ++i, ++first) publish(head_seq + i, *first);
+        return count;
+    }
+
+    //copies the subscriber's next item into output, the item stays in the ring for the other subscribers
+    bool dequeue(subscriber& s, T& output) {
+        return read(s, &output, 1) == 1;
+    }
+
+    template <typename IT>
+    size_t dequeue_bulk(subscriber& s, IT output, size_t max) {
+        return read(s, output, max);
+    }
+
+    //invokes f with a const reference to the subscriber's next item in the ring
+    template <typename F>
+    bool consume(subscriber& s, F&& f) {
+        return read(s, details::make_consume_iterator(f), 1) == 1;
+    }
+
+    template <typename F>
+    size_t consume_bulk(subscriber& s, F&& f, size_t max) {
+        return read(s, details::make_consume_iterator(f), max);
+    }
+
+    //the number of items the subscriber has yet to read, concurrent operations may not be reflected
+    size_t size_approx(const subscriber& s) const {
+        size_t cursor = s._cursor->seq.load(std::memory_order_relaxed);
+        size_t head_seq = _head_seq.load(std::memory_order_relaxed);
+        return head_seq > cursor ? std::min(head_seq - cursor, _sm1 + 1) : 0;
+    }
+
+    size_t capacity() const {
+        return _sm1 + 1;
+    }
+
+private:
+    static size_t checked_size(size_t N) {
+        if ((N == 0) || ((N & (~N + 1)) != N)) {
+            throw std::length_error("size of broadcast_queue must be power of 2");
+        }
+        return N;
+    }
+
+    //the lowest cursor of the active subscribers, or head_seq if there are none
+    size_t slowest_cursor(size_t head_seq) const {
+        size_t slowest = head_seq;
+        for (auto& cursor : _cursors) {
+            if (!cursor->active.load(std::memory_order_acquire)) continue;
+            slowest = std::min(slowest, cursor->seq.load(std::memory_order_acquire));
+        }
+        return slowest;
+    }
+
+    //number of slots from head_seq, up to max, that every active subscriber has read
+    //the gate is only recomputed from the cursors when the cached value does not allow max slots
+    size_t free_run(size_t head_seq, size_t max) {
+        size_t gate = _gate_seq.load(std::memory_order_relaxed);
+        if (ahead(gate + _sm1 + 1, head_seq) < max) {
+            gate = slowest_cursor(head_seq);
+            _gate_seq.store(gate, std::memory_order_relaxed);
+        }
+        return std::min(max, ahead(gate + _sm1 + 1, head_seq));
+    }
+
+    //the gate may be stored out of order by concurrent producers, so it can lag the head by more than a lap
+    static size_t ahead(size_t limit, size_t seq) {
+        return limit > seq ? limit - seq : 0;
+    }
+
+    //the item previously held by the slot has been read by every subscriber, as they have all passed it,
+    //but without subscribers the producer of the previous lap may still be constructing it
+    template <typename... Args>
+    void publish(size_t seq, Args&&... args) {
+        size_t indx = seq & _sm1;
+        if (seq > _sm1) {
+            while (_slots.seq(indx).load(std::memory_order_acquire) != seq - _sm1) std::this_thread::yield();
+            _slots.data(indx).destroy();
+        }
+        _slots.data(indx).construct(std::forward<Args>(args)...);
+        _slots.seq(indx).store(seq + 1, std::memory_order_release);
+    }
+
+    //a dependency that has unsubscribed no longer holds its dependents back, the sequence numbers still
+    //stop them at items that are not yet published
+    size_t dependency_limit(const subscriber& s, size_t cursor) const {
+        size_t limit = cursor + _sm1 + 1;
+        for (const cursor_t* dependency : s._dependencies) {
+            if (!dependency->active.load(std::memory_order_acquire)) continue;
+            limit = std::min(limit, dependency->seq.load(std::memory_order_acquire));
+        }
+        return limit;
+    }
+
+    //the cursor is only advanced once the items have been read, which releases their slots to the producers
+    template <typename IT>
+    size_t read(subscriber& s, IT output, size_t max) {
+        size_t cursor = s._cursor->seq.load(std::memory_order_relaxed);
+        if (!s._dependencies.empty()) {
+            if (ahead(s._limit, cursor) < max) s._limit = dependency_limit(s, cursor);
+            max = std::min(max, ahead(s._limit, cursor));
+        }
+        size_t count = 0;
+        for (; count < max && _slots.seq((cursor + count) & _sm1).load(std::memory_order_acquire) == cursor + count + 1; ++count, ++output) {
+            *output = static_cast<const T&>(_slots.data((cursor + count) & _sm1).get());
+        }
+        if (count) s._cursor->seq.store(cursor + count, std::memory_order_release);
+        return count;
+    }
+
+    details::slot_storage<T, LAYOUT, ALLOCATOR> _slots;
+    const size_t _sm1;
+    std::vector<std::unique_ptr<cursor_t>> _cursors;
+    char _pad0[details::cache_line_size];
+    std::atomic<size_t> _head_seq{ 0 };
+    //the slowest cursor when it was last computed, producers may write up to a lap beyond it
+    std::atomic<size_t> _gate_seq{ 0 };
+    char _pad1[details::cache_line_size];
+};
+} //namespace bk_conq
+
+#endif /* BK_CONQ_BROADCAST_QUEUE_HPP */
@@ -0,0 +1,43 @@
+/*
+ * File:   cardinality.hpp
+ * Author: Barath Kannan
+ * Producer and consumer cardinalities, given to the queues as template parameters.
+ * A queue declared with producers::single or consumers::single promises that at
+ * most one thread enqueues, or dequeues, at a time. Its multi-producer and
+ * multi-consumer operations then run the single-producer and single-consumer
+ * algorithms, so the algorithm is selected statically rather than at each call
+ * site, and state that only the multi-threaded algorithms need is compiled out.
+ * enqueue/dequeue and the other operations without a prefix always select the
+ * algorithm from the declared cardinality.
+ * Created on 14 October 2026 11:59 PM
+ */
+
+#ifndef BK_CONQ_CARDINALITY_HPP
+#define BK_CONQ_CARDINALITY_HPP
+
+#include <type_traits>
+
+namespace bk_conq {
+
+enum class producers {
+    single,
+    multi
+};
+
+enum class consumers {
+    single,
+    multi
+};
+
+namespace details {
+//tags for selecting an algorithm by overload, true_type when the side has a single thread
+template <producers P>
+using single_producer = std::integral_constant<bool, P == producers::single>;
+
+template <consumers C>
+using single_consumer = std::integral_constant<bool, C == consumers::single>;
+}//namespace details
+
+}//namespace bk_conq
+
+#endif /* BK_CONQ_CARDINALITY_HPP */
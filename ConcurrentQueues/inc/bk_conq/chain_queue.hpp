@@ -7,6 +7,22 @@
 * as a linked list, where nodes are stored in a freelist after being dequeued.
 * Enqueue operations will either acquire items from the freelist or allocate a
 * new node if none are available.
+* Nodes are blocks of BLOCK_SIZE items obtained from ALLOCATOR. The freelist acts
+* as a block pool: it can be pre-warmed at construction, and blocks that are
+* released while it holds max_free_blocks are returned to the allocator.
+* Contended dequeues wait between retries using WAIT_STRATEGY.
+* ORDER selects the order in which items are taken from a block (see block_order).
+* Blocks are synchronised as a whole in either order. An enqueue that leaves a block
+* partially filled leaves it open for the next enqueue, and consumers take from the
+* open block only once the full blocks are exhausted. With block_order::fifo a
+* consumer holds the open block claimed while it takes from it, producers wait for
+* it rather than starting a newer block, so with a single producer items are
+* delivered in the order they were enqueued. Blocks that are still being filled by
+* concurrent producers go on the in-progress list and may be delivered before or
+* after full blocks, so with several producers only the order within a block is kept.
+* STATS selects whether operations are counted (see stats_policy.hpp).
+* Items are constructed in their block on enqueue and destroyed on dequeue, items
+* still queued are destroyed with their block.
 * Created on 27 August 2016, 11:30 PM
 */
 
@@ -19,19 +35,35 @@
 #include <array>
 #include <memory>
 #include <iostream>
+#include <limits>
+#include <cstdint>
 #include <bk_conq/unbounded_queue.hpp>
+#include <bk_conq/wait_strategy.hpp>
+#include <bk_conq/stats_policy.hpp>
+#include <bk_conq/details/uninitialized.hpp>
 
 namespace bk_conq {
 
-template<typename T>
-class chain_queue : public unbounded_queue<T, chain_queue<T>> {
-    friend unbounded_queue<T, chain_queue<T>>;
-    static const size_t BLOCK_SIZE = 1024;
+//lifo: items are taken from the end of a block, the last item written is the first delivered
+//fifo: each block keeps a read cursor alongside its write cursor, so items are delivered in the order they were written
+enum class block_order {
+    lifo,
+    fifo
+};
+
+template<typename T, size_t BLOCK_SIZE = 1024, typename ALLOCATOR = std::allocator<T>, typename WAIT_STRATEGY = yield_strategy, block_order ORDER = block_order::lifo, typename STATS = no_stats, producers P = producers::multi, consumers C = consumers::multi>
+class chain_queue : public unbounded_queue<T, chain_queue<T, BLOCK_SIZE, ALLOCATOR, WAIT_STRATEGY, ORDER, STATS, P, C>, P, C>, private STATS {
+    friend unbounded_queue<T, chain_queue<T, BLOCK_SIZE, ALLOCATOR, WAIT_STRATEGY, ORDER, STATS, P, C>, P, C>;
+    static_assert(BLOCK_SIZE > 0, "BLOCK_SIZE must be greater than 0");
 public:
-    chain_queue() {
-        auto hnode = new list_node_t;
-        auto flnode = new list_node_t;
-        auto ipnode = new list_node_t;
+    //prewarm_blocks are placed in the freelist up front, at most max_free_blocks are retained in the freelist
+    chain_queue(size_t prewarm_blocks = 0, size_t max_free_blocks = std::numeric_limits<size_t>::max(), const ALLOCATOR& allocator = ALLOCATOR()) :
+        _allocator(allocator),
+        _max_free_blocks(max_free_blocks)
+    {
+        auto hnode = allocate();
+        auto flnode = allocate();
+        auto ipnode = allocate();
 
         _head.store(hnode);
         _tail.store(_head.load(std::memory_order_relaxed), std::memory_order_relaxed);
@@ -39,6 +71,10 @@ public:
         _free_list_tail.store(_free_list_head.load(std::memory_order_relaxed), std::memory_order_relaxed);
         _in_progress_head.store(ipnode);
         _in_progress_tail.store(_in_progress_head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        for (size_t i = 0; i < prewarm_blocks; ++i) {
+            freelist_enqueue(allocate());
+        }
     }
 
     virtual ~chain_queue() {
@@ -48,84 +84,214 @@ public:
         for (next = tail->next.load(std::memory_order_relaxed); next != nullptr; ) {
             tail = next;
             next = next->next.load(std::memory_order_relaxed);
-            delete tail;
+            deallocate(tail);
         }
-        delete _tail.load();
+        deallocate(_tail.load());
 
         tail = _free_list_tail.load(std::memory_order_relaxed);
         for (next = tail->next.load(std::memory_order_relaxed); next != nullptr; ) {
             tail = next;
             next = next->next.load(std::memory_order_relaxed);
-            delete tail;
+            deallocate(tail);
         }
-        delete _free_list_tail.load();
+        deallocate(_free_list_tail.load());
 
         tail = _in_progress_tail.load(std::memory_order_relaxed);
         for (next = tail->next.load(std::memory_order_relaxed); next != nullptr; ) {
             tail = next;
             next = next->next.load(std::memory_order_relaxed);
-            delete tail;
+            deallocate(tail);
         }
-        delete _in_progress_tail.load();
+        deallocate(_in_progress_tail.load());
 
+        if (_open.load(std::memory_order_relaxed)) deallocate(_open.load(std::memory_order_relaxed));
     }
 
     chain_queue(const chain_queue&) = delete;
     void operator=(const chain_queue&) = delete;
 
+    queue_stats stats() const {
+        return STATS::collect();
+    }
+
 protected:
     template <typename R>
     void sp_enqueue_impl(R&& input) {
-        list_node_t *node = acquire_or_allocate(std::forward<R>(input));
-        if (!node) return;
-        _head.load(std::memory_order_relaxed)->next.store(node, std::memory_order_release);
-        _head.store(node, std::memory_order_relaxed);
+        sp_emplace_impl(std::forward<R>(input));
     }
 
     template <typename R>
     void mp_enqueue_impl(R&& input) {
-        list_node_t *node = acquire_or_allocate(std::forward<R>(input));
+        mp_emplace_impl(std::forward<R>(input));
+    }
+
+    template <typename... Args>
+    void sp_emplace_impl(Args&&... args) {
+        list_node_t *node = acquire_or_allocate<true>(std::forward<Args>(args)...);
+        STATS::add(queue_stat::enqueues);
+        if (!node) return;
+        publish<true>(node, node);
+    }
+
+    template <typename... Args>
+    void mp_emplace_impl(Args&&... args) {
+        list_node_t *node = acquire_or_allocate<false>(std::forward<Args>(args)...);
+        STATS::add(queue_stat::enqueues);
         if (!node) return;
-        list_node_t* prev_head = _head.exchange(node, std::memory_order_acq_rel);
-        prev_head->next.store(node, std::memory_order_release);
+        publish<false>(node, node);
+    }
+
+    //whole blocks are filled before they are published, and all full blocks are published with a single exchange
+    template <typename IT>
+    void sp_enqueue_bulk_impl(IT first, IT last) {
+        list_node_t *chain_tail = nullptr;
+        size_t count;
+        list_node_t *chain_head = fill_blocks<true>(first, last, chain_tail, count);
+        STATS::add(queue_stat::enqueues, count);
+        if (!chain_head) return;
+        publish<true>(chain_head, chain_tail);
+    }
+
+    template <typename IT>
+    void mp_enqueue_bulk_impl(IT first, IT last) {
+        list_node_t *chain_tail = nullptr;
+        size_t count;
+        list_node_t *chain_head = fill_blocks<false>(first, last, chain_tail, count);
+        STATS::add(queue_stat::enqueues, count);
+        if (!chain_head) return;
+        publish<false>(chain_head, chain_tail);
     }
 
     bool sc_dequeue_impl(T& output) {
         list_node_t* tail = _tail.load(std::memory_order_relaxed);
-        return dequeue_common(tail, output);
+        return dequeue_common(tail, &output, 1) != 0;
     }
 
     //spin on dequeue contention
     bool mc_dequeue_impl(T& output) {
-        list_node_t *tail;
-        for (tail = _tail.exchange(nullptr, std::memory_order_acq_rel); !tail; tail = _tail.exchange(nullptr, std::memory_order_acq_rel)) {
-            std::this_thread::yield();
-        }
-        return dequeue_common(tail, output);
+        return dequeue_common(acquire_tail(), &output, 1) != 0;
     }
 
     //return false on dequeue contention
     bool mc_dequeue_uncontended_impl(T& output) {
         list_node_t *tail = _tail.exchange(nullptr, std::memory_order_acq_rel);
-        if (!tail) return false;
-        return dequeue_common(tail, output);
+        if (!tail) {
+            STATS::add(queue_stat::contention_spins);
+            return false;
+        }
+        return dequeue_common(tail, &output, 1) != 0;
+    }
+
+    template <typename IT>
+    size_t sc_dequeue_bulk_impl(IT output, size_t max) {
+        list_node_t* tail = _tail.load(std::memory_order_relaxed);
+        return dequeue_common(tail, output, max);
+    }
+
+    //spin on dequeue contention
+    template <typename IT>
+    size_t mc_dequeue_bulk_impl(IT output, size_t max) {
+        return dequeue_common(acquire_tail(), output, max);
+    }
+
+    //items are counted once per operation, by producers before the items can be dequeued and by consumers after they
+    //are taken, so items in open and in progress blocks are included and the size is never short of the items that
+    //can be dequeued. the consumer counts are read first, so every dequeue seen has its enqueue seen too
+    size_t size_approx_impl() const {
+        size_t dequeued = _dequeued.load(std::memory_order_acquire) + _partial_dequeued.load(std::memory_order_acquire);
+        size_t enqueued = _enqueued.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
     }
 
 private:
 
+    //the items between the cursors are live, the rest of the block is uninitialized storage
     struct list_node_t {
-        std::array<T, BLOCK_SIZE> data;
+        std::array<details::uninitialized<T>, BLOCK_SIZE> data;
         std::atomic<list_node_t*> next{ nullptr };
 
         size_t indx{ 0 };
+        //only used with block_order::fifo, items before it have already been taken
+        size_t read{ 0 };
         list_node_t() {}
-        template <typename R>
-        bool put_get_full(R&& item) {
-            data[indx] = std::forward<R>(item);
+
+        ~list_node_t() {
+            for (size_t i = ORDER == block_order::fifo ? read : 0; i < indx; ++i) {
+                data[i].destroy();
+            }
+        }
+
+        template <typename... Args>
+        bool emplace_get_full(Args&&... args) {
+            data[indx].construct(std::forward<Args>(args)...);
             return (++indx == BLOCK_SIZE);
         }
+
+        bool empty() const {
+            return ORDER == block_order::fifo ? read == indx : indx == 0;
+        }
+
+        size_t size() const {
+            return ORDER == block_order::fifo ? indx - read : indx;
+        }
+
+        template <typename R>
+        void take(R&& output) {
+            (ORDER == block_order::fifo ? data[read++] : data[--indx]).move_to(std::forward<R>(output));
+        }
+
+        //a drained fifo block has both cursors at the point where it was drained
+        void reset() {
+            indx = 0;
+            read = 0;
+        }
     };
 
+    //for counters that are only written by a single producer, or by the holder of the tail
+    static void exclusive_add(std::atomic<size_t>& counter, size_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    //items are added before they are made visible to consumers
+    template <bool EXCLUSIVE>
+    void count_enqueued(size_t n) {
+        if (EXCLUSIVE) exclusive_add(_enqueued, n);
+        else _enqueued.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    //the open block is marked with this while a consumer takes from it under block_order::fifo
+    static list_node_t* claimed() {
+        return reinterpret_cast<list_node_t*>(std::uintptr_t(1));
+    }
+
+    //links the chain first..last onto the queue, EXCLUSIVE when there is a single producer
+    template <bool EXCLUSIVE>
+    void publish(list_node_t* first, list_node_t* last) {
+        if (EXCLUSIVE) {
+            _head.load(std::memory_order_relaxed)->next.store(first, std::memory_order_release);
+            _head.store(last, std::memory_order_relaxed);
+        }
+        else {
+            list_node_t* prev_head = _head.exchange(last, std::memory_order_acq_rel);
+            prev_head->next.store(first, std::memory_order_release);
+        }
+        //counted once the chain is linked, see dequeue_common
+        if (ORDER == block_order::fifo) {
+            if (EXCLUSIVE) exclusive_add(_published, 1);
+            else _published.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    list_node_t* acquire_tail() {
+        list_node_t *tail;
+        WAIT_STRATEGY strategy;
+        for (tail = _tail.exchange(nullptr, std::memory_order_acq_rel); !tail; tail = _tail.exchange(nullptr, std::memory_order_acq_rel)) {
+            STATS::add(queue_stat::contention_spins);
+            strategy.wait();
+        }
+        return tail;
+    }
+
     void list_enqueue(list_node_t* item, std::atomic<list_node_t*>& head) {
         item->next.store(nullptr, std::memory_order_relaxed);
         list_node_t * prev_head = head.exchange(item, std::memory_order_acq_rel);
@@ -134,8 +300,10 @@ private:
 
     list_node_t* list_dequeue(std::atomic<list_node_t*>& tail) {
         list_node_t *item;
+        WAIT_STRATEGY strategy;
         for (item = tail.exchange(nullptr, std::memory_order_acq_rel); !item; item = tail.exchange(nullptr, std::memory_order_acq_rel)) {
-            std::this_thread::yield();
+            STATS::add(queue_stat::contention_spins);
+            strategy.wait();
         }
         list_node_t* next = item->next.load(std::memory_order_acquire);
         if (!next) {
@@ -146,41 +314,83 @@ private:
         return item;
     }
 
-    bool dequeue_common(list_node_t* tail, T& output) {
-        //get item directly from tail
-        if (tail->indx != 0) { //success
-            output = std::move(tail->data[--tail->indx]);
-            if (tail->indx == 0) { //if we are now empty
-                list_node_t *next = tail->next.load(std::memory_order_acquire);
-                if (next) { //we only want to progress if tail->next is valid
-                    _tail.store(next, std::memory_order_release);
-                    freelist_enqueue(tail);
-                    return true;
-                }
-            }
-            //either more elements or next node is nullptr so can't progress
-            _tail.store(tail, std::memory_order_release);
-            return true;
+    //moves up to max items out of a block that is exclusively held by the caller
+    template <typename IT>
+    size_t take_from(list_node_t* node, IT& output, size_t max) {
+        size_t count = 0;
+        for (; count < max && !node->empty(); ++count, ++output) {
+            node->take(*output);
         }
+        return count;
+    }
 
-        //nothing in tail, go next
-        list_node_t *next = tail->next.load(std::memory_order_acquire);
-        if (!next) {
-            //restore the tail so that other dequeue operations can progress
-            _tail.store(tail, std::memory_order_release);
-            return try_get_from_inprogress(output);
+    //with block_order::fifo, blocks published after the queue was drained hold items that are older than those in the
+    //open block, so if any were published by the time the open block is claimed the queue is drained again
+    template <typename IT>
+    size_t dequeue_common(list_node_t* tail, IT output, size_t max) {
+        size_t count = 0;
+        size_t partial = 0;
+        while (true) {
+            size_t published = _published.load(std::memory_order_acquire);
+            count += take_from_queue(tail, output, max - count);
+            size_t before = count;
+            if (count < max) count += try_get_from_inprogress(output, max - count);
+            bool done = count == max || try_get_from_open(output, max, count, published);
+            partial += count - before;
+            if (done) break;
+            tail = acquire_tail();
         }
-        freelist_enqueue(tail);
-        return dequeue_common(next, output);
+        //consumers take from in progress and open blocks concurrently, so they are counted apart from the tail holder
+        if (partial) _partial_dequeued.fetch_add(partial, std::memory_order_release);
+        if (count) {
+            STATS::add(queue_stat::dequeues, count);
+        }
+        else {
+            STATS::add(queue_stat::empty_failures);
+        }
+        return count;
     }
 
+    //takes from the full blocks on the queue, starting with the tail that is exclusively held by the caller, and
+    //restores the tail so that other dequeue operations can progress
+    template <typename IT>
+    size_t take_from_queue(list_node_t* tail, IT& output, size_t max) {
+        size_t count = 0;
+        while (true) {
+            //get items directly from tail
+            count += take_from(tail, output, max - count);
+            //we only want to progress if tail is now empty and tail->next is valid
+            list_node_t *next = tail->empty() ? tail->next.load(std::memory_order_acquire) : nullptr;
+            if (!next) break;
+            freelist_enqueue(tail);
+            tail = next;
+            if (count == max) break;
+        }
+        //either more elements or next node is nullptr so can't progress
+        if (count) exclusive_add(_dequeued, count);
+        _tail.store(tail, std::memory_order_release);
+        return count;
+    }
 
+    //surplus blocks beyond the high water mark are returned to the allocator. A place in the freelist is
+    //reserved before the block is linked in and given up after it is unlinked, so concurrent releasers
+    //cannot take the freelist past max_free_blocks
     void freelist_enqueue(list_node_t *item) {
+        size_t free_blocks = _free_blocks.load(std::memory_order_relaxed);
+        do {
+            if (free_blocks >= _max_free_blocks) {
+                deallocate(item);
+                return;
+            }
+        } while (!_free_blocks.compare_exchange_weak(free_blocks, free_blocks + 1, std::memory_order_relaxed));
+        item->reset();
         list_enqueue(item, _free_list_head);
     }
 
     list_node_t* freelist_try_dequeue() {
-        return list_dequeue(_free_list_tail);
+        list_node_t* item = list_dequeue(_free_list_tail);
+        if (item) _free_blocks.fetch_sub(1, std::memory_order_relaxed);
+        return item;
     }
 
     void inprogress_enqueue(list_node_t *item) {
@@ -191,79 +401,190 @@ private:
         return list_dequeue(_in_progress_tail);
     }
 
-    bool try_get_from_inprogress_tail(T& output) {
+    template <typename IT>
+    size_t try_get_from_inprogress_tail(IT& output, size_t max) {
         list_node_t* item;
+        WAIT_STRATEGY strategy;
         for (item = _in_progress_tail.exchange(nullptr, std::memory_order_acq_rel); !item; item = _in_progress_tail.exchange(nullptr, std::memory_order_acq_rel)) {
-            std::this_thread::yield();
-        }
-        if (item->indx != 0) { //success
-            output = std::move(item->data[--item->indx]);
-            if (item->indx == 0) { //if we are now empty
-                list_node_t *next = item->next.load(std::memory_order_acquire);
-                if (next) { //we only want to progress if tail->next is valid
-                    _in_progress_tail.store(next, std::memory_order_release);
-                    freelist_enqueue(item);
-                    return true;
-                }
+            STATS::add(queue_stat::contention_spins);
+            strategy.wait();
+        }
+        size_t count = take_from(item, output, max);
+        if (count != 0 && item->empty()) { //if we are now empty
+            list_node_t *next = item->next.load(std::memory_order_acquire);
+            if (next) { //we only want to progress if tail->next is valid
+                _in_progress_tail.store(next, std::memory_order_release);
+                freelist_enqueue(item);
+                return count;
             }
-            //either more elements or next node is nullptr so can't progress
-            _in_progress_tail.store(item, std::memory_order_release);
-            return true;
         }
+        //either more elements or next node is nullptr so can't progress
         _in_progress_tail.store(item, std::memory_order_release);
-
-        return false;
+        return count;
     }
 
-    bool try_get_from_inprogress(T& output) {
-        list_node_t* item;
-        item = inprogress_try_dequeue();
-        if (item == nullptr) {
-            return try_get_from_inprogress_tail(output);
-        }
-
-        if (item->indx != 0) { //success
-            output = std::move(item->data[--item->indx]);
-            if (item->indx == 0) { //if we are now empty
+    template <typename IT>
+    size_t try_get_from_inprogress(IT& output, size_t max) {
+        size_t count = 0;
+        while (count < max) {
+            list_node_t* item = inprogress_try_dequeue();
+            if (item == nullptr) {
+                count += try_get_from_inprogress_tail(output, max - count);
+                return count;
+            }
+            count += take_from(item, output, max - count);
+            if (item->empty()) { //if we are now empty
                 freelist_enqueue(item);
             }
             else {
                 item->next.store(nullptr, std::memory_order_relaxed);
-                list_node_t* prev_head = _head.exchange(item, std::memory_order_acq_rel);
-                prev_head->next.store(item, std::memory_order_release);
+                publish<false>(item, item);
             }
+        }
+        return count;
+    }
+
+
+    //the open block holds the most recently enqueued items, so it is taken from last. adds what it takes to count and
+    //returns false, without taking anything, if blocks were published since published was read
+    template <typename IT>
+    bool try_get_from_open(IT& output, size_t max, size_t& count, size_t published) {
+        if (ORDER == block_order::lifo) {
+            list_node_t* item = _open.exchange(nullptr, std::memory_order_acq_rel);
+            if (!item) return true;
+            count += take_from(item, output, max - count);
+            if (item->empty()) freelist_enqueue(item);
+            else release_open(item);
             return true;
         }
-        freelist_enqueue(item);
-        return try_get_from_inprogress(output);
+        list_node_t* item = take_open(claimed());
+        if (!item) return true;
+        if (_published.load(std::memory_order_acquire) != published) {
+            _open.store(item, std::memory_order_release);
+            return false;
+        }
+        count += take_from(item, output, max - count);
+        if (item->empty()) {
+            freelist_enqueue(item);
+            item = nullptr;
+        }
+        //the open block is still claimed, so the store cannot overwrite a block left open by a producer
+        _open.store(item, std::memory_order_release);
+        return true;
     }
 
+    //claims the open block by replacing it with replacement, waits while a consumer has it claimed
+    list_node_t* take_open(list_node_t* replacement) {
+        list_node_t* item = _open.load(std::memory_order_relaxed);
+        WAIT_STRATEGY strategy;
+        while (true) {
+            if (item == claimed()) {
+                STATS::add(queue_stat::contention_spins);
+                strategy.wait();
+                item = _open.load(std::memory_order_relaxed);
+            }
+            else if (!item || _open.compare_exchange_weak(item, replacement, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return item;
+            }
+        }
+    }
+
+    //a partially filled block is left open for the next enqueue, or goes on the in progress list if another block was left open first
+    void release_open(list_node_t* item) {
+        list_node_t* expected = nullptr;
+        if (!_open.compare_exchange_strong(expected, item, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            inprogress_enqueue(item);
+        }
+    }
 
     list_node_t* allocate() {
-        return new list_node_t;
+        list_node_t* node = block_traits::allocate(_allocator, 1);
+        block_traits::construct(_allocator, node);
+        return node;
     }
 
-    template<typename R>
-    list_node_t *acquire_or_allocate(R&& input) {
-        list_node_t* node = inprogress_try_dequeue(); //try get space from the in progress enqueue operations
-        if (!node) node = freelist_try_dequeue();//attempt to recycle previously used storage 
-        if (!node) node = allocate(); //allocate new storage
-        if (node->put_get_full(std::forward<R>(input))) {
+    void deallocate(list_node_t* node) {
+        block_traits::destroy(_allocator, node);
+        block_traits::deallocate(_allocator, node, 1);
+    }
+
+    list_node_t *acquire() {
+        //keep filling the block the last enqueue left open
+        list_node_t* node = ORDER == block_order::fifo ? take_open(nullptr) : _open.exchange(nullptr, std::memory_order_acq_rel);
+        if (!node) node = inprogress_try_dequeue(); //try get space from the in progress enqueue operations
+        if (!node) {
+            node = freelist_try_dequeue();//attempt to recycle previously used storage 
+            if (node) STATS::add(queue_stat::freelist_hits);
+        }
+        if (!node) {
+            node = allocate(); //allocate new storage
+            STATS::add(queue_stat::allocations);
+        }
+        return node;
+    }
+
+    template<bool EXCLUSIVE, typename... Args>
+    list_node_t *acquire_or_allocate(Args&&... args) {
+        list_node_t* node = acquire();
+        bool full = node->emplace_get_full(std::forward<Args>(args)...);
+        count_enqueued<EXCLUSIVE>(1);
+        if (full) {
             node->next.store(nullptr, std::memory_order_relaxed);
             return node;
         }
-        inprogress_enqueue(node);
+        release_open(node);
         return nullptr;
     }
 
+    //returns the chain of blocks that were filled by the range, a partially filled block is left open
+    //all count items are counted before the open block is released or the chain is published
+    template <bool EXCLUSIVE, typename IT>
+    list_node_t *fill_blocks(IT first, IT last, list_node_t*& chain_tail, size_t& count) {
+        list_node_t *chain_head = nullptr;
+        list_node_t *open = nullptr;
+        count = 0;
+        while (first != last) {
+            list_node_t* node = acquire();
+            bool full = false;
+            for (; first != last && !full; ++first, ++count) {
+                full = node->emplace_get_full(*first);
+            }
+            if (!full) {
+                open = node;
+                break;
+            }
+            node->next.store(nullptr, std::memory_order_relaxed);
+            if (!chain_head) chain_head = node;
+            else chain_tail->next.store(node, std::memory_order_relaxed);
+            chain_tail = node;
+        }
+        if (count) count_enqueued<EXCLUSIVE>(count);
+        if (open) release_open(open);
+        return chain_head;
+    }
+
+    using block_allocator_t = typename std::allocator_traits<ALLOCATOR>::template rebind_alloc<list_node_t>;
+    using block_traits = std::allocator_traits<block_allocator_t>;
+
+    block_allocator_t _allocator;
+    const size_t _max_free_blocks;
+    std::atomic<size_t> _free_blocks{ 0 };
     std::atomic<list_node_t*> _in_progress_head;
     std::atomic<list_node_t*> _head;
+    std::atomic<size_t> _enqueued{ 0 };
     std::atomic<list_node_t*> _free_list_tail;
     std::array<char, 64> _padding1;
     std::atomic<list_node_t*> _tail;
+    std::atomic<size_t> _dequeued{ 0 };
+    //the number of chains published under block_order::fifo
+    std::atomic<size_t> _published{ 0 };
     std::atomic<list_node_t*> _free_list_head;
     std::array<char, 64> _padding2;
     std::atomic<list_node_t*> _in_progress_tail;
+    //items taken from in progress and open blocks, _dequeued is only written by the holder of the tail
+    std::atomic<size_t> _partial_dequeued{ 0 };
+    //a partially filled block, claimed by exchanging it for nullptr, or for claimed() by a consumer under block_order::fifo
+    std::atomic<list_node_t*> _open{ nullptr };
 };
 }//namespace bk_conq
 
@@ -0,0 +1,447 @@
+/*
+* File:   dequeue_policy.hpp
+* Author: Barath Kannan
+* Policies that decide how a consumer thread of a multi queue searches the subqueues.
+* A dequeue policy provides a consumer<T> class, one instance of which is held per
+* consumer thread. It is constructed from the multi queue's assignment policy, and its
+* dequeue operations are given an accessor that maps a subqueue index to the subqueue.
+* flush() is called when the consumer thread exits, to hand back anything it still holds.
+* An accessor may also provide count(), the number of subqueues to visit, which can change
+* between calls as an adaptive multi queue grows and retires subqueues. Consumers then bring
+* their own state up to date at the start of their next operation.
+* consumer<T, STATS> may also be given the multi queue's statistics policy, on which it
+* records its own events (see stats_policy.hpp).
+* Created on 14 October 2026 11:05 PM
+*/
+
+#ifndef BK_CONQ_DEQUEUE_POLICY_HPP
+#define BK_CONQ_DEQUEUE_POLICY_HPP
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <bk_conq/bounded_queue.hpp>
+#include <bk_conq/stats_policy.hpp>
+#include <bk_conq/details/ref_iterator.hpp>
+#include <bk_conq/details/consume_iterator.hpp>
+#include <bk_conq/details/uninitialized.hpp>
+#include <bk_conq/details/xorshift.hpp>
+
+namespace bk_conq {
+namespace details {
+
+//the number of subqueues to visit, known when the accessor does not give it
+template <typename F>
+auto subqueue_count(const F& subqueue, size_t, int) -> decltype(subqueue.count()) {
+    return subqueue.count();
+}
+
+template <typename F>
+size_t subqueue_count(const F&, size_t known, long) {
+    return known;
+}
+
+}//namespace details
+
+//every subqueue is visited in the order of a hit list, starting from the assignment policy's order
+//the subqueue on which a dequeue succeeds is moved to the front of the list
+class hitlist_dequeue {
+public:
+    template <typename T, typename STATS = no_stats>
+    class consumer {
+    public:
+        consumer() = default;
+
+        template <typename ASSIGNMENT>
+        explicit consumer(ASSIGNMENT& assignment, STATS* stats = nullptr) : _hitlist(assignment.hitlist()), _stats(stats) {}
+
+        template <typename F>
+        bool sc_dequeue(F&& subqueue, T& output) {
+            resize(details::subqueue_count(subqueue, _hitlist.size(), 0));
+            for (auto it = _hitlist.cbegin(); it != _hitlist.cend(); ++it) {
+                if (subqueue(*it).sc_dequeue(output)) {
+                    promote(it);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template <typename F>
+        bool mc_dequeue(F&& subqueue, T& output) {
+            resize(details::subqueue_count(subqueue, _hitlist.size(), 0));
+            for (auto it = _hitlist.cbegin(); it != _hitlist.cend(); ++it) {
+                if (subqueue(*it).mc_dequeue_uncontended(output)) {
+                    promote(it);
+                    return true;
+                }
+            }
+            for (auto it = _hitlist.cbegin(); it != _hitlist.cend(); ++it) {
+                if (subqueue(*it).mc_dequeue(output)) {
+                    promote(it);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template <typename F>
+        bool mc_dequeue_uncontended(F&& subqueue, T& output) {
+            resize(details::subqueue_count(subqueue, _hitlist.size(), 0));
+            for (auto it = _hitlist.cbegin(); it != _hitlist.cend(); ++it) {
+                if (subqueue(*it).mc_dequeue_uncontended(output)) {
+                    promote(it);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        //the subqueue that provides the first item of the batch is pushed to the front of the hitlist
+        template <typename F, typename IT>
+        size_t sc_dequeue_bulk(F&& subqueue, IT output, size_t max) {
+            resize(details::subqueue_count(subqueue, _hitlist.size(), 0));
+            size_t count = 0;
+            for (auto it = _hitlist.cbegin(); it != _hitlist.cend() && count < max; ++it) {
+                size_t dequeued = subqueue(*it).sc_dequeue_bulk(details::make_ref_iterator(output), max - count);
+                if (dequeued && count == 0) promote(it);
+                count += dequeued;
+            }
+            return count;
+        }
+
+        template <typename F, typename IT>
+        size_t mc_dequeue_bulk(F&& subqueue, IT output, size_t max) {
+            resize(details::subqueue_count(subqueue, _hitlist.size(), 0));
+            size_t count = 0;
+            for (auto it = _hitlist.cbegin(); it != _hitlist.cend() && count < max; ++it) {
+                size_t dequeued = subqueue(*it).mc_dequeue_bulk(details::make_ref_iterator(output), max - count);
+                if (dequeued && count == 0) promote(it);
+                count += dequeued;
+            }
+            return count;
+        }
+
+        template <typename F>
+        void flush(F&&) {}
+
+    private:
+        //subqueues beyond the count are dropped from the hit list and new subqueues are added at its end
+        void resize(size_t subqueues) {
+            if (subqueues == _hitlist.size()) return;
+            _hitlist.erase(std::remove_if(_hitlist.begin(), _hitlist.end(), [&](size_t index) { return index >= subqueues; }), _hitlist.end());
+            for (size_t index = _hitlist.size(); index < subqueues; ++index) _hitlist.push_back(index);
+        }
+
+        void promote(std::vector<size_t>::const_iterator it) {
+            if (_hitlist.cbegin() == it) return;
+            if (STATS::enabled && _stats) _stats->add(queue_stat::hitlist_reorders);
+            //funky magic - range erase returns an iterator, but an empty range is provided so contents aren't changed
+            //this converts a const iterator to an iterator in constant time
+            auto nonconstit = _hitlist.erase(it, it);
+            for (auto it2 = _hitlist.begin(); it2 != nonconstit; ++it2) std::iter_swap(nonconstit, it2);
+        }
+
+        std::vector<size_t> _hitlist;
+        STATS* _stats = nullptr;
+    };
+};
+
+//each consumer owns a home subqueue, given by the assignment policy, and visits its home subqueue and then
+//at most MAX_PROBES other subqueues, probed in an order that is shuffled per consumer and continuing from
+//where the previous dequeue stopped. Only if all of them are empty are the remaining subqueues swept, so a
+//failed dequeue still means that every subqueue was found empty, and a blocking consumer does not sleep
+//while items are queued on a subqueue it did not probe.
+//A single item dequeue that finds a subqueue other than its home takes up to STEAL_BATCH items with a bulk
+//dequeue and keeps the remainder in a consumer local buffer, which is served before any subqueue is visited.
+//Buffered items are constructed in place, so T need not be default constructible. They are handed back to
+//the home subqueue when the consumer thread exits, until then they are only visible to the consumer that
+//stole them.
+template <size_t MAX_PROBES = 4, size_t STEAL_BATCH = 32>
+class stealing_dequeue {
+    static_assert(MAX_PROBES > 0, "MAX_PROBES must be greater than 0");
+    static_assert(STEAL_BATCH > 0, "STEAL_BATCH must be greater than 0");
+
+public:
+    template <typename T, typename STATS = no_stats>
+    class consumer {
+    public:
+        consumer() = default;
+
+        template <typename ASSIGNMENT>
+        explicit consumer(ASSIGNMENT& assignment, STATS* = nullptr) :
+            _home(assignment.home()),
+            _victims(assignment.hitlist()),
+            _subqueues(_victims.size()),
+            _rng(details::xorshift::thread_seed())
+        {
+            _victims.erase(std::remove(_victims.begin(), _victims.end(), _home), _victims.end());
+            //fisher-yates shuffle with xorshift, so that consumers spread their probes over different subqueues
+            for (size_t i = _victims.size(); i > 1; --i) {
+                std::swap(_victims[i - 1], _victims[_rng.next() % i]);
+            }
+        }
+
+        template <typename F>
+        bool sc_dequeue(F&& subqueue, T& output) {
+            resize(details::subqueue_count(subqueue, _subqueues, 0));
+            if (take_buffered(output)) return true;
+            if (subqueue(_home).sc_dequeue(output)) return true;
+            return steal(subqueue, output, [](auto& q, auto it, size_t max) { return q.sc_dequeue_bulk(it, max); });
+        }
+
+        template <typename F>
+        bool mc_dequeue(F&& subqueue, T& output) {
+            resize(details::subqueue_count(subqueue, _subqueues, 0));
+            if (take_buffered(output)) return true;
+            if (subqueue(_home).mc_dequeue(output)) return true;
+            return steal(subqueue, output, [](auto& q, auto it, size_t max) { return q.mc_dequeue_bulk(it, max); });
+        }
+
+        //does not steal in bulk, as a bulk dequeue may contend
+        template <typename F>
+        bool mc_dequeue_uncontended(F&& subqueue, T& output) {
+            resize(details::subqueue_count(subqueue, _subqueues, 0));
+            if (take_buffered(output)) return true;
+            if (subqueue(_home).mc_dequeue_uncontended(output)) return true;
+            for (size_t probe = 0; probe < probes(); ++probe) {
+                if (subqueue(next_victim()).mc_dequeue_uncontended(output)) return true;
+            }
+            return sweep([&](size_t victim) { return subqueue(victim).mc_dequeue_uncontended(output); });
+        }
+
+        template <typename F, typename IT>
+        size_t sc_dequeue_bulk(F&& subqueue, IT output, size_t max) {
+            resize(details::subqueue_count(subqueue, _subqueues, 0));
+            return dequeue_bulk(subqueue, output, max, [](auto& q, auto it, size_t max) { return q.sc_dequeue_bulk(it, max); });
+        }
+
+        template <typename F, typename IT>
+        size_t mc_dequeue_bulk(F&& subqueue, IT output, size_t max) {
+            resize(details::subqueue_count(subqueue, _subqueues, 0));
+            return dequeue_bulk(subqueue, output, max, [](auto& q, auto it, size_t max) { return q.mc_dequeue_bulk(it, max); });
+        }
+
+        //hands the buffered items back to the home subqueue
+        template <typename F>
+        void flush(F&& subqueue) {
+            if (!_stolen) return;
+            for (; _stolen->next != _stolen->count; ++_stolen->next) {
+                details::uninitialized<T>& item = _stolen->items[_stolen->next];
+                give_back(subqueue, std::move(item.get()), std::is_base_of<bounded_queue_tag, std::decay_t<decltype(subqueue(_home))>>());
+                item.destroy();
+            }
+            _stolen.reset();
+        }
+
+    private:
+        //a home beyond the count is replaced at random, and the victims are shuffled again
+        void resize(size_t subqueues) {
+            if (subqueues == _subqueues) return;
+            _subqueues = subqueues;
+            if (_home >= subqueues) _home = _rng.next() % subqueues;
+            _victims.clear();
+            for (size_t index = 0; index < subqueues; ++index) {
+                if (index != _home) _victims.push_back(index);
+            }
+            for (size_t i = _victims.size(); i > 1; --i) {
+                std::swap(_victims[i - 1], _victims[_rng.next() % i]);
+            }
+            _cursor = 0;
+        }
+
+        size_t probes() const {
+            return std::min(MAX_PROBES, _victims.size());
+        }
+
+        size_t next_victim() {
+            size_t victim = _victims[_cursor];
+            if (++_cursor == _victims.size()) _cursor = 0;
+            return victim;
+        }
+
+        //the victims that the probes did not reach, visited without moving the cursor
+        template <typename OP>
+        bool sweep(OP op) {
+            for (size_t i = 0; i + probes() < _victims.size(); ++i) {
+                if (op(_victims[(_cursor + i) % _victims.size()])) return true;
+            }
+            return false;
+        }
+
+        bool take_buffered(T& output) {
+            if (!_stolen || _stolen->next == _stolen->count) return false;
+            _stolen->items[_stolen->next++].move_to(output);
+            return true;
+        }
+
+        //the stolen items are moved out of the victim into the buffer, starting at its first item
+        template <typename F, typename BULK>
+        bool steal_from(F& subqueue, size_t victim, T& output, BULK& bulk) {
+            if (!_stolen) _stolen.reset(new stolen_items);
+            size_t count = 0;
+            auto construct = [&](T& item) { _stolen->items[count++].construct(std::move(item)); };
+            if (!bulk(subqueue(victim), details::make_consume_iterator(construct), STEAL_BATCH)) return false;
+            _stolen->items[0].move_to(output);
+            _stolen->next = 1;
+            _stolen->count = count;
+            return true;
+        }
+
+        template <typename F, typename BULK>
+        bool steal(F& subqueue, T& output, BULK bulk) {
+            for (size_t probe = 0; probe < probes(); ++probe) {
+                if (steal_from(subqueue, next_victim(), output, bulk)) return true;
+            }
+            return sweep([&](size_t victim) { return steal_from(subqueue, victim, output, bulk); });
+        }
+
+        //a bulk dequeue is given the buffered items first, then the home subqueue and the probed subqueues
+        template <typename F, typename IT, typename BULK>
+        size_t dequeue_bulk(F& subqueue, IT output, size_t max, BULK bulk) {
+            size_t count = 0;
+            for (; _stolen && _stolen->next != _stolen->count && count < max; ++count, ++output) {
+                _stolen->items[_stolen->next++].move_to(*output);
+            }
+            if (count < max) count += bulk(subqueue(_home), details::make_ref_iterator(output), max - count);
+            for (size_t probe = 0; probe < probes() && count < max; ++probe) {
+                count += bulk(subqueue(next_victim()), details::make_ref_iterator(output), max - count);
+            }
+            if (!count) sweep([&](size_t victim) { return (count = bulk(subqueue(victim), details::make_ref_iterator(output), max)) != 0; });
+            return count;
+        }
+
+        template <typename F>
+        void give_back(F& subqueue, T&& item, std::false_type) {
+            subqueue(_home).mp_enqueue(std::move(item));
+        }
+
+        //a bounded home subqueue may be full, so the item is offered to the other subqueues,
+        //waiting for space if every subqueue is full. a failed enqueue leaves the item untouched
+        template <typename F>
+        void give_back(F& subqueue, T&& item, std::true_type) {
+            if (subqueue(_home).mp_enqueue(std::move(item))) return;
+            while (true) {
+                for (size_t probe = 0; probe < _victims.size(); ++probe) {
+                    if (subqueue(next_victim()).mp_enqueue(std::move(item))) return;
+                }
+                std::this_thread::yield();
+                if (subqueue(_home).mp_enqueue(std::move(item))) return;
+            }
+        }
+
+        //items from next to count are live
+        struct stolen_items {
+            details::uninitialized<T> items[STEAL_BATCH];
+            size_t next{ 0 };
+            size_t count{ 0 };
+
+            ~stolen_items() {
+                for (; next != count; ++next) items[next].destroy();
+            }
+        };
+
+        size_t _home{ 0 };
+        std::vector<size_t> _victims;
+        size_t _subqueues{ 0 };
+        size_t _cursor{ 0 };
+        details::xorshift _rng;
+        std::unique_ptr<stolen_items> _stolen;
+    };
+};
+
+//relaxed order, for workloads such as job dispatch that do not need FIFO order across subqueues
+//each dequeue samples two distinct subqueues at random and takes from the one with the larger approximate
+//size (the power of two choices), then from the other. Only if both are empty are all subqueues visited,
+//from a random start, so a failed dequeue still means that every subqueue was found empty.
+//No consumer prefers a subqueue, so the cost of a dequeue does not depend on the number of consumers.
+//Rank error: with n subqueues and items spread uniformly at random over them, the analysis of two-choice
+//MultiQueues bounds the expected rank error of a dequeue (the number of older items still queued) by O(n),
+//and by O(n log n) with high probability. Comparing sizes rather than the age of the oldest items keeps the
+//subqueues balanced rather than aligned in age, so the bound is indicative, and producers that stick to a
+//subqueue add any imbalance in their enqueue rates to it. Subqueues without size_approx() are sampled uniformly.
+class two_choice_dequeue {
+public:
+    template <typename T, typename STATS = no_stats>
+    class consumer {
+    public:
+        consumer() = default;
+
+        template <typename ASSIGNMENT>
+        explicit consumer(ASSIGNMENT& assignment, STATS* = nullptr) :
+            _subqueues(assignment.hitlist().size()),
+            _rng(details::xorshift::thread_seed())
+        {}
+
+        template <typename F>
+        bool sc_dequeue(F&& subqueue, T& output) {
+            return dequeue(subqueue, [&](auto& q) { return q.sc_dequeue(output); });
+        }
+
+        template <typename F>
+        bool mc_dequeue(F&& subqueue, T& output) {
+            return dequeue(subqueue, [&](auto& q) { return q.mc_dequeue(output); });
+        }
+
+        template <typename F>
+        bool mc_dequeue_uncontended(F&& subqueue, T& output) {
+            return dequeue(subqueue, [&](auto& q) { return q.mc_dequeue_uncontended(output); });
+        }
+
+        //a batch is taken from a single subqueue
+        template <typename F, typename IT>
+        size_t sc_dequeue_bulk(F&& subqueue, IT output, size_t max) {
+            return dequeue(subqueue, [&](auto& q) { return q.sc_dequeue_bulk(output, max); });
+        }
+
+        template <typename F, typename IT>
+        size_t mc_dequeue_bulk(F&& subqueue, IT output, size_t max) {
+            return dequeue(subqueue, [&](auto& q) { return q.mc_dequeue_bulk(output, max); });
+        }
+
+        template <typename F>
+        void flush(F&&) {}
+
+    private:
+        template <typename Q>
+        static auto size_of(Q& q, int) -> decltype(q.size_approx()) {
+            return q.size_approx();
+        }
+
+        template <typename Q>
+        static size_t size_of(Q&, long) {
+            return 0;
+        }
+
+        template <typename F, typename OP>
+        auto dequeue(F& subqueue, OP op) -> decltype(op(subqueue(0))) {
+            decltype(op(subqueue(0))) ret{};
+            size_t subqueues = details::subqueue_count(subqueue, _subqueues, 0);
+            if (subqueues > 1) {
+                size_t first = _rng.next() % subqueues;
+                size_t second = _rng.next() % (subqueues - 1);
+                if (second >= first) ++second;
+                if (size_of(subqueue(second), 0) > size_of(subqueue(first), 0)) std::swap(first, second);
+                if ((ret = op(subqueue(first))) || (ret = op(subqueue(second)))) return ret;
+            }
+            size_t start = _rng.next() % subqueues;
+            for (size_t i = 0; i < subqueues; ++i) {
+                if ((ret = op(subqueue((start + i) % subqueues)))) return ret;
+            }
+            return ret;
+        }
+
+        size_t _subqueues{ 1 };
+        details::xorshift _rng;
+    };
+};
+
+}//namespace bk_conq
+
+#endif // BK_CONQ_DEQUEUE_POLICY_HPP
@@ -0,0 +1,31 @@
+/*
+* File:   bits.hpp
+* Author: Barath Kannan
+* Bit manipulation helpers for the lock-free index registries.
+* Created on 14 October 2026 11:40 PM
+*/
+
+#ifndef BK_CONQ_BITS_HPP
+#define BK_CONQ_BITS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bk_conq {
+namespace details {
+
+//index of the lowest set bit of a non-zero word
+inline size_t lowest_set_bit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(word));
+#else
+    size_t bit = 0;
+    while (!(word & (uint64_t(1) << bit))) ++bit;
+    return bit;
+#endif
+}
+
+}//namespace details
+}//namespace bk_conq
+
+#endif // BK_CONQ_BITS_HPP
@@ -0,0 +1,64 @@
+/*
+* File:   consume_iterator.hpp
+* Author: Barath Kannan
+* Output iterator that hands each item assigned through it to a callable by reference,
+* so that a bulk dequeue operation can be used to consume items in their slots.
+* Created on 14 October 2026 11:59 PM
+*/
+
+#ifndef BK_CONQ_CONSUME_ITERATOR_HPP
+#define BK_CONQ_CONSUME_ITERATOR_HPP
+
+#include <iterator>
+#include <cstddef>
+
+namespace bk_conq {
+namespace details {
+template <typename F>
+class consume_iterator {
+public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    class proxy {
+    public:
+        explicit proxy(F& f) : _f(f) {}
+
+        //the item is passed on as an lvalue, it is not moved from the slot that holds it
+        template <typename R>
+        proxy& operator=(R&& item) {
+            _f(item);
+            return *this;
+        }
+
+    private:
+        F& _f;
+    };
+
+    explicit consume_iterator(F& f) : _f(&f) {}
+
+    proxy operator*() {
+        return proxy(*_f);
+    }
+
+    //every position refers to the same callable
+    consume_iterator& operator++() {
+        return *this;
+    }
+
+private:
+    F* _f;
+};
+
+template <typename F>
+consume_iterator<F> make_consume_iterator(F& f) {
+    return consume_iterator<F>(f);
+}
+
+}//namespace details
+}//namespace bk_conq
+
+#endif // BK_CONQ_CONSUME_ITERATOR_HPP
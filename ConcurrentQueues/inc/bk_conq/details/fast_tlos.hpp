@@ -0,0 +1,208 @@
+/*
+* File:   fast_tlos.hpp
+* Author: Barath Kannan
+* Thread-local variables with object-scoped access, like tlos, with a lock-free lookup.
+* Each instance claims one of MAX_INSTANCES slots from a fixed registry when it is
+* constructed, and every thread holds a record of MAX_INSTANCES boxes, so get() is an
+* index into the calling thread's record. Records of exited threads are recycled by new
+* threads rather than freed. The default value and return functions are plain function
+* pointers that are given the owning object.
+* Created on 14 October 2026 11:40 PM
+*/
+
+#ifndef BK_CONQ_FAST_TLOS_HPP
+#define BK_CONQ_FAST_TLOS_HPP
+
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <bk_conq/details/bits.hpp>
+
+namespace bk_conq {
+namespace details {
+
+template <typename T, typename OWNER, size_t MAX_INSTANCES = 128>
+class fast_tlos {
+    static_assert(MAX_INSTANCES > 0, "MAX_INSTANCES must be greater than 0");
+
+public:
+    typedef T(*default_function)(OWNER&);
+    typedef void(*return_function)(OWNER&, T&&);
+
+    fast_tlos(OWNER& owner, default_function defaultvalfunc = nullptr, return_function returnfunc = nullptr) :
+        _owner(owner),
+        _defaultvalfunc(defaultvalfunc),
+        _returnfunc(returnfunc),
+        _myid(_id.fetch_add(1, std::memory_order_relaxed)),
+        _myindx(claim_slot())
+    {
+        _slots[_myindx].instance.store(this, std::memory_order_relaxed);
+        _slots[_myindx].id.store(_myid, std::memory_order_release);
+    }
+
+    fast_tlos(const fast_tlos&) = delete;
+    void operator=(const fast_tlos&) = delete;
+
+    //invokes the returner for every thread that still holds a value of this object
+    ~fast_tlos() {
+        for (record* r = _records.load(std::memory_order_acquire); r; r = r->next) {
+            box& b = r->boxes[_myindx];
+            for (;;) {
+                size_t owner_id = b.owner_id.load(std::memory_order_acquire);
+                if (owner_id == (_myid | returning)) {
+                    //the owning thread is exiting and is invoking the returner itself
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (owner_id != _myid) break;
+                //a failed exchange means the owning thread started exiting, so wait for it to release the box
+                if (!b.owner_id.compare_exchange_strong(owner_id, 0, std::memory_order_acq_rel)) continue;
+                if (_returnfunc) _returnfunc(_owner, std::move(b.value));
+                b.value = T();
+                break;
+            }
+        }
+        _slots[_myindx].id.store(0, std::memory_order_relaxed);
+        _slots[_myindx].instance.store(nullptr, std::memory_order_relaxed);
+        release_slot(_myindx);
+    }
+
+    //Returns a reference to the thread local variable corresponding to the fast_tlos object
+    T& get() {
+        box& b = local_record()->boxes[_myindx];
+        if (b.owner_id.load(std::memory_order_acquire) != _myid) {
+            b.value = _defaultvalfunc ? _defaultvalfunc(_owner) : T();
+            b.owner_id.store(_myid, std::memory_order_release);
+        }
+        return b.value;
+    }
+
+private:
+    //set on a box's owner id while the exiting thread invokes the returner
+    static constexpr size_t returning = ~(~size_t(0) >> 1);
+    static constexpr size_t words = (MAX_INSTANCES + 63) / 64;
+
+    struct box {
+        std::atomic<size_t> owner_id{ 0 };
+        T value{};
+    };
+
+    struct record {
+        box boxes[MAX_INSTANCES];
+        std::atomic<bool> in_use{ true };
+        record* next{ nullptr };
+    };
+
+    struct slot {
+        std::atomic<size_t> id{ 0 };
+        std::atomic<fast_tlos*> instance{ nullptr };
+    };
+
+    //releases the calling thread's record when the thread exits
+    class record_holder {
+    public:
+        record* get() {
+            if (!_record) _record = acquire_record();
+            return _record;
+        }
+
+        ~record_holder() {
+            if (!_record) return;
+            for (size_t i = 0; i < MAX_INSTANCES; ++i) {
+                box& b = _record->boxes[i];
+                size_t owner_id = b.owner_id.load(std::memory_order_acquire);
+                if (!owner_id) continue;
+                //only invoke the returner if the owning object is still alive, it waits for us while we hold the box
+                if (b.owner_id.compare_exchange_strong(owner_id, owner_id | returning, std::memory_order_acq_rel)) {
+                    if (_slots[i].id.load(std::memory_order_acquire) == owner_id) {
+                        fast_tlos* instance = _slots[i].instance.load(std::memory_order_relaxed);
+                        if (instance->_returnfunc) instance->_returnfunc(instance->_owner, std::move(b.value));
+                    }
+                    b.value = T();
+                    b.owner_id.store(0, std::memory_order_release);
+                }
+            }
+            _record->in_use.store(false, std::memory_order_release);
+        }
+
+    private:
+        record* _record{ nullptr };
+    };
+
+    static record* local_record() {
+        thread_local record_holder holder;
+        return holder.get();
+    }
+
+    //reuses the record of an exited thread, or publishes a new one
+    static record* acquire_record() {
+        for (record* r = _records.load(std::memory_order_acquire); r; r = r->next) {
+            bool in_use = false;
+            if (!r->in_use.load(std::memory_order_relaxed) && r->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire)) {
+                return r;
+            }
+        }
+        record* r = new record();
+        r->next = _records.load(std::memory_order_relaxed);
+        while (!_records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed));
+        return r;
+    }
+
+    static size_t claim_slot() {
+        for (size_t w = 0; w < words; ++w) {
+            uint64_t word = _used[w].load(std::memory_order_relaxed);
+            while (~word) {
+                size_t bit = lowest_set_bit(~word);
+                if (w * 64 + bit >= MAX_INSTANCES) break;
+                if (_used[w].compare_exchange_weak(word, word | (uint64_t(1) << bit), std::memory_order_acquire)) {
+                    return w * 64 + bit;
+                }
+            }
+        }
+        throw std::length_error("too many live fast_tlos instances");
+    }
+
+    static void release_slot(size_t index) {
+        _used[index / 64].fetch_and(~(uint64_t(1) << (index % 64)), std::memory_order_release);
+    }
+
+    OWNER& _owner;
+    const default_function _defaultvalfunc;
+    const return_function _returnfunc;
+
+    //uniquely identifies this object, so that a box left behind by a previous owner of the slot is not reused
+    const size_t _myid;
+
+    //identifies this object's box in each thread's record
+    const size_t _myindx;
+
+    //counter for assigning the objects unique id, starting at 1
+    static std::atomic<size_t> _id;
+
+    //bit n is set while slot n is claimed by an instance
+    static std::atomic<uint64_t> _used[words];
+
+    static slot _slots[MAX_INSTANCES];
+
+    //every thread record that has been created, records are never freed
+    static std::atomic<record*> _records;
+};
+
+template <typename T, typename OWNER, size_t MAX_INSTANCES>
+std::atomic<size_t> fast_tlos<T, OWNER, MAX_INSTANCES>::_id(1);
+
+template <typename T, typename OWNER, size_t MAX_INSTANCES>
+std::atomic<uint64_t> fast_tlos<T, OWNER, MAX_INSTANCES>::_used[fast_tlos<T, OWNER, MAX_INSTANCES>::words];
+
+template <typename T, typename OWNER, size_t MAX_INSTANCES>
+typename fast_tlos<T, OWNER, MAX_INSTANCES>::slot fast_tlos<T, OWNER, MAX_INSTANCES>::_slots[MAX_INSTANCES];
+
+template <typename T, typename OWNER, size_t MAX_INSTANCES>
+std::atomic<typename fast_tlos<T, OWNER, MAX_INSTANCES>::record*> fast_tlos<T, OWNER, MAX_INSTANCES>::_records(nullptr);
+
+}//namespace details
+}//namespace bk_conq
+
+#endif // BK_CONQ_FAST_TLOS_HPP
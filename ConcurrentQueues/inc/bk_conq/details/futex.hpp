@@ -0,0 +1,126 @@
+/*
+* File:   futex.hpp
+* Author: Barath Kannan
+* A 32 bit atomic word that threads can sleep on until its value changes.
+* Uses futex on Linux and WaitOnAddress on Windows, with a mutex and condition
+* variable fallback for other platforms.
+* Created on 14 October 2026 11:05 AM
+*/
+
+#ifndef BK_CONQ_FUTEX_HPP
+#define BK_CONQ_FUTEX_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <climits>
+#include <chrono>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "Synchronization.lib")
+#endif
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace bk_conq {
+namespace details {
+class futex {
+public:
+    futex() = default;
+    futex(const futex&) = delete;
+    void operator=(const futex&) = delete;
+
+    uint32_t load(std::memory_order order = std::memory_order_seq_cst) const {
+        return _word.load(order);
+    }
+
+    uint32_t fetch_add(uint32_t value, std::memory_order order = std::memory_order_seq_cst) {
+        return _word.fetch_add(value, order);
+    }
+
+    //blocks while the word holds expected, spurious wake ups are possible
+    void wait(uint32_t expected) {
+#if defined(__linux__)
+        syscall(SYS_futex, address(), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+        WaitOnAddress(address(), &expected, sizeof(expected), INFINITE);
+#else
+        std::unique_lock<std::mutex> lock(_m);
+        while (_word.load(std::memory_order_acquire) == expected) {
+            _cv.wait(lock);
+        }
+#endif
+    }
+
+    //as wait, but gives up once timeout has elapsed
+    void wait_for(uint32_t expected, std::chrono::nanoseconds timeout) {
+        if (timeout <= std::chrono::nanoseconds::zero()) return;
+#if defined(__linux__)
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(secs.count());
+        ts.tv_nsec = static_cast<long>((timeout - secs).count());
+        syscall(SYS_futex, address(), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+#elif defined(_WIN32)
+        //round up so that a short timeout does not become a busy loop
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeout + std::chrono::milliseconds(1) - std::chrono::nanoseconds(1));
+        DWORD wait_ms = ms.count() >= static_cast<long long>(INFINITE) ? INFINITE - 1 : static_cast<DWORD>(ms.count());
+        WaitOnAddress(address(), &expected, sizeof(expected), wait_ms);
+#else
+        std::unique_lock<std::mutex> lock(_m);
+        _cv.wait_for(lock, timeout, [&]() { return _word.load(std::memory_order_acquire) != expected; });
+#endif
+    }
+
+    void wake_one() {
+#if defined(__linux__)
+        syscall(SYS_futex, address(), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+        WakeByAddressSingle(address());
+#else
+        { std::lock_guard<std::mutex> lock(_m); }
+        _cv.notify_one();
+#endif
+    }
+
+    void wake_all() {
+#if defined(__linux__)
+        syscall(SYS_futex, address(), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+        WakeByAddressAll(address());
+#else
+        { std::lock_guard<std::mutex> lock(_m); }
+        _cv.notify_all();
+#endif
+    }
+
+private:
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "std::atomic<uint32_t> must be lock free and unpadded");
+
+#if defined(__linux__) || defined(_WIN32)
+    uint32_t* address() {
+        return reinterpret_cast<uint32_t*>(&_word);
+    }
+#else
+    std::mutex _m;
+    std::condition_variable _cv;
+#endif
+
+    std::atomic<uint32_t> _word{ 0 };
+};
+
+}//namespace details
+}//namespace bk_conq
+
+#endif // BK_CONQ_FUTEX_HPP
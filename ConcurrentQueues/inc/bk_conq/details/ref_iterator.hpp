@@ -0,0 +1,50 @@
+/*
+* File:   ref_iterator.hpp
+* Author: Barath Kannan
+* Output iterator that refers to another iterator, so that the position is
+* retained when it is passed by value to a bulk dequeue operation.
+* Created on 14 October 2026 9:12 AM
+*/
+
+#ifndef BK_CONQ_REF_ITERATOR_HPP
+#define BK_CONQ_REF_ITERATOR_HPP
+
+#include <iterator>
+#include <cstddef>
+
+namespace bk_conq {
+namespace details {
+template <typename IT>
+class ref_iterator {
+public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    explicit ref_iterator(IT& it) : _it(&it) {}
+
+    decltype(auto) operator*() {
+        return **_it;
+    }
+
+    //only pre-increment is provided, as a post-increment copy would alias the advanced position
+    ref_iterator& operator++() {
+        ++(*_it);
+        return *this;
+    }
+
+private:
+    IT* _it;
+};
+
+template <typename IT>
+ref_iterator<IT> make_ref_iterator(IT& it) {
+    return ref_iterator<IT>(it);
+}
+
+}//namespace details
+}//namespace bk_conq
+
+#endif // BK_CONQ_REF_ITERATOR_HPP
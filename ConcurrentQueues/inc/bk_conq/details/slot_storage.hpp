@@ -0,0 +1,172 @@
+/*
+* File:   slot_storage.hpp
+* Author: Barath Kannan
+* Fixed size slot storage for the ring buffer queues. Each slot holds an item
+* and an atomic sequence number, laid out according to a slot_layout, in
+* storage obtained from an allocator. Items are uninitialized storage, the queues
+* construct them on enqueue and destroy them on dequeue.
+* Created on 14 October 2026 4:10 PM
+*/
+
+#ifndef BK_CONQ_SLOT_STORAGE_HPP
+#define BK_CONQ_SLOT_STORAGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <bk_conq/details/uninitialized.hpp>
+
+namespace bk_conq {
+
+//packed: item and sequence number are adjacent, several slots share a cache line
+//padded: every slot is aligned to and padded out to a cache line
+//split: sequence numbers and items are stored in separate arrays
+enum class slot_layout {
+    packed,
+    padded,
+    split
+};
+
+namespace details {
+
+//std::hardware_destructive_interference_size is not available before C++17 and its value is not ABI stable
+static constexpr size_t cache_line_size = 64;
+
+//array of default constructed elements, aligned to at least a cache line
+//the raw storage is obtained from ALLOCATOR rebound to char
+template <typename E, typename ALLOCATOR = std::allocator<E>>
+class aligned_array {
+    typedef typename std::allocator_traits<ALLOCATOR>::template rebind_alloc<char> byte_allocator_t;
+    typedef std::allocator_traits<byte_allocator_t> byte_traits_t;
+
+public:
+    static constexpr size_t alignment = alignof(E) > cache_line_size ? alignof(E) : cache_line_size;
+
+    explicit aligned_array(size_t n, const ALLOCATOR& allocator = ALLOCATOR()) :
+        _allocator(allocator),
+        _size(n),
+        _space(n * sizeof(E) + alignment)
+    {
+        _raw = byte_traits_t::allocate(_allocator, _space);
+        void* aligned = _raw;
+        size_t space = _space;
+        _data = static_cast<E*>(std::align(alignment, n * sizeof(E), aligned, space));
+        size_t constructed = 0;
+        try {
+            for (; constructed < n; ++constructed) {
+                new (&_data[constructed]) E();
+            }
+        }
+        catch (...) {
+            destroy(constructed);
+            throw;
+        }
+    }
+
+    ~aligned_array() {
+        destroy(_size);
+    }
+
+    aligned_array(const aligned_array&) = delete;
+    void operator=(const aligned_array&) = delete;
+
+    E& operator[](size_t i) {
+        return _data[i];
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+private:
+    void destroy(size_t constructed) {
+        for (size_t i = 0; i < constructed; ++i) {
+            _data[i].~E();
+        }
+        byte_traits_t::deallocate(_allocator, _raw, _space);
+    }
+
+    byte_allocator_t _allocator;
+    char* _raw;
+    E* _data;
+    size_t _size;
+    size_t _space;
+};
+
+template <typename T, slot_layout LAYOUT, typename ALLOCATOR = std::allocator<T>>
+class slot_storage;
+
+template <typename T, typename ALLOCATOR>
+class slot_storage<T, slot_layout::packed, ALLOCATOR> {
+    struct node_t {
+        uninitialized<T>      data;
+        std::atomic<size_t>   seq;
+    };
+
+public:
+    //distance in bytes between the sequence numbers of adjacent slots
+    static constexpr size_t seq_stride = sizeof(node_t);
+
+    slot_storage(size_t n, const ALLOCATOR& allocator) : _nodes(n, allocator) {}
+
+    std::atomic<size_t>& seq(size_t i) {
+        return _nodes[i].seq;
+    }
+
+    uninitialized<T>& data(size_t i) {
+        return _nodes[i].data;
+    }
+
+private:
+    aligned_array<node_t, ALLOCATOR> _nodes;
+};
+
+template <typename T, typename ALLOCATOR>
+class slot_storage<T, slot_layout::padded, ALLOCATOR> {
+    struct alignas(cache_line_size) node_t {
+        uninitialized<T>      data;
+        std::atomic<size_t>   seq;
+    };
+
+public:
+    static constexpr size_t seq_stride = sizeof(node_t);
+
+    slot_storage(size_t n, const ALLOCATOR& allocator) : _nodes(n, allocator) {}
+
+    std::atomic<size_t>& seq(size_t i) {
+        return _nodes[i].seq;
+    }
+
+    uninitialized<T>& data(size_t i) {
+        return _nodes[i].data;
+    }
+
+private:
+    aligned_array<node_t, ALLOCATOR> _nodes;
+};
+
+template <typename T, typename ALLOCATOR>
+class slot_storage<T, slot_layout::split, ALLOCATOR> {
+public:
+    static constexpr size_t seq_stride = sizeof(std::atomic<size_t>);
+
+    slot_storage(size_t n, const ALLOCATOR& allocator) : _seqs(n, allocator), _data(n, allocator) {}
+
+    std::atomic<size_t>& seq(size_t i) {
+        return _seqs[i];
+    }
+
+    uninitialized<T>& data(size_t i) {
+        return _data[i];
+    }
+
+private:
+    aligned_array<std::atomic<size_t>, ALLOCATOR> _seqs;
+    aligned_array<uninitialized<T>, ALLOCATOR> _data;
+};
+
+}//namespace details
+}//namespace bk_conq
+
+#endif // BK_CONQ_SLOT_STORAGE_HPP
@@ -13,6 +13,7 @@
 #include <set>
 #include <atomic>
 #include <thread>
+#include <functional>
 
 namespace bk_conq {
 namespace details {
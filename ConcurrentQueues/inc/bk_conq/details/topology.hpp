@@ -0,0 +1,145 @@
+/*
+* File:   topology.hpp
+* Author: Barath Kannan
+* Discovery of the processor topology, mapping each cpu to the NUMA node or
+* L3 cache domain that it belongs to. The topology is read from sysfs on Linux,
+* other platforms report a single domain.
+* Created on 14 October 2026 9:30 PM
+*/
+
+#ifndef BK_CONQ_TOPOLOGY_HPP
+#define BK_CONQ_TOPOLOGY_HPP
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__linux__)
+#include <sched.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace bk_conq {
+
+enum class topology_level {
+    numa_node,
+    l3_cache
+};
+
+namespace details {
+
+//parses a sysfs cpu list such as "0-3,8-11"
+inline std::vector<size_t> parse_cpu_list(const std::string& list) {
+    std::vector<size_t> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range[0] < '0' || range[0] > '9') continue;
+        size_t dash = range.find('-');
+        size_t first = std::stoul(range.substr(0, dash));
+        size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+        for (size_t cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+inline bool read_line(const std::string& path, std::string& line) {
+    std::ifstream file(path);
+    return static_cast<bool>(std::getline(file, line));
+}
+
+class cpu_topology {
+public:
+    //the topology is read once per level and shared by all queues
+    static const cpu_topology& get(topology_level level) {
+        static const cpu_topology numa(topology_level::numa_node);
+        static const cpu_topology l3(topology_level::l3_cache);
+        return level == topology_level::numa_node ? numa : l3;
+    }
+
+    size_t domains() const {
+        return _domains;
+    }
+
+    //domain of the given cpu, cpus that were not discovered belong to domain 0
+    size_t domain_of(size_t cpu) const {
+        return cpu < _cpu_domain.size() ? _cpu_domain[cpu] : 0;
+    }
+
+    static size_t current_cpu() {
+#if defined(__linux__)
+        int cpu = sched_getcpu();
+        return cpu < 0 ? 0 : static_cast<size_t>(cpu);
+#elif defined(_WIN32)
+        return static_cast<size_t>(GetCurrentProcessorNumber());
+#else
+        return 0;
+#endif
+    }
+
+    size_t current_domain() const {
+        return domain_of(current_cpu());
+    }
+
+private:
+    explicit cpu_topology(topology_level level) {
+        size_t cpus = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        _cpu_domain.assign(cpus, 0);
+#if defined(__linux__)
+        if (level == topology_level::numa_node) read_numa_nodes();
+        else read_l3_domains();
+#else
+        (void)level;
+#endif
+    }
+
+    void assign(size_t cpu, size_t domain) {
+        if (cpu >= _cpu_domain.size()) _cpu_domain.resize(cpu + 1, 0);
+        _cpu_domain[cpu] = domain;
+        _domains = std::max(_domains, domain + 1);
+    }
+
+#if defined(__linux__)
+    //node ids can be sparse, so they are renumbered densely in the order they are found
+    void read_numa_nodes() {
+        std::string line;
+        size_t domain = 0;
+        for (size_t node = 0; node < 1024; ++node) {
+            if (!read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", line)) continue;
+            std::vector<size_t> cpus = parse_cpu_list(line);
+            if (cpus.empty()) continue;
+            for (size_t cpu : cpus) assign(cpu, domain);
+            ++domain;
+        }
+    }
+
+    //cpus that share an L3 list form a domain, numbered in order of their lowest cpu
+    void read_l3_domains() {
+        std::vector<std::string> seen;
+        std::string line;
+        for (size_t cpu = 0; cpu < _cpu_domain.size(); ++cpu) {
+            if (!read_line("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache/index3/shared_cpu_list", line)) continue;
+            auto it = std::find(seen.begin(), seen.end(), line);
+            size_t domain = static_cast<size_t>(it - seen.begin());
+            if (it == seen.end()) seen.push_back(line);
+            assign(cpu, domain);
+        }
+    }
+#endif
+
+    std::vector<size_t> _cpu_domain;
+    size_t _domains{ 1 };
+};
+
+}//namespace details
+}//namespace bk_conq
+
+#endif // BK_CONQ_TOPOLOGY_HPP
@@ -0,0 +1,54 @@
+/*
+* File:   uninitialized.hpp
+* Author: Barath Kannan
+* Storage for a single item that is only constructed while a slot or node holds it.
+* The owner tracks whether the item is live, so T need not be default constructible.
+* Created on 14 October 2026 11:59 PM
+*/
+
+#ifndef BK_CONQ_UNINITIALIZED_HPP
+#define BK_CONQ_UNINITIALIZED_HPP
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace bk_conq {
+namespace details {
+
+template <typename T>
+class uninitialized {
+public:
+    uninitialized() {}
+
+    uninitialized(const uninitialized&) = delete;
+    void operator=(const uninitialized&) = delete;
+
+    template <typename... Args>
+    void construct(Args&&... args) {
+        new (&_storage) T(std::forward<Args>(args)...);
+    }
+
+    void destroy() {
+        get().~T();
+    }
+
+    //moves the item into output and ends its lifetime
+    template <typename R>
+    void move_to(R&& output) {
+        output = std::move(get());
+        destroy();
+    }
+
+    T& get() {
+        return *reinterpret_cast<T*>(&_storage);
+    }
+
+private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage;
+};
+
+}//namespace details
+}//namespace bk_conq
+
+#endif // BK_CONQ_UNINITIALIZED_HPP
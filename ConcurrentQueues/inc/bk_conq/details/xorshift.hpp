@@ -0,0 +1,43 @@
+/*
+* File:   xorshift.hpp
+* Author: Barath Kannan
+* Small xorshift generator for randomised subqueue selection, seeded per thread.
+* Created on 14 October 2026 11:59 PM
+*/
+
+#ifndef BK_CONQ_XORSHIFT_HPP
+#define BK_CONQ_XORSHIFT_HPP
+
+#include <thread>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+namespace bk_conq {
+namespace details {
+
+class xorshift {
+public:
+    //the state must never be 0
+    explicit xorshift(uint64_t seed = 1) : _state(seed | 1) {}
+
+    size_t next() {
+        _state ^= _state << 13;
+        _state ^= _state >> 7;
+        _state ^= _state << 17;
+        return static_cast<size_t>(_state);
+    }
+
+    //a seed that differs between threads
+    static uint64_t thread_seed() {
+        return std::hash<std::thread::id>()(std::this_thread::get_id());
+    }
+
+private:
+    uint64_t _state;
+};
+
+}//namespace details
+}//namespace bk_conq
+
+#endif // BK_CONQ_XORSHIFT_HPP
@@ -7,6 +7,16 @@
  * as a linked list, where nodes are stored in a freelist after being dequeued.
  * Enqueue operations will either acquire items from the freelist or allocate a
  * new node if none are available.
+ * Nodes are allocated in chunks of chunk_size. Chunks whose nodes are all in the
+ * freelist can be released with shrink(). When a reclaim threshold is given,
+ * the queue does this automatically once more than that many nodes are free: a
+ * dequeue then takes the reclaim_threshold / 2 nodes that have been free the
+ * longest off the freelist and releases the chunks they complete, so the work
+ * per pass is bounded and producers are left half the threshold to draw from.
+ * Contended dequeues wait between retries using WAIT_STRATEGY.
+ * Items are constructed in their node on enqueue and destroyed on dequeue, so T
+ * need not be default constructible or copyable.
+ * STATS selects whether operations are counted (see stats_policy.hpp).
  * Created on 27 August 2016, 11:30 PM
  */
 
@@ -19,15 +29,30 @@
 #include <array>
 #include <memory>
 #include <iostream>
+#include <mutex>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <limits>
 #include <bk_conq/unbounded_queue.hpp>
+#include <bk_conq/wait_strategy.hpp>
+#include <bk_conq/stats_policy.hpp>
+#include <bk_conq/details/uninitialized.hpp>
 
 namespace bk_conq {
 
-template<typename T>
-class list_queue : public unbounded_queue<T, list_queue<T>> {
-    friend unbounded_queue<T, list_queue<T>>;
+template<typename T, typename WAIT_STRATEGY = yield_strategy, typename STATS = no_stats, producers P = producers::multi, consumers C = consumers::multi>
+class list_queue : public unbounded_queue<T, list_queue<T, WAIT_STRATEGY, STATS, P, C>, P, C>, private STATS {
+    friend unbounded_queue<T, list_queue<T, WAIT_STRATEGY, STATS, P, C>, P, C>;
 public:
-    list_queue() {
+    //a reclaim_threshold of 0 disables automatic reclamation
+    list_queue(size_t chunk_size = 32, size_t reclaim_threshold = 0) :
+        _chunk_size(chunk_size),
+        _reclaim_threshold(reclaim_threshold)
+    {
+        if (chunk_size < 2) {
+            throw std::length_error("chunk size of list_queue must be at least 2");
+        }
         std::vector<list_node_t> vec(2);
         _head.store(&vec[0]);
         _tail.store(_head.load(std::memory_order_relaxed), std::memory_order_relaxed);
@@ -37,9 +62,14 @@ public:
         storage_node_t *store = new storage_node_t(std::move(vec));
         storage_node_t* prev_head = _storage_head.exchange(store, std::memory_order_acq_rel);
         prev_head->next.store(store, std::memory_order_release);
+        _allocated_nodes.store(2, std::memory_order_relaxed);
     }
 
+    //items still in the queue are destroyed, no operations may be in progress
     virtual ~list_queue() {
+        for (list_node_t* node = _tail.load(std::memory_order_relaxed)->next.load(std::memory_order_relaxed); node; node = node->next.load(std::memory_order_relaxed)) {
+            node->data.destroy();
+        }
         storage_node_t* tail = _storage_tail.load(std::memory_order_relaxed);
         storage_node_t* next = tail->next.load(std::memory_order_relaxed);
         for (storage_node_t* next = tail->next.load(std::memory_order_relaxed); next != nullptr; ) {
@@ -47,77 +77,196 @@ public:
             next = next->next.load(std::memory_order_relaxed);
             delete tail;
         }
+        delete _storage_tail.load(std::memory_order_relaxed);
     }
 
     list_queue(const list_queue&) = delete;
     void operator=(const list_queue&) = delete;
 
+    //Releases storage chunks whose nodes are all free, while retaining at least keep_nodes free nodes.
+    //This is safe to call while other threads enqueue and dequeue: the free nodes are taken off the freelist
+    //first, so they are exclusively owned by the caller when their chunk is released. Producers that find the
+    //freelist empty in the meantime will allocate. Returns the number of nodes released.
+    size_t shrink(size_t keep_nodes = 0) {
+        std::lock_guard<std::mutex> lock(_storage_mutex);
+        return shrink_locked(keep_nodes, std::numeric_limits<size_t>::max());
+    }
+
+    //the number of nodes in the storage chunks, whether they hold items or are free
+    size_t allocated_nodes() const {
+        return _allocated_nodes.load(std::memory_order_relaxed);
+    }
+
+    queue_stats stats() const {
+        return STATS::collect();
+    }
+
 protected:
     template <typename R>
     void sp_enqueue_impl(R&& input) {
-        list_node_t *node = acquire_or_allocate(std::forward<R>(input));
-        _head.load(std::memory_order_relaxed)->next.store(node, std::memory_order_release);
-        _head.store(node, std::memory_order_relaxed);
+        sp_emplace_impl(std::forward<R>(input));
     }
 
     template <typename R>
     void mp_enqueue_impl(R&& input) {
-        list_node_t *node = acquire_or_allocate(std::forward<R>(input));
+        mp_emplace_impl(std::forward<R>(input));
+    }
+
+    template <typename... Args>
+    void sp_emplace_impl(Args&&... args) {
+        list_node_t *node = acquire_or_allocate(std::forward<Args>(args)...);
+        _head.load(std::memory_order_relaxed)->next.store(node, std::memory_order_release);
+        _head.store(node, std::memory_order_relaxed);
+        STATS::add(queue_stat::enqueues);
+    }
+
+    template <typename... Args>
+    void mp_emplace_impl(Args&&... args) {
+        list_node_t *node = acquire_or_allocate(std::forward<Args>(args)...);
         list_node_t* prev_head = _head.exchange(node, std::memory_order_acq_rel);
         prev_head->next.store(node, std::memory_order_release);
+        STATS::add(queue_stat::enqueues);
+    }
+
+    //the range is linked into a private chain first so that it is published with a single exchange
+    template <typename IT>
+    void sp_enqueue_bulk_impl(IT first, IT last) {
+        if (first == last) return;
+        list_node_t *chain_tail;
+        size_t count;
+        list_node_t *chain_head = acquire_chain(first, last, chain_tail, count);
+        _head.load(std::memory_order_relaxed)->next.store(chain_head, std::memory_order_release);
+        _head.store(chain_tail, std::memory_order_relaxed);
+        STATS::add(queue_stat::enqueues, count);
+    }
+
+    template <typename IT>
+    void mp_enqueue_bulk_impl(IT first, IT last) {
+        if (first == last) return;
+        list_node_t *chain_tail;
+        size_t count;
+        list_node_t *chain_head = acquire_chain(first, last, chain_tail, count);
+        list_node_t* prev_head = _head.exchange(chain_tail, std::memory_order_acq_rel);
+        prev_head->next.store(chain_head, std::memory_order_release);
+        STATS::add(queue_stat::enqueues, count);
     }
 
     bool sc_dequeue_impl(T& output) {
         list_node_t* tail = _tail.load(std::memory_order_relaxed);
         list_node_t* next = tail->next.load(std::memory_order_acquire);
-        if (!next) return false;
-        output = std::move(next->data);
+        if (!next) {
+            STATS::add(queue_stat::empty_failures);
+            return false;
+        }
+        next->data.move_to(output);
+        exclusive_add(_dequeued, 1);
         _tail.store(next, std::memory_order_release);
         freelist_enqueue(tail);
+        try_reclaim();
+        STATS::add(queue_stat::dequeues);
         return true;
     }
 
     //spin on dequeue contention
     bool mc_dequeue_impl(T& output) {
         list_node_t *tail;
+        WAIT_STRATEGY strategy;
         for (tail = _tail.exchange(nullptr, std::memory_order_acq_rel); !tail; tail = _tail.exchange(nullptr, std::memory_order_acq_rel)) {
-            std::this_thread::yield();
+            STATS::add(queue_stat::contention_spins);
+            strategy.wait();
         }
         list_node_t *next = tail->next.load(std::memory_order_acquire);
         if (!next) {
             _tail.exchange(tail, std::memory_order_acq_rel);
+            STATS::add(queue_stat::empty_failures);
             return false;
         }
-        output = std::move(next->data);
+        next->data.move_to(output);
+        exclusive_add(_dequeued, 1);
         _tail.store(next, std::memory_order_release);
         freelist_enqueue(tail);
+        try_reclaim();
+        STATS::add(queue_stat::dequeues);
         return true;
     }
 
     //return false on dequeue contention
     bool mc_dequeue_uncontended_impl(T& output) {
         list_node_t *tail = _tail.exchange(nullptr, std::memory_order_acq_rel);
-        if (!tail) return false;
+        if (!tail) {
+            STATS::add(queue_stat::contention_spins);
+            return false;
+        }
         list_node_t *next = tail->next.load(std::memory_order_acquire);
         if (!next) {
             _tail.exchange(tail, std::memory_order_acq_rel);
+            STATS::add(queue_stat::empty_failures);
             return false;
         }
-        output = std::move(next->data);
+        next->data.move_to(output);
+        exclusive_add(_dequeued, 1);
         _tail.store(next, std::memory_order_release);
         freelist_enqueue(tail);
+        try_reclaim();
+        STATS::add(queue_stat::dequeues);
         return true;
     }
 
+    template <typename IT>
+    size_t sc_dequeue_bulk_impl(IT output, size_t max) {
+        list_node_t* tail = _tail.load(std::memory_order_relaxed);
+        list_node_t* released_head = tail;
+        list_node_t* released_tail;
+        size_t count = take_run(tail, released_tail, output, max);
+        if (!count) {
+            STATS::add(queue_stat::empty_failures);
+            return 0;
+        }
+        exclusive_add(_dequeued, count);
+        _tail.store(tail, std::memory_order_release);
+        freelist_enqueue_chain(released_head, released_tail, count);
+        try_reclaim();
+        STATS::add(queue_stat::dequeues, count);
+        return count;
+    }
+
+    //spin on dequeue contention
+    template <typename IT>
+    size_t mc_dequeue_bulk_impl(IT output, size_t max) {
+        list_node_t *tail;
+        WAIT_STRATEGY strategy;
+        for (tail = _tail.exchange(nullptr, std::memory_order_acq_rel); !tail; tail = _tail.exchange(nullptr, std::memory_order_acq_rel)) {
+            STATS::add(queue_stat::contention_spins);
+            strategy.wait();
+        }
+        list_node_t* released_head = tail;
+        list_node_t* released_tail;
+        size_t count = take_run(tail, released_tail, output, max);
+        exclusive_add(_dequeued, count);
+        _tail.store(tail, std::memory_order_release);
+        if (!count) {
+            STATS::add(queue_stat::empty_failures);
+            return 0;
+        }
+        freelist_enqueue_chain(released_head, released_tail, count);
+        try_reclaim();
+        STATS::add(queue_stat::dequeues, count);
+        return count;
+    }
+
+    //every enqueue takes one node, so enqueues are counted as nodes are taken, shortly before their items are linked
+    size_t size_approx_impl() const {
+        size_t dequeued = _dequeued.load(std::memory_order_relaxed);
+        size_t enqueued = _acquired.load(std::memory_order_relaxed) + _allocated.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
 private:
 
+    //data is live from enqueue until the node is passed by a dequeue
     struct list_node_t {
-        T data;
+        details::uninitialized<T> data;
         std::atomic<list_node_t*> next{ nullptr };
-
-        template<typename R>
-        list_node_t(R&& input) : data(std::forward<R>(input)) {}
-        list_node_t() {}
     };
 
     struct storage_node_t {
@@ -129,33 +278,56 @@ private:
         storage_node_t() {}
     };
 
+    //for counters that are only written by the holder of the tail or the freelist tail
+    static void exclusive_add(std::atomic<size_t>& counter, size_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
     void freelist_enqueue(list_node_t *item) {
+        if (_reclaim_threshold) _free_nodes.fetch_add(1, std::memory_order_relaxed);
         item->next.store(nullptr, std::memory_order_relaxed);
         list_node_t * free_list_prev_head = _free_list_head.exchange(item, std::memory_order_acq_rel);
         free_list_prev_head->next.store(item, std::memory_order_release);
     }
 
-    list_node_t* freelist_try_dequeue() {
+    //the released nodes are still linked in dequeue order, so they go back on the freelist as one chain
+    void freelist_enqueue_chain(list_node_t *first, list_node_t *last, size_t count) {
+        if (_reclaim_threshold) _free_nodes.fetch_add(count, std::memory_order_relaxed);
+        last->next.store(nullptr, std::memory_order_relaxed);
+        list_node_t * free_list_prev_head = _free_list_head.exchange(last, std::memory_order_acq_rel);
+        free_list_prev_head->next.store(first, std::memory_order_release);
+    }
+
+    //nodes taken for an enqueue are counted while the freelist tail is held, shrink_locked takes nodes without counting them
+    list_node_t* freelist_try_dequeue(bool enqueue = true) {
         list_node_t *item;
+        WAIT_STRATEGY strategy;
         for (item = _free_list_tail.exchange(nullptr, std::memory_order_acq_rel); !item; item = _free_list_tail.exchange(nullptr, std::memory_order_acq_rel)) {
-            std::this_thread::yield();
+            STATS::add(queue_stat::contention_spins);
+            strategy.wait();
         }
         list_node_t* next = item->next.load(std::memory_order_acquire);
         if (!next) {
             _free_list_tail.store(item, std::memory_order_release);
             return nullptr;
         }
+        if (enqueue) exclusive_add(_acquired, 1);
         _free_list_tail.store(next, std::memory_order_release);
+        if (_reclaim_threshold) _free_nodes.fetch_sub(1, std::memory_order_relaxed);
         return item;
     }
 
-    template<typename R>
-    list_node_t *acquire_or_allocate(R&& input) {
+    template<typename... Args>
+    list_node_t *acquire_or_allocate(Args&&... args) {
         //attempt to recycle previously used storage
         list_node_t* node = freelist_try_dequeue();
-        if (!node) {
-            //pre-allocate for 32 nodes
-            static const size_t allocsize = 32;
+        if (node) {
+            STATS::add(queue_stat::freelist_hits);
+        }
+        else {
+            STATS::add(queue_stat::allocations);
+            //pre-allocate a chunk of nodes
+            const size_t allocsize = _chunk_size;
             std::vector<list_node_t> vec(allocsize);
 
             //store the sequencing chain here before it goes on the freelist
@@ -164,29 +336,125 @@ private:
             }
 
             //connect the chains
+            if (_reclaim_threshold) _free_nodes.fetch_add(allocsize - 1, std::memory_order_relaxed);
             list_node_t* free_list_prev_head = _free_list_head.exchange(&vec[1], std::memory_order_acq_rel);
             free_list_prev_head->next.store(&vec[allocsize - 1], std::memory_order_release);
 
             //the first one is reserved for this acquire_or_allocate call
             node = &vec[0];
+            _allocated.fetch_add(1, std::memory_order_relaxed);
 
             //store the node on the storage queue for retrieval later
             storage_node_t *store = new storage_node_t(std::move(vec));
             storage_node_t* prev_head = _storage_head.exchange(store, std::memory_order_acq_rel);
             prev_head->next.store(store, std::memory_order_release);
-
+            _allocated_nodes.fetch_add(allocsize, std::memory_order_relaxed);
         }
-        node->data = std::forward<R>(input);
+        node->data.construct(std::forward<Args>(args)...);
+        node->next.store(nullptr, std::memory_order_relaxed);
         return node;
     }
 
+    template <typename IT>
+    list_node_t *acquire_chain(IT first, IT last, list_node_t*& chain_tail, size_t& count) {
+        list_node_t *chain_head = acquire_or_allocate(*first);
+        chain_tail = chain_head;
+        count = 1;
+        for (++first; first != last; ++first, ++count) {
+            list_node_t *node = acquire_or_allocate(*first);
+            chain_tail->next.store(node, std::memory_order_relaxed);
+            chain_tail = node;
+        }
+        return chain_head;
+    }
+
+    //moves up to max items out from behind tail, leaving tail at the new sentinel and released_tail at the last node passed over
+    template <typename IT>
+    size_t take_run(list_node_t*& tail, list_node_t*& released_tail, IT output, size_t max) {
+        size_t count = 0;
+        for (list_node_t *next; count < max && (next = tail->next.load(std::memory_order_acquire)) != nullptr; ++count, ++output) {
+            next->data.move_to(*output);
+            released_tail = tail;
+            tail = next;
+        }
+        return count;
+    }
+
+    //only one thread reclaims at a time, if reclaiming automatically the other threads skip it. a pass takes at most
+    //half the threshold from the freelist, so the nodes freed most recently stay available to producers
+    void try_reclaim() {
+        if (!_reclaim_threshold || _free_nodes.load(std::memory_order_relaxed) <= _reclaim_at.load(std::memory_order_relaxed)) return;
+        std::unique_lock<std::mutex> lock(_storage_mutex, std::try_to_lock);
+        if (lock.owns_lock()) shrink_locked(0, _reclaim_threshold / 2);
+    }
+
+    //takes up to max_take nodes from the freelist, oldest first, and releases the chunks whose nodes were all taken
+    size_t shrink_locked(size_t keep_nodes, size_t max_take) {
+        //the last free node stays behind as the freelist sentinel
+        std::vector<list_node_t*> free_nodes;
+        while (free_nodes.size() < max_take) {
+            list_node_t* node = freelist_try_dequeue(false);
+            if (!node) break;
+            free_nodes.push_back(node);
+        }
+        //free_nodes stays sorted for the lookups, the nodes of released chunks are marked instead of removed
+        std::vector<bool> released_mask(free_nodes.size(), false);
+        size_t released = 0;
+        if (free_nodes.size() > keep_nodes) {
+            std::sort(free_nodes.begin(), free_nodes.end(), std::less<list_node_t*>());
+            //the newest chunk may still have its next pointer written by an allocating producer, so it is never released
+            storage_node_t* prev = _storage_tail.load(std::memory_order_relaxed);
+            for (storage_node_t* store = prev->next.load(std::memory_order_acquire); store; store = prev->next.load(std::memory_order_acquire)) {
+                storage_node_t* next = store->next.load(std::memory_order_acquire);
+                if (!next) break;
+                auto first = std::lower_bound(free_nodes.begin(), free_nodes.end(), store->nodes.data(), std::less<list_node_t*>());
+                auto last = std::lower_bound(first, free_nodes.end(), store->nodes.data() + store->nodes.size(), std::less<list_node_t*>());
+                if (static_cast<size_t>(last - first) == store->nodes.size() && free_nodes.size() - released - store->nodes.size() >= keep_nodes) {
+                    std::fill(released_mask.begin() + (first - free_nodes.begin()), released_mask.begin() + (last - free_nodes.begin()), true);
+                    released += store->nodes.size();
+                    prev->next.store(next, std::memory_order_release);
+                    delete store;
+                }
+                else {
+                    prev = store;
+                }
+            }
+        }
+        //hand the remaining nodes back as a single chain
+        list_node_t* first = nullptr;
+        list_node_t* last = nullptr;
+        for (size_t i = 0; i < free_nodes.size(); ++i) {
+            if (released_mask[i]) continue;
+            if (!first) first = free_nodes[i];
+            else last->next.store(free_nodes[i], std::memory_order_relaxed);
+            last = free_nodes[i];
+        }
+        if (first) freelist_enqueue_chain(first, last, free_nodes.size() - released);
+        _allocated_nodes.fetch_sub(released, std::memory_order_relaxed);
+        //nodes of partly used chunks cannot be released, so the next attempt waits for more to be freed
+        _reclaim_at.store(std::max(_reclaim_threshold, _free_nodes.load(std::memory_order_relaxed) + _reclaim_threshold / 2), std::memory_order_relaxed);
+        return released;
+    }
+
+    const size_t _chunk_size;
+    const size_t _reclaim_threshold;
     std::atomic<list_node_t*> _head;
+    //the item counters share a cache line with the end of the list whose holder updates them
+    std::atomic<size_t> _acquired{ 0 };
     std::atomic<list_node_t*> _free_list_tail;
     char _padding[64];
     std::atomic<list_node_t*> _tail;
+    std::atomic<size_t> _dequeued{ 0 };
     std::atomic<list_node_t*> _free_list_head;
     std::atomic<storage_node_t*> _storage_head{ new storage_node_t };
     std::atomic<storage_node_t*> _storage_tail{ _storage_head.load(std::memory_order_relaxed) };
+    std::atomic<size_t> _free_nodes{ 0 };
+    //free node count above which the next automatic reclaim is attempted
+    std::atomic<size_t> _reclaim_at{ _reclaim_threshold };
+    //nodes reserved for an enqueue straight from a new chunk, rather than taken from the freelist
+    std::atomic<size_t> _allocated{ 0 };
+    std::atomic<size_t> _allocated_nodes{ 0 };
+    std::mutex _storage_mutex;
 
 };
 }//namespace bk_conq
@@ -2,6 +2,10 @@
  * File:   multi_bounded_queue.hpp
  * Author: Barath Kannan
  * Vector of bounded list queues.
+ * ASSIGNMENT decides which subqueue each producer uses and the initial order of each
+ * consumer's hit list (see assignment_policy.hpp).
+ * DEQUEUE decides how consumers search the subqueues (see dequeue_policy.hpp).
+ * STATS selects whether the consumers' hit list reorders are counted (see stats_policy.hpp).
  * Created on 28 January 2017, 09:42 AM
  */
 
@@ -13,22 +17,75 @@
 #include <mutex>
 #include <memory>
 #include <numeric>
+#include <bk_conq/assignment_policy.hpp>
+#include <bk_conq/dequeue_policy.hpp>
+#include <bk_conq/stats_policy.hpp>
 #include <bk_conq/bounded_queue.hpp>
-#include <bk_conq/details/tlos.hpp>
+#include <bk_conq/details/fast_tlos.hpp>
 
 namespace bk_conq {
-template<typename TT>
-class multi_bounded_queue;
+template <typename Q, typename T = typename Q::value_type, typename ASSIGNMENT = round_robin_assignment, typename DEQUEUE = hitlist_dequeue, typename STATS = no_stats, producers P = producers::multi, consumers C = consumers::multi>
+class multi_bounded_queue : public bounded_queue<T, multi_bounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>, private STATS {
+    friend bounded_queue<T, multi_bounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>;
+    typedef typename DEQUEUE::template consumer<T, STATS> consumer_t;
 
-template <template <typename> class Q, typename T>
-class multi_bounded_queue<Q<T>> : public bounded_queue<T, multi_bounded_queue<Q<T>>> {
-    friend bounded_queue<T, multi_bounded_queue<Q<T>>>;
 public:
+    //binds the creating thread to a subqueue until the token is destroyed, bypassing the thread local lookup
+    //the subqueue is chosen by ASSIGNMENT as for a producer thread's first enqueue
+    class producer_token {
+    public:
+        producer_token(producer_token&& other) : _owner(other._owner), _subqueue(other._subqueue), _index(other._index) {
+            other._owner = nullptr;
+        }
+
+        producer_token(const producer_token&) = delete;
+        void operator=(const producer_token&) = delete;
+
+        ~producer_token() {
+            if (_owner) _owner->_assignment.release(_index);
+        }
+
+    private:
+        friend multi_bounded_queue;
+
+        producer_token(multi_bounded_queue& owner, size_t index) : _owner(&owner), _subqueue(owner._q[index].get()), _index(index) {}
+
+        multi_bounded_queue* _owner;
+        Q* _subqueue;
+        size_t _index;
+    };
+
+    //holds the consumer state that is otherwise thread local, anything it holds is handed back when it is destroyed
+    class consumer_token {
+    public:
+        consumer_token(consumer_token&& other) : _owner(other._owner), _consumer(std::move(other._consumer)) {
+            other._owner = nullptr;
+        }
+
+        consumer_token(const consumer_token&) = delete;
+        void operator=(const consumer_token&) = delete;
+
+        ~consumer_token() {
+            if (_owner) _consumer.flush(_owner->subqueue());
+        }
+
+    private:
+        friend multi_bounded_queue;
+
+        explicit consumer_token(multi_bounded_queue& owner) : _owner(&owner), _consumer(owner._assignment, owner.stats_sink()) {}
+
+        multi_bounded_queue* _owner;
+        consumer_t _consumer;
+    };
+
     multi_bounded_queue(size_t N, size_t subqueues) :
-        _hitlist([&]() {return hitlist_sequence(); }),
-        _enqueue_identifier([&]() { return get_enqueue_index(); }, [&](size_t indx) {return return_enqueue_index(indx); })
+        _assignment(subqueues),
+        _consumer(*this, [](multi_bounded_queue& q) { return consumer_t(q._assignment, q.stats_sink()); }, [](multi_bounded_queue& q, consumer_t&& c) { c.flush(q.subqueue()); }),
+        _enqueue_identifier(*this, [](multi_bounded_queue& q) { return q.get_enqueue_index(); }, [](multi_bounded_queue& q, size_t&& index) { q.return_enqueue_index(index); })
     {
-        static_assert(std::is_base_of<bk_conq::bounded_queue_typed_tag<T>, Q<T>>::value, "Q<T> must be a bounded queue");
+        static_assert(std::is_base_of<bk_conq::bounded_queue_typed_tag<T>, Q>::value, "Q must be a bounded queue");
+        static_assert(Q::producer_cardinality == producers::multi || P == producers::single, "producers may share a subqueue, so Q must allow multiple producers");
+        static_assert(Q::consumer_cardinality == consumers::multi || C == consumers::single, "consumers visit every subqueue, so Q must allow multiple consumers");
         for (size_t i = 0; i < subqueues; ++i) {
             _q.push_back(std::make_unique<padded_bounded_queue>(N));
         }
@@ -37,11 +94,63 @@ public:
     multi_bounded_queue(const multi_bounded_queue&) = delete;
     void operator=(const multi_bounded_queue&) = delete;
 
+    //the multi queue's own counters, added to those of every subqueue that has them
+    queue_stats stats() const {
+        queue_stats stats = STATS::collect();
+        for (auto& q : _q) stats += details::stats_of(*q, 0);
+        return stats;
+    }
+
+    //tokens must not outlive the queue that created them
+    producer_token make_producer_token() {
+        return producer_token(*this, _assignment.acquire());
+    }
+
+    consumer_token make_consumer_token() {
+        return consumer_token(*this);
+    }
+
+    //the operations selected by the declared cardinality, alongside the token operations
+    using bounded_queue<T, multi_bounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>::enqueue;
+    using bounded_queue<T, multi_bounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>::emplace;
+    using bounded_queue<T, multi_bounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>::enqueue_bulk;
+    using bounded_queue<T, multi_bounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>::dequeue;
+    using bounded_queue<T, multi_bounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>::dequeue_bulk;
+
+    //token operations are safe to call concurrently with any other producers and consumers
+    bool enqueue(producer_token& token, T&& input) {
+        return token._subqueue->mp_enqueue(std::move(input));
+    }
+
+    bool enqueue(producer_token& token, const T& input) {
+        return token._subqueue->mp_enqueue(input);
+    }
+
+    template <typename... Args>
+    bool emplace(producer_token& token, Args&&... args) {
+        return token._subqueue->mp_emplace(std::forward<Args>(args)...);
+    }
+
+    template <typename IT>
+    size_t enqueue_bulk(producer_token& token, IT first, IT last) {
+        return token._subqueue->mp_enqueue_bulk(first, last);
+    }
+
+    bool dequeue(consumer_token& token, T& output) {
+        return token._consumer.mc_dequeue(subqueue(), output);
+    }
+
+    template <typename IT>
+    size_t dequeue_bulk(consumer_token& token, IT output, size_t max) {
+        return token._consumer.mc_dequeue_bulk(subqueue(), output, max);
+    }
+
 protected:
+    //another producer may share the subqueue, unless the queue is declared with a single producer
     template <typename R>
     bool sp_enqueue_impl(R&& input) {
         size_t indx = _enqueue_identifier.get();
-        return _q[indx]->mp_enqueue(std::forward<R>(input));
+        return emplace_into(details::single_producer<P>(), *_q[indx], std::forward<R>(input));
     }
 
     template <typename R>
@@ -50,93 +159,114 @@ protected:
         return _q[indx]->mp_enqueue(std::forward<R>(input));
     }
 
+    template <typename... Args>
+    bool sp_emplace_impl(Args&&... args) {
+        size_t indx = _enqueue_identifier.get();
+        return emplace_into(details::single_producer<P>(), *_q[indx], std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    bool mp_emplace_impl(Args&&... args) {
+        size_t indx = _enqueue_identifier.get();
+        return _q[indx]->mp_emplace(std::forward<Args>(args)...);
+    }
+
+    template <typename IT>
+    size_t sp_enqueue_bulk_impl(IT first, IT last) {
+        size_t indx = _enqueue_identifier.get();
+        return enqueue_bulk_into(details::single_producer<P>(), *_q[indx], first, last);
+    }
+
+    template <typename IT>
+    size_t mp_enqueue_bulk_impl(IT first, IT last) {
+        size_t indx = _enqueue_identifier.get();
+        return _q[indx]->mp_enqueue_bulk(first, last);
+    }
+
     bool sc_dequeue_impl(T& output) {
-        auto& hitlist = _hitlist.get();
-        for (auto it = hitlist.cbegin(); it != hitlist.cend(); ++it) {
-            if (_q[*it]->sc_dequeue(output)) {
-                if (hitlist.cbegin() == it) return true;
-                //as below
-                auto nonconstit = hitlist.erase(it, it);
-                for (auto it2 = hitlist.begin(); it2 != nonconstit; ++it2) std::iter_swap(nonconstit, it2);
-                return true;
-            }
-        }
-        return false;
+        return _consumer.get().sc_dequeue(subqueue(), output);
     }
 
     bool mc_dequeue_impl(T& output) {
-        auto& hitlist = _hitlist.get();
-        for (auto it = hitlist.cbegin(); it != hitlist.cend(); ++it) {
-            if (_q[*it]->mc_dequeue_uncontended(output)) {
-                if (hitlist.cbegin() == it) return true;
-                //funky magic - range erase returns an iterator, but an empty range is provided so contents aren't changed
-                //this converts a const iterator to an iterator in constant time
-                auto nonconstit = hitlist.erase(it, it);
-                for (auto it2 = hitlist.begin(); it2 != nonconstit; ++it2) std::iter_swap(nonconstit, it2);
-                return true;
-            }
-        }
-        for (auto it = hitlist.cbegin(); it != hitlist.cend(); ++it) {
-            if (_q[*it]->mc_dequeue(output)) {
-                if (hitlist.cbegin() == it) return true;
-                //as above
-                auto nonconstit = hitlist.erase(it, it);
-                for (auto it2 = hitlist.begin(); it2 != nonconstit; ++it2) std::iter_swap(nonconstit, it2);
-                return true;
-            }
-        }
-        return false;
+        return _consumer.get().mc_dequeue(subqueue(), output);
     }
 
     bool mc_dequeue_uncontended_impl(T& output) {
-        auto& hitlist = _hitlist.get();
-        for (auto it = hitlist.cbegin(); it != hitlist.cend(); ++it) {
-            if (_q[*it]->mc_dequeue_uncontended(output)) {
-                if (hitlist.cbegin() == it) return true;
-                //as above
-                auto nonconstit = hitlist.erase(it, it);
-                for (auto it2 = hitlist.begin(); it2 != nonconstit; ++it2) std::iter_swap(nonconstit, it2);
-                return true;
-            }
-        }
-        return false;
+        return _consumer.get().mc_dequeue_uncontended(subqueue(), output);
+    }
+
+    template <typename IT>
+    size_t sc_dequeue_bulk_impl(IT output, size_t max) {
+        return _consumer.get().sc_dequeue_bulk(subqueue(), output, max);
+    }
+
+    template <typename IT>
+    size_t mc_dequeue_bulk_impl(IT output, size_t max) {
+        return _consumer.get().mc_dequeue_bulk(subqueue(), output, max);
+    }
+
+    //the sum of the subqueue sizes, items held back by a consumer's dequeue policy are not counted
+    size_t size_approx_impl() const {
+        size_t size = 0;
+        for (auto& q : _q) size += q->size_approx();
+        return size;
+    }
+
+    size_t capacity_impl() const {
+        size_t capacity = 0;
+        for (auto& q : _q) capacity += q->capacity();
+        return capacity;
     }
 
 private:
-    class padded_bounded_queue : public Q<T> {
+    template <typename... Args>
+    static bool emplace_into(std::true_type, Q& q, Args&&... args) {
+        return q.sp_emplace(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    static bool emplace_into(std::false_type, Q& q, Args&&... args) {
+        return q.mp_emplace(std::forward<Args>(args)...);
+    }
+
+    template <typename IT>
+    static size_t enqueue_bulk_into(std::true_type, Q& q, IT first, IT last) {
+        return q.sp_enqueue_bulk(first, last);
+    }
+
+    template <typename IT>
+    static size_t enqueue_bulk_into(std::false_type, Q& q, IT first, IT last) {
+        return q.mp_enqueue_bulk(first, last);
+    }
+
+    STATS* stats_sink() {
+        return this;
+    }
+
+    class padded_bounded_queue : public Q {
     public:
-        padded_bounded_queue(size_t N) : Q<T>(N) {}
+        padded_bounded_queue(size_t N) : Q(N) {}
     private:
         char padding[64];
     };
 
-    std::vector<size_t> hitlist_sequence() {
-        std::vector<size_t> hitlist(_q.size());
-        std::iota(hitlist.begin(), hitlist.end(), 0);
-        return hitlist;
+    //maps a subqueue index to the subqueue, for the dequeue policy
+    auto subqueue() {
+        return [this](size_t index) -> padded_bounded_queue& { return *_q[index]; };
     }
 
     size_t get_enqueue_index() {
-        std::lock_guard<std::mutex> lock(_m);
-        if (_unused_enqueue_indexes.empty()) {
-            return (_enqueue_index++) % _q.size();
-        }
-        size_t ret = _unused_enqueue_indexes.back();
-        _unused_enqueue_indexes.pop_back();
-        return ret;
+        return _assignment.acquire();
     }
 
     void return_enqueue_index(size_t index) {
-        std::lock_guard<std::mutex> lock(_m);
-        _unused_enqueue_indexes.push_back(index);
+        _assignment.release(index);
     }
 
-    std::vector<size_t> _unused_enqueue_indexes;
+    ASSIGNMENT _assignment;
     std::vector<std::unique_ptr<padded_bounded_queue>> _q;
-    size_t _enqueue_index{ 0 };
-    std::mutex _m;
-    details::tlos<std::vector<size_t>, multi_bounded_queue<Q<T>>> _hitlist;
-    details::tlos<size_t, multi_bounded_queue<Q<T>>> _enqueue_identifier;
+    details::fast_tlos<consumer_t, multi_bounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>> _consumer;
+    details::fast_tlos<size_t, multi_bounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>> _enqueue_identifier;
 };
 
 }//namespace bk_conq
@@ -0,0 +1,325 @@
+/*
+ * File:   multi_priority_queue.hpp
+ * Author: Barath Kannan
+ * Vector of subqueues grouped into LEVELS priority levels, level 0 being the highest.
+ * Items are enqueued onto a level, and each producer thread uses the same subqueue
+ * index within every level. Dequeues take from the highest priority level that is not
+ * empty, visiting its subqueues in hit list order. A bitmask of the levels that may hold
+ * items lets consumers skip empty levels without probing their subqueues.
+ * With a starvation ratio of n, a non-empty level that has been passed over by n
+ * consecutive dequeues of a consumer is served by that consumer's next dequeue, a ratio
+ * of 0 gives strict priority. If several levels have been passed over that often, the
+ * highest priority of them is served first. Q may be bounded or unbounded, enqueue
+ * operations return false (or the number of items enqueued) if the level's subqueue is
+ * full, or if the level is not below LEVELS.
+ * Created on 14 October 2026 11:59 PM
+ */
+
+#ifndef BK_CONQ_MULTI_PRIORITY_QUEUE_HPP
+#define BK_CONQ_MULTI_PRIORITY_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+#include <bk_conq/assignment_policy.hpp>
+#include <bk_conq/dequeue_policy.hpp>
+#include <bk_conq/bounded_queue.hpp>
+#include <bk_conq/unbounded_queue.hpp>
+#include <bk_conq/details/bits.hpp>
+#include <bk_conq/details/consume_iterator.hpp>
+#include <bk_conq/details/fast_tlos.hpp>
+
+namespace bk_conq {
+template <typename Q, size_t LEVELS, typename T = typename Q::value_type>
+class multi_priority_queue {
+    static_assert(LEVELS > 0 && LEVELS <= 64, "LEVELS must be between 1 and 64");
+    static_assert(std::is_base_of<bk_conq::bounded_queue_typed_tag<T>, Q>::value || std::is_base_of<bk_conq::unbounded_queue_typed_tag<T>, Q>::value, "Q must be a bounded or unbounded queue");
+    typedef hitlist_dequeue::consumer<T> consumer_t;
+    typedef std::is_base_of<bk_conq::bounded_queue_typed_tag<T>, Q> is_bounded;
+
+public:
+    typedef T value_type;
+
+    //args are given to the constructor of every subqueue
+    template <typename... Args>
+    multi_priority_queue(size_t subqueues, size_t starvation_ratio, const Args&... args) :
+        _subqueues(subqueues),
+        _starvation_ratio(starvation_ratio),
+        _assignment(subqueues),
+        _consumer(*this, [](multi_priority_queue& q) { return consumer_state(q._assignment); }),
+        _enqueue_identifier(*this, [](multi_priority_queue& q) { return q._assignment.acquire(); }, [](multi_priority_queue& q, size_t&& index) { q._assignment.release(index); })
+    {
+        for (size_t i = 0; i < LEVELS * subqueues; ++i) {
+            _q.push_back(std::make_unique<padded_queue>(args...));
+        }
+    }
+
+    multi_priority_queue(const multi_priority_queue&) = delete;
+    void operator=(const multi_priority_queue&) = delete;
+
+    bool sp_enqueue(size_t level, T&& input) {
+        return enqueue(level, std::move(input));
+    }
+
+    bool sp_enqueue(size_t level, const T& input) {
+        return enqueue(level, input);
+    }
+
+    bool mp_enqueue(size_t level, T&& input) {
+        return enqueue(level, std::move(input));
+    }
+
+    bool mp_enqueue(size_t level, const T& input) {
+        return enqueue(level, input);
+    }
+
+    template <typename... Args>
+    bool sp_emplace(size_t level, Args&&... args) {
+        return enqueue(level, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    bool mp_emplace(size_t level, Args&&... args) {
+        return enqueue(level, std::forward<Args>(args)...);
+    }
+
+    template <typename IT>
+    size_t sp_enqueue_bulk(size_t level, IT first, IT last) {
+        return enqueue_bulk(level, first, last);
+    }
+
+    template <typename IT>
+    size_t mp_enqueue_bulk(size_t level, IT first, IT last) {
+        return enqueue_bulk(level, first, last);
+    }
+
+    bool sc_dequeue(T& output) {
+        return dequeue(output, true, [](consumer_t& c, auto subqueue, T& output) { return c.sc_dequeue(subqueue, output); });
+    }
+
+    bool mc_dequeue(T& output) {
+        return dequeue(output, true, [](consumer_t& c, auto subqueue, T& output) { return c.mc_dequeue(subqueue, output); });
+    }
+
+    //a failed uncontended dequeue does not show that a level is empty, so it leaves the level bitmask alone
+    bool mc_dequeue_uncontended(T& output) {
+        return dequeue(output, false, [](consumer_t& c, auto subqueue, T& output) { return c.mc_dequeue_uncontended(subqueue, output); });
+    }
+
+    template <typename IT>
+    size_t sc_dequeue_bulk(IT output, size_t max) {
+        return dequeue_bulk(output, max, [](consumer_t& c, auto subqueue, auto& output, size_t max) { return c.sc_dequeue_bulk(subqueue, details::make_ref_iterator(output), max); });
+    }
+
+    template <typename IT>
+    size_t mc_dequeue_bulk(IT output, size_t max) {
+        return dequeue_bulk(output, max, [](consumer_t& c, auto subqueue, auto& output, size_t max) { return c.mc_dequeue_bulk(subqueue, details::make_ref_iterator(output), max); });
+    }
+
+    //invokes f on the item in its subqueue, see bounded_queue::sc_consume
+    template <typename F>
+    bool sc_consume(F&& f) {
+        return sc_dequeue_bulk(details::make_consume_iterator(f), 1) == 1;
+    }
+
+    template <typename F>
+    bool mc_consume(F&& f) {
+        return mc_dequeue_bulk(details::make_consume_iterator(f), 1) == 1;
+    }
+
+    template <typename F>
+    size_t sc_consume_bulk(F&& f, size_t max) {
+        return sc_dequeue_bulk(details::make_consume_iterator(f), max);
+    }
+
+    template <typename F>
+    size_t mc_consume_bulk(F&& f, size_t max) {
+        return mc_dequeue_bulk(details::make_consume_iterator(f), max);
+    }
+
+    //the sum of the subqueue sizes over every level, items held back by a consumer's hit list are not counted
+    size_t size_approx() const {
+        size_t size = 0;
+        for (auto& q : _q) size += q->size_approx();
+        return size;
+    }
+
+    bool empty_approx() const {
+        return size_approx() == 0;
+    }
+
+    //only available when Q is bounded
+    template <typename B = is_bounded, typename = std::enable_if_t<B::value>>
+    size_t capacity() const {
+        size_t capacity = 0;
+        for (auto& q : _q) capacity += q->capacity();
+        return capacity;
+    }
+
+private:
+    class padded_queue : public Q {
+    public:
+        template <typename... Args>
+        padded_queue(const Args&... args) : Q(args...) {}
+    private:
+        char padding[64];
+    };
+
+    //per consumer thread: the hit list of each level, and the number of consecutive dequeues that passed over each level
+    struct consumer_state {
+        consumer_state() = default;
+
+        explicit consumer_state(round_robin_assignment& assignment) {
+            for (auto& level : levels) level = consumer_t(assignment);
+        }
+
+        std::array<consumer_t, LEVELS> levels;
+        std::array<size_t, LEVELS> passed_over{};
+    };
+
+    static uint64_t level_bit(size_t level) {
+        return uint64_t(1) << level;
+    }
+
+    //maps a subqueue index within a level to the subqueue, for the dequeue policy
+    auto subqueue(size_t level) {
+        return [this, level](size_t index) -> padded_queue& { return *_q[level * _subqueues + index]; };
+    }
+
+    padded_queue& producer_subqueue(size_t level) {
+        return *_q[level * _subqueues + _enqueue_identifier.get()];
+    }
+
+    template <typename... Args>
+    bool enqueue(size_t level, Args&&... args) {
+        if (level >= LEVELS) return false;
+        bool ret = push(producer_subqueue(level), is_bounded(), std::forward<Args>(args)...);
+        if (ret) mark(level);
+        return ret;
+    }
+
+    template <typename IT>
+    size_t enqueue_bulk(size_t level, IT first, IT last) {
+        if (level >= LEVELS) return 0;
+        size_t ret = push_bulk(producer_subqueue(level), first, last, is_bounded());
+        if (ret) mark(level);
+        return ret;
+    }
+
+    template <typename... Args>
+    static bool push(padded_queue& q, std::true_type, Args&&... args) {
+        return q.mp_emplace(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    static bool push(padded_queue& q, std::false_type, Args&&... args) {
+        q.mp_emplace(std::forward<Args>(args)...);
+        return true;
+    }
+
+    template <typename IT>
+    static size_t push_bulk(padded_queue& q, IT first, IT last, std::true_type) {
+        return q.mp_enqueue_bulk(first, last);
+    }
+
+    template <typename IT>
+    static size_t push_bulk(padded_queue& q, IT first, IT last, std::false_type) {
+        q.mp_enqueue_bulk(first, last);
+        return std::distance(first, last);
+    }
+
+    //the fence orders the enqueue before the bitmask load, pairing with the fence in clear(),
+    //so either this producer sees the level as cleared and sets it, or the consumer sees the item
+    void mark(size_t level) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!(_nonempty.load(std::memory_order_relaxed) & level_bit(level))) {
+            _nonempty.fetch_or(level_bit(level), std::memory_order_relaxed);
+        }
+    }
+
+    void clear(size_t level) {
+        _nonempty.fetch_and(~level_bit(level), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    //the highest priority level in mask, unless a lower priority level has been passed over too often,
+    //in which case the highest priority of the starved levels
+    size_t choose(consumer_state& c, uint64_t mask) {
+        if (_starvation_ratio) {
+            for (uint64_t m = mask & (mask - 1); m; m &= m - 1) {
+                size_t l = details::lowest_set_bit(m);
+                if (c.passed_over[l] >= _starvation_ratio) return l;
+            }
+        }
+        return details::lowest_set_bit(mask);
+    }
+
+    //every lower priority level in mask has been passed over by a dequeue from level
+    void served(consumer_state& c, size_t level, uint64_t mask) {
+        c.passed_over[level] = 0;
+        for (uint64_t m = mask & ~((level_bit(level) << 1) - 1); m; m &= m - 1) {
+            ++c.passed_over[details::lowest_set_bit(m)];
+        }
+    }
+
+    //a level that is found empty is cleared from the bitmask and probed once more, in case an
+    //item was enqueued onto it by a producer that saw the level as non-empty
+    template <typename DEQUEUE>
+    bool dequeue(T& output, bool clears, DEQUEUE dequeue_level) {
+        consumer_state& c = _consumer.get();
+        uint64_t mask = _nonempty.load(std::memory_order_relaxed);
+        for (uint64_t remaining = mask; remaining; ) {
+            size_t level = choose(c, remaining);
+            bool found = dequeue_level(c.levels[level], subqueue(level), output);
+            if (!found && clears) {
+                clear(level);
+                found = dequeue_level(c.levels[level], subqueue(level), output);
+                if (found) mark(level);
+            }
+            if (found) {
+                served(c, level, mask);
+                return true;
+            }
+            remaining &= ~level_bit(level);
+        }
+        return false;
+    }
+
+    template <typename IT, typename DEQUEUE>
+    size_t dequeue_bulk(IT output, size_t max, DEQUEUE dequeue_level) {
+        consumer_state& c = _consumer.get();
+        uint64_t mask = _nonempty.load(std::memory_order_relaxed);
+        size_t count = 0;
+        for (uint64_t remaining = mask; remaining && count < max; ) {
+            size_t level = choose(c, remaining);
+            size_t dequeued = dequeue_level(c.levels[level], subqueue(level), output, max - count);
+            if (!dequeued) {
+                clear(level);
+                dequeued = dequeue_level(c.levels[level], subqueue(level), output, max - count);
+                if (dequeued) mark(level);
+            }
+            if (dequeued) served(c, level, mask);
+            count += dequeued;
+            remaining &= ~level_bit(level);
+        }
+        return count;
+    }
+
+    const size_t _subqueues;
+    const size_t _starvation_ratio;
+    round_robin_assignment _assignment;
+    std::vector<std::unique_ptr<padded_queue>> _q;
+    char _pad0[64];
+    std::atomic<uint64_t> _nonempty{ 0 };
+    char _pad1[64];
+    details::fast_tlos<consumer_state, multi_priority_queue<Q, LEVELS, T>> _consumer;
+    details::fast_tlos<size_t, multi_priority_queue<Q, LEVELS, T>> _enqueue_identifier;
+};
+
+}//namespace bk_conq
+
+#endif // BK_CONQ_MULTI_PRIORITY_QUEUE_HPP
@@ -7,6 +7,17 @@
  * to the subqueues from which a successful dequeue operation has occured. On a
  * successful dequeue operation, the queue that is used is pushed to the front of the
  * list. The "hit lists" allow the queue to adapt fairly well to different usage contexts.
+ * ASSIGNMENT decides which subqueue each producer uses and the initial order of each
+ * consumer's hit list (see assignment_policy.hpp).
+ * DEQUEUE decides how consumers search the subqueues, by default with the hit list described
+ * above (see dequeue_policy.hpp).
+ * STATS selects whether the consumers' hit list reorders are counted (see stats_policy.hpp).
+ * In adaptive mode the number of subqueues in use follows the load. Every subqueue up to the
+ * maximum is constructed up front, so subqueues are never moved or freed while threads may hold
+ * them. Producers are placed on the active subqueue with the fewest producers, and adapt() grows
+ * the active set when a subqueue is contended and retires subqueues whose producers are idle.
+ * Producers asked to leave a subqueue move on their next enqueue, and consumers pick up the
+ * subqueues they visit on their next dequeue, so neither side is stopped while the set changes.
  * Created on 25 September 2016, 12:04 AM
  */
 
@@ -17,130 +28,350 @@
 #include <vector>
 #include <mutex>
 #include <numeric>
+#include <atomic>
+#include <stdexcept>
+#include <bk_conq/assignment_policy.hpp>
+#include <bk_conq/dequeue_policy.hpp>
+#include <bk_conq/stats_policy.hpp>
 #include <bk_conq/unbounded_queue.hpp>
-#include <bk_conq/details/tlos.hpp>
+#include <bk_conq/details/fast_tlos.hpp>
 
 namespace bk_conq {
 
-template<typename TT>
-class multi_unbounded_queue;
+template <typename Q, typename T = typename Q::value_type, typename ASSIGNMENT = round_robin_assignment, typename DEQUEUE = hitlist_dequeue, typename STATS = no_stats, producers P = producers::multi, consumers C = consumers::multi>
+class multi_unbounded_queue : public unbounded_queue<T, multi_unbounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>, private STATS {
+    friend unbounded_queue<T, multi_unbounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>;
+    typedef typename DEQUEUE::template consumer<T, STATS> consumer_t;
+    class padded_unbounded_queue;
 
-template <template <typename> class Q, typename T>
-class multi_unbounded_queue<Q<T>> : public unbounded_queue<T, multi_unbounded_queue<Q<T>>> {
-    friend unbounded_queue<T, multi_unbounded_queue<Q<T>>>;
 public:
-    multi_unbounded_queue(size_t subqueues) :
-        _q(subqueues),
-        _hitlist([&]() {return hitlist_sequence(); }),
-        _enqueue_identifier([&]() { return get_enqueue_index(); }, [&](padded_unbounded_queue* indx) {return return_enqueue_index(indx); })
-    {
-        static_assert(std::is_base_of<bk_conq::unbounded_queue_typed_tag<T>, Q<T>>::value, "Q<T> must be an unbounded queue");
-    }
+    //binds the creating thread to a subqueue until the token is destroyed, bypassing the thread local lookup
+    //the subqueue is chosen as for a producer thread's first enqueue, by ASSIGNMENT unless the queue is adaptive
+    class producer_token {
+    public:
+        producer_token(producer_token&& other) : _owner(other._owner), _subqueue(other._subqueue) {
+            other._owner = nullptr;
+        }
+
+        producer_token(const producer_token&) = delete;
+        void operator=(const producer_token&) = delete;
+
+        ~producer_token() {
+            if (_owner) _owner->return_enqueue_index(_subqueue);
+        }
+
+    private:
+        friend multi_unbounded_queue;
+
+        producer_token(multi_unbounded_queue& owner, padded_unbounded_queue* subqueue) : _owner(&owner), _subqueue(subqueue) {}
+
+        multi_unbounded_queue* _owner;
+        padded_unbounded_queue* _subqueue;
+    };
+
+    //holds the consumer state that is otherwise thread local, anything it holds is handed back when it is destroyed
+    class consumer_token {
+    public:
+        consumer_token(consumer_token&& other) : _owner(other._owner), _consumer(std::move(other._consumer)) {
+            other._owner = nullptr;
+        }
+
+        consumer_token(const consumer_token&) = delete;
+        void operator=(const consumer_token&) = delete;
+
+        ~consumer_token() {
+            if (_owner) _consumer.flush(_owner->flush_subqueue());
+        }
+
+    private:
+        friend multi_unbounded_queue;
+
+        explicit consumer_token(multi_unbounded_queue& owner) : _owner(&owner), _consumer(owner._assignment, owner.stats_sink()) {}
+
+        multi_unbounded_queue* _owner;
+        consumer_t _consumer;
+    };
+
+    multi_unbounded_queue(size_t subqueues) : multi_unbounded_queue(subqueues, subqueues, 0, false) {}
+
+    //adaptive mode, subqueues subqueues are active initially and at most max_subqueues are, see adapt()
+    multi_unbounded_queue(size_t subqueues, size_t max_subqueues, size_t contention_threshold) :
+        multi_unbounded_queue(subqueues, max_subqueues, contention_threshold, true) {}
 
     multi_unbounded_queue(const multi_unbounded_queue&) = delete;
     void operator=(const multi_unbounded_queue&) = delete;
 
+    //the multi queue's own counters, added to those of every subqueue that has them
+    queue_stats stats() const {
+        queue_stats stats = STATS::collect();
+        for (auto& q : _q) stats += details::stats_of(q, 0);
+        return stats;
+    }
+
+    //adaptive mode only, compares the counters of each subqueue with those seen by the previous call and
+    //grows the active set by one when the most contended active subqueue with more than one producer saw more
+    //than contention_threshold contention_spins and cas_retries, asking half of its producers to move. Otherwise
+    //the highest active subqueue other than the first is retired if no producer is placed on it, or if it has
+    //counted enqueues before but none since the previous call. A retired subqueue is reused first when the set
+    //grows, and consumers stop visiting it once it is empty and its producers have moved.
+    //Contention and enqueues are only counted by subqueues with a statistics policy, such as sharded_stats.
+    //Safe to call concurrently with any other operation, for instance periodically from a housekeeping thread.
+    //Returns the number of active subqueues.
+    size_t adapt() {
+        if (!_adaptive) return _q.size();
+        std::lock_guard<std::mutex> lock(_adapt_mutex);
+        size_t active = _active.load(std::memory_order_relaxed);
+        size_t visible = _visible.load(std::memory_order_relaxed);
+        size_t contended = active;
+        size_t most = 0;
+        bool idle = false;
+        for (size_t i = 0; i < visible; ++i) {
+            queue_stats stats = details::stats_of(static_cast<const Q&>(_q[i]), 0);
+            seen_counters now{ stats[queue_stat::contention_spins] + stats[queue_stat::cas_retries], stats[queue_stat::enqueues] };
+            size_t producers = _q[i].producers.load(std::memory_order_relaxed);
+            if (i < active && producers > 1 && now.contention - _seen[i].contention > most) {
+                most = now.contention - _seen[i].contention;
+                contended = i;
+            }
+            if (i == active - 1) idle = !producers || (_seen[i].enqueues && now.enqueues == _seen[i].enqueues);
+            _seen[i] = now;
+        }
+        if (contended != active && most > _contention_threshold && active < _q.size()) {
+            if (active == visible) _visible.store(++visible, std::memory_order_release);
+            _q[active].moves.store(0);
+            _active.store(++active, std::memory_order_release);
+            _q[contended].moves.store(_q[contended].producers.load() / 2);
+        }
+        else if (idle && active > 1) {
+            _active.store(--active, std::memory_order_release);
+            _q[active].moves.store(retiring);
+        }
+        //no producer can reach a retired subqueue once its producer count is 0, so once it is empty it stays empty
+        while (visible > active && _q[visible - 1].producers.load() == 0 && _q[visible - 1].size_approx() == 0) --visible;
+        _visible.store(visible, std::memory_order_release);
+        return active;
+    }
+
+    //the number of subqueues producers are placed on
+    size_t active_subqueues() const {
+        return _active.load(std::memory_order_relaxed);
+    }
+
+    //tokens must not outlive the queue that created them
+    producer_token make_producer_token() {
+        return producer_token(*this, get_enqueue_index());
+    }
+
+    consumer_token make_consumer_token() {
+        return consumer_token(*this);
+    }
+
+    //the operations selected by the declared cardinality, alongside the token operations
+    using unbounded_queue<T, multi_unbounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>::enqueue;
+    using unbounded_queue<T, multi_unbounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>::emplace;
+    using unbounded_queue<T, multi_unbounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>::enqueue_bulk;
+    using unbounded_queue<T, multi_unbounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>::dequeue;
+    using unbounded_queue<T, multi_unbounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>, P, C>::dequeue_bulk;
+
+    //token operations are safe to call concurrently with any other producers and consumers
+    void enqueue(producer_token& token, T&& input) {
+        producer_subqueue(token._subqueue)->mp_enqueue(std::move(input));
+    }
+
+    void enqueue(producer_token& token, const T& input) {
+        producer_subqueue(token._subqueue)->mp_enqueue(input);
+    }
+
+    template <typename... Args>
+    void emplace(producer_token& token, Args&&... args) {
+        producer_subqueue(token._subqueue)->mp_emplace(std::forward<Args>(args)...);
+    }
+
+    template <typename IT>
+    void enqueue_bulk(producer_token& token, IT first, IT last) {
+        producer_subqueue(token._subqueue)->mp_enqueue_bulk(first, last);
+    }
+
+    bool dequeue(consumer_token& token, T& output) {
+        return token._consumer.mc_dequeue(subqueue(), output);
+    }
+
+    template <typename IT>
+    size_t dequeue_bulk(consumer_token& token, IT output, size_t max) {
+        return token._consumer.mc_dequeue_bulk(subqueue(), output, max);
+    }
+
 protected:
     template <typename R>
     void sp_enqueue_impl(R&& input) {
-        _enqueue_identifier.get()->sp_enqueue(std::forward<R>(input));
+        producer_subqueue(_enqueue_identifier.get())->sp_enqueue(std::forward<R>(input));
     }
 
     template <typename R>
     void mp_enqueue_impl(R&& input) {
-        _enqueue_identifier.get()->mp_enqueue(std::forward<R>(input));
+        producer_subqueue(_enqueue_identifier.get())->mp_enqueue(std::forward<R>(input));
+    }
+
+    template <typename... Args>
+    void sp_emplace_impl(Args&&... args) {
+        producer_subqueue(_enqueue_identifier.get())->sp_emplace(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void mp_emplace_impl(Args&&... args) {
+        producer_subqueue(_enqueue_identifier.get())->mp_emplace(std::forward<Args>(args)...);
+    }
+
+    template <typename IT>
+    void sp_enqueue_bulk_impl(IT first, IT last) {
+        producer_subqueue(_enqueue_identifier.get())->sp_enqueue_bulk(first, last);
+    }
+
+    template <typename IT>
+    void mp_enqueue_bulk_impl(IT first, IT last) {
+        producer_subqueue(_enqueue_identifier.get())->mp_enqueue_bulk(first, last);
     }
 
     bool sc_dequeue_impl(T& output) {
-        auto& hitlist = _hitlist.get();
-        for (auto it = hitlist.cbegin(); it != hitlist.cend(); ++it) {
-            if (_q[*it].sc_dequeue(output)) {
-                if (hitlist.cbegin() == it) return true;
-                //as below
-                auto nonconstit = hitlist.erase(it, it);
-                for (auto it2 = hitlist.begin(); it2 != nonconstit; ++it2) std::iter_swap(nonconstit, it2);
-                return true;
-            }
-        }
-        return false;
+        return _consumer.get().sc_dequeue(subqueue(), output);
     }
 
     bool mc_dequeue_impl(T& output) {
-        auto& hitlist = _hitlist.get();
-        for (auto it = hitlist.cbegin(); it != hitlist.cend(); ++it) {
-            if (_q[*it].mc_dequeue_uncontended(output)) {
-                if (hitlist.cbegin() == it) return true;
-                //funky magic - range erase returns an iterator, but an empty range is provided so contents aren't changed
-                //this converts a const iterator to an iterator in constant time
-                auto nonconstit = hitlist.erase(it, it);
-                for (auto it2 = hitlist.begin(); it2 != nonconstit; ++it2) std::iter_swap(nonconstit, it2);
-                return true;
-            }
-        }
-        for (auto it = hitlist.cbegin(); it != hitlist.cend(); ++it) {
-            if (_q[*it].mc_dequeue(output)) {
-                if (hitlist.cbegin() == it) return true;
-                //as above
-                auto nonconstit = hitlist.erase(it, it);
-                for (auto it2 = hitlist.begin(); it2 != nonconstit; ++it2) std::iter_swap(nonconstit, it2);
-                return true;
-            }
-        }
-        return false;
+        return _consumer.get().mc_dequeue(subqueue(), output);
     }
 
     bool mc_dequeue_uncontended_impl(T& output) {
-        auto& hitlist = _hitlist.get();
-        for (auto it = hitlist.cbegin(); it != hitlist.cend(); ++it) {
-            if (_q[*it].mc_dequeue_uncontended(output)) {
-                if (hitlist.cbegin() == it) return true;
-                //as above
-                auto nonconstit = hitlist.erase(it, it);
-                for (auto it2 = hitlist.begin(); it2 != nonconstit; ++it2) std::iter_swap(nonconstit, it2);
-                return true;
-            }
-        }
-        return false;
+        return _consumer.get().mc_dequeue_uncontended(subqueue(), output);
+    }
+
+    template <typename IT>
+    size_t sc_dequeue_bulk_impl(IT output, size_t max) {
+        return _consumer.get().sc_dequeue_bulk(subqueue(), output, max);
+    }
+
+    template <typename IT>
+    size_t mc_dequeue_bulk_impl(IT output, size_t max) {
+        return _consumer.get().mc_dequeue_bulk(subqueue(), output, max);
+    }
+
+    //the sum of the subqueue sizes, items held back by a consumer's dequeue policy are not counted
+    size_t size_approx_impl() const {
+        size_t size = 0;
+        for (auto& q : _q) size += q.size_approx();
+        return size;
     }
 
 private:
-    class padded_unbounded_queue : public Q<T> {
+    //the atomics are only used in adaptive mode, moves is retiring once every producer must leave
+    class padded_unbounded_queue : public Q {
+    public:
+        std::atomic<size_t> producers{ 0 };
+        std::atomic<size_t> moves{ 0 };
+    private:
         char padding[64];
     };
 
-    std::vector<size_t> hitlist_sequence() {
-        std::vector<size_t> hitlist(_q.size());
-        std::iota(hitlist.begin(), hitlist.end(), 0);
-        return hitlist;
+    struct seen_counters {
+        size_t contention;
+        size_t enqueues;
+    };
+
+    static constexpr size_t retiring = ~size_t(0);
+
+    multi_unbounded_queue(size_t subqueues, size_t max_subqueues, size_t contention_threshold, bool adaptive) :
+        _q(max_subqueues),
+        _assignment(max_subqueues),
+        _adaptive(adaptive),
+        _contention_threshold(contention_threshold),
+        _active(subqueues),
+        _visible(subqueues),
+        _seen(adaptive ? max_subqueues : 0, seen_counters{ 0, 0 }),
+        _consumer(*this, [](multi_unbounded_queue& q) { return consumer_t(q._assignment, q.stats_sink()); }, [](multi_unbounded_queue& q, consumer_t&& c) { c.flush(q.flush_subqueue()); }),
+        _enqueue_identifier(*this, [](multi_unbounded_queue& q) { return q.get_enqueue_index(); }, [](multi_unbounded_queue& q, padded_unbounded_queue*&& index) { q.return_enqueue_index(index); })
+    {
+        if (!subqueues || max_subqueues < subqueues) throw std::length_error("multi_unbounded_queue needs at least 1 subqueue, and at most max_subqueues");
+        static_assert(std::is_base_of<bk_conq::unbounded_queue_typed_tag<T>, Q>::value, "Q must be an unbounded queue");
+        static_assert(Q::producer_cardinality == producers::multi || P == producers::single, "producers may share a subqueue, so Q must allow multiple producers");
+        static_assert(Q::consumer_cardinality == consumers::multi || C == consumers::single, "consumers visit every subqueue, so Q must allow multiple consumers");
     }
 
-    padded_unbounded_queue* get_enqueue_index() {
-        std::lock_guard<std::mutex> lock(_m);
-        if (_unused_enqueue_indexes.empty()) {
-            return &_q[(_enqueue_index++) % _q.size()];
+    STATS* stats_sink() {
+        return this;
+    }
+
+    //maps a subqueue index to the subqueue for the dequeue policy, and gives the number of subqueues to visit
+    class subqueue_accessor {
+    public:
+        explicit subqueue_accessor(multi_unbounded_queue& owner) : _owner(owner) {}
+
+        padded_unbounded_queue& operator()(size_t index) const {
+            return _owner._q[index];
+        }
+
+        size_t count() const {
+            return _owner._visible.load(std::memory_order_acquire);
         }
-        size_t ret = _unused_enqueue_indexes.back();
-        _unused_enqueue_indexes.pop_back();
-        return &_q[ret];
+
+    private:
+        multi_unbounded_queue& _owner;
+    };
+
+    subqueue_accessor subqueue() {
+        return subqueue_accessor(*this);
     }
 
-    void return_enqueue_index(padded_unbounded_queue* index) {
-        std::lock_guard<std::mutex> lock(_m);
-        for (size_t i = 0; i < _q.size(); ++i) {
-            if (&_q[i] == index) {
-                _unused_enqueue_indexes.push_back(i);
-                return;
+    //items handed back by an exiting consumer go to the first subqueue in adaptive mode, which is never retired
+    auto flush_subqueue() {
+        return [this](size_t index) -> padded_unbounded_queue& { return _q[_adaptive ? 0 : index]; };
+    }
+
+    //the calling producer's subqueue, after moving the producer if it has been asked to leave
+    padded_unbounded_queue* producer_subqueue(padded_unbounded_queue*& q) {
+        if (q->moves.load(std::memory_order_relaxed)) move_producer(q);
+        return q;
+    }
+
+    //as many producers as were asked leave a subqueue, and every producer leaves a retiring subqueue
+    void move_producer(padded_unbounded_queue*& q) {
+        size_t moves = q->moves.load(std::memory_order_relaxed);
+        while (moves && moves != retiring && !q->moves.compare_exchange_weak(moves, moves - 1, std::memory_order_relaxed)) {}
+        if (!moves) return;
+        return_enqueue_index(q);
+        q = get_enqueue_index();
+    }
+
+    padded_unbounded_queue* get_enqueue_index() {
+        if (!_adaptive) return &_q[_assignment.acquire()];
+        while (true) {
+            size_t active = _active.load(std::memory_order_acquire);
+            size_t index = 0;
+            for (size_t i = 1; i < active; ++i) {
+                if (_q[i].producers.load(std::memory_order_relaxed) < _q[index].producers.load(std::memory_order_relaxed)) index = i;
             }
+            //adapt() only stops consumers visiting a retiring subqueue once it sees no producers on it
+            _q[index].producers.fetch_add(1);
+            if (_q[index].moves.load() != retiring) return &_q[index];
+            _q[index].producers.fetch_sub(1);
         }
     }
 
+    void return_enqueue_index(padded_unbounded_queue* index) {
+        if (!_adaptive) _assignment.release(static_cast<size_t>(index - _q.data()));
+        else index->producers.fetch_sub(1, std::memory_order_release);
+    }
+
     std::vector<padded_unbounded_queue> _q;
-    std::vector<size_t> _unused_enqueue_indexes;
-    size_t _enqueue_index{ 0 };
-    std::mutex _m;
+    ASSIGNMENT _assignment;
+    const bool _adaptive;
+    const size_t _contention_threshold;
+    //producers are placed on the first _active subqueues, consumers visit the first _visible
+    std::atomic<size_t> _active;
+    std::atomic<size_t> _visible;
+    std::vector<seen_counters> _seen;
+    std::mutex _adapt_mutex;
 
-    details::tlos<std::vector<size_t>, multi_unbounded_queue<Q<T>>> _hitlist;
-    details::tlos<padded_unbounded_queue*, multi_unbounded_queue<Q<T>>> _enqueue_identifier;
+    details::fast_tlos<consumer_t, multi_unbounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>> _consumer;
+    details::fast_tlos<padded_unbounded_queue*, multi_unbounded_queue<Q, T, ASSIGNMENT, DEQUEUE, STATS, P, C>> _enqueue_identifier;
 };
 
 }//namespace bk_conq
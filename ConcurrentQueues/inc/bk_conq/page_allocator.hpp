@@ -0,0 +1,203 @@
+/*
+* File:   page_allocator.hpp
+* Author: Barath Kannan
+* Allocator that maps storage directly from the operating system, for use as
+* the ALLOCATOR of the bounded queues. It can back the storage with huge pages,
+* bind or interleave it across NUMA nodes and pre-fault it from several threads
+* at allocation time.
+* Huge pages and NUMA placement are only available on Linux, other platforms
+* fall back to the global operator new.
+* Created on 14 October 2026 6:20 PM
+*/
+
+#ifndef BK_CONQ_PAGE_ALLOCATOR_HPP
+#define BK_CONQ_PAGE_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bk_conq {
+
+//normal: base pages
+//transparent_huge: base pages, aligned and advised for transparent huge pages
+//huge_2mb/huge_1gb: explicit huge pages from the hugetlb pool, falling back to transparent_huge if none are available
+enum class page_size {
+    normal,
+    transparent_huge,
+    huge_2mb,
+    huge_1gb
+};
+
+//bind: allocate only on the nodes in the node mask
+//interleave: spread pages round-robin over the nodes in the node mask
+enum class numa_policy {
+    none,
+    bind,
+    interleave
+};
+
+//base pages by default, huge pages and NUMA placement are opt-in
+struct page_options {
+    page_size pages = page_size::normal;
+    numa_policy numa = numa_policy::none;
+    //bit n selects NUMA node n
+    uint64_t node_mask = 1;
+    //number of threads used to touch every page at allocation time, 0 to leave pages to be faulted on first use
+    size_t prefault_threads = 0;
+};
+
+template <typename T>
+class page_allocator {
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind {
+        typedef page_allocator<U> other;
+    };
+
+    page_allocator(const page_options& options = page_options()) : _options(options) {}
+
+    template <typename U>
+    page_allocator(const page_allocator<U>& other) : _options(other.options()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(allocate_bytes(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        deallocate_bytes(p, n * sizeof(T));
+    }
+
+    const page_options& options() const {
+        return _options;
+    }
+
+private:
+#if defined(__linux__)
+    //values from linux/mempolicy.h and linux/mman.h, defined here so the header has no libnuma dependency
+    static const int mpol_bind = 2;
+    static const int mpol_interleave = 3;
+    static const int map_huge_shift = 26;
+
+    static size_t huge_page_bytes(page_size pages) {
+        return pages == page_size::huge_1gb ? (size_t(1) << 30) : (size_t(1) << 21);
+    }
+
+    static size_t base_page_bytes() {
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    static size_t round_up(size_t bytes, size_t granularity) {
+        return (bytes + granularity - 1) / granularity * granularity;
+    }
+
+    //the mapping length for a request, identical for allocate and deallocate
+    size_t mapping_bytes(size_t bytes) const {
+        if (_options.pages == page_size::normal) return round_up(bytes, base_page_bytes());
+        return round_up(bytes, huge_page_bytes(_options.pages));
+    }
+
+    void* map_hugetlb(size_t length) const {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+        flags |= (_options.pages == page_size::huge_1gb ? 30 : 21) << map_huge_shift;
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    //maps length bytes aligned to the huge page size, by over-mapping and trimming the ends
+    void* map_aligned(size_t length) const {
+        size_t alignment = _options.pages == page_size::normal ? base_page_bytes() : huge_page_bytes(_options.pages);
+        size_t padded = length + alignment;
+        void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) throw std::bad_alloc();
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (start + alignment - 1) / alignment * alignment;
+        if (aligned != start) munmap(raw, aligned - start);
+        size_t trailing = (start + padded) - (aligned + length);
+        if (trailing) munmap(reinterpret_cast<void*>(aligned + length), trailing);
+        void* p = reinterpret_cast<void*>(aligned);
+        if (_options.pages != page_size::normal) madvise(p, length, MADV_HUGEPAGE);
+        return p;
+    }
+
+    void bind(void* p, size_t length) const {
+        if (_options.numa == numa_policy::none) return;
+        unsigned long mask = static_cast<unsigned long>(_options.node_mask);
+        int mode = _options.numa == numa_policy::bind ? mpol_bind : mpol_interleave;
+        //best effort: placement is left to the kernel if the policy is rejected
+        syscall(SYS_mbind, p, length, mode, &mask, sizeof(mask) * 8 + 1, 0);
+    }
+
+    void prefault(void* p, size_t length) const {
+        if (_options.prefault_threads == 0) return;
+        size_t page = base_page_bytes();
+        size_t pages = length / page;
+        size_t nthreads = std::min(_options.prefault_threads, std::max<size_t>(pages, 1));
+        size_t per_thread = (pages + nthreads - 1) / nthreads;
+        auto touch = [p, page, pages, per_thread](size_t t) {
+            volatile char* base = static_cast<volatile char*>(p);
+            for (size_t i = t * per_thread; i < std::min(pages, (t + 1) * per_thread); ++i) {
+                base[i * page] = 0;
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < nthreads; ++t) {
+            threads.emplace_back(touch, t);
+        }
+        touch(0);
+        for (auto& t : threads) t.join();
+    }
+
+    void* allocate_bytes(size_t bytes) {
+        size_t length = mapping_bytes(bytes);
+        void* p = nullptr;
+        if (_options.pages == page_size::huge_2mb || _options.pages == page_size::huge_1gb) {
+            p = map_hugetlb(length);
+        }
+        if (!p) p = map_aligned(length);
+        bind(p, length);
+        prefault(p, length);
+        return p;
+    }
+
+    void deallocate_bytes(void* p, size_t bytes) {
+        munmap(p, mapping_bytes(bytes));
+    }
+#else
+    void* allocate_bytes(size_t bytes) {
+        return ::operator new(bytes);
+    }
+
+    void deallocate_bytes(void* p, size_t) {
+        ::operator delete(p);
+    }
+#endif
+
+    page_options _options;
+};
+
+template <typename T, typename U>
+bool operator==(const page_allocator<T>& a, const page_allocator<U>& b) {
+    return a.options().pages == b.options().pages && a.options().numa == b.options().numa &&
+        a.options().node_mask == b.options().node_mask;
+}
+
+template <typename T, typename U>
+bool operator!=(const page_allocator<T>& a, const page_allocator<U>& b) {
+    return !(a == b);
+}
+
+}//namespace bk_conq
+
+#endif // BK_CONQ_PAGE_ALLOCATOR_HPP
@@ -0,0 +1,352 @@
+/*
+ * File:   segment_queue.hpp
+ * Author: Barath Kannan
+ * This is an unbounded multi-producer multi-consumer queue.
+ * It can also be used as any combination of single-producer and single-consumer
+ * queues for additional performance gains in those contexts. The queue is implemented
+ * as a linked list of segments of SEGMENT_SIZE slots. Each segment uses the slot and
+ * sequence number scheme of vector_queue, except that it is filled only once: producers
+ * claim slots in the head segment and move on to a new segment when it is full, and
+ * consumers take items in FIFO order from the tail segment and retire it once every
+ * slot has been consumed. Retired segments are recycled through a pool once no thread
+ * is still using them, so segments are kept until the queue is destroyed.
+ * Slot storage is obtained from ALLOCATOR. Items are constructed in their slot on
+ * enqueue and destroyed on dequeue.
+ * Created on 14 October 2026 11:58 PM
+ */
+
+#ifndef BK_CONQ_SEGMENTQUEUE_HPP
+#define BK_CONQ_SEGMENTQUEUE_HPP
+
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <bk_conq/unbounded_queue.hpp>
+#include <bk_conq/details/slot_storage.hpp>
+
+namespace bk_conq {
+
+template<typename T, size_t SEGMENT_SIZE = 1024, typename ALLOCATOR = std::allocator<T>, producers P = producers::multi, consumers C = consumers::multi>
+class segment_queue : public unbounded_queue<T, segment_queue<T, SEGMENT_SIZE, ALLOCATOR, P, C>, P, C> {
+    friend unbounded_queue<T, segment_queue<T, SEGMENT_SIZE, ALLOCATOR, P, C>, P, C>;
+    static_assert(SEGMENT_SIZE > 0, "SEGMENT_SIZE must be greater than 0");
+public:
+    //prewarm_segments are placed in the pool up front
+    segment_queue(size_t prewarm_segments = 0, const ALLOCATOR& allocator = ALLOCATOR()) : _allocator(allocator) {
+        segment* first = allocate();
+        _head.store(first, std::memory_order_relaxed);
+        _tail.store(first, std::memory_order_relaxed);
+        for (size_t i = 0; i < prewarm_segments; ++i) {
+            _pool.push_back(allocate());
+        }
+    }
+
+    //items still in the queue are destroyed, no operations may be in progress
+    ~segment_queue() {
+        for (segment* seg = _tail.load(std::memory_order_relaxed); seg; seg = seg->next.load(std::memory_order_relaxed)) {
+            seg->destroy_items();
+        }
+    }
+
+    segment_queue(const segment_queue&) = delete;
+    void operator=(const segment_queue&) = delete;
+
+protected:
+    template <typename R>
+    void sp_enqueue_impl(R&& input) {
+        emplace<false>(std::forward<R>(input));
+    }
+
+    template <typename R>
+    void mp_enqueue_impl(R&& input) {
+        emplace<true>(std::forward<R>(input));
+    }
+
+    template <typename... Args>
+    void sp_emplace_impl(Args&&... args) {
+        emplace<false>(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void mp_emplace_impl(Args&&... args) {
+        emplace<true>(std::forward<Args>(args)...);
+    }
+
+    template <typename IT>
+    void sp_enqueue_bulk_impl(IT first, IT last) {
+        enqueue_bulk<false>(first, last);
+    }
+
+    template <typename IT>
+    void mp_enqueue_bulk_impl(IT first, IT last) {
+        enqueue_bulk<true>(first, last);
+    }
+
+    bool sc_dequeue_impl(T& output) {
+        return dequeue_bulk<false>(&output, 1) == 1;
+    }
+
+    bool mc_dequeue_impl(T& output) {
+        return dequeue_bulk<true>(&output, 1) == 1;
+    }
+
+    bool mc_dequeue_uncontended_impl(T& output) {
+        return this->sc_dequeue(output);
+    }
+
+    template <typename IT>
+    size_t sc_dequeue_bulk_impl(IT output, size_t max) {
+        return dequeue_bulk<false>(output, max);
+    }
+
+    template <typename IT>
+    size_t mc_dequeue_bulk_impl(IT output, size_t max) {
+        return dequeue_bulk<true>(output, max);
+    }
+
+    //the segments may be retired while they are being read, so the result is clamped at 0
+    size_t size_approx_impl() const {
+        size_t dequeued = _tail.load()->position(&segment::tail_seq);
+        size_t enqueued = _head.load()->position(&segment::head_seq);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+private:
+    //set on a segment's user count once it has been unlinked, the last user to leave recycles it
+    static constexpr size_t unlinked = ~(~size_t(0) >> 1);
+
+    struct segment {
+        explicit segment(const ALLOCATOR& allocator) : slots(SEGMENT_SIZE, allocator) {
+            reset();
+        }
+
+        //the user count is left alone, threads holding a stale pointer may still be counted
+        void reset() {
+            for (size_t i = 0; i < SEGMENT_SIZE; ++i) {
+                slots.seq(i).store(i, std::memory_order_relaxed);
+            }
+            head_seq.store(0, std::memory_order_relaxed);
+            tail_seq.store(0, std::memory_order_relaxed);
+            next.store(nullptr, std::memory_order_relaxed);
+        }
+
+        //the number of slots claimed in the queue up to the given end of this segment
+        size_t position(const std::atomic<size_t> segment::* seq) const {
+            return base.load(std::memory_order_relaxed) + std::min((this->*seq).load(std::memory_order_relaxed), SEGMENT_SIZE);
+        }
+
+        //slots are never reused within a segment, so producers claim them without checking sequence numbers
+        //a multi-producer claim may overshoot the end of the segment, which only marks it as full
+        template <bool MP>
+        size_t claim_free(size_t max, size_t& first) {
+            if (MP) {
+                first = head_seq.fetch_add(max, std::memory_order_relaxed);
+                if (first >= SEGMENT_SIZE) return 0;
+                return std::min(max, SEGMENT_SIZE - first);
+            }
+            first = head_seq.load(std::memory_order_relaxed);
+            size_t count = std::min(max, SEGMENT_SIZE - first);
+            head_seq.store(first + count, std::memory_order_relaxed);
+            return count;
+        }
+
+        template <typename... Args>
+        void publish(size_t seq, Args&&... args) {
+            slots.data(seq).construct(std::forward<Args>(args)...);
+            slots.seq(seq).store(seq + 1, std::memory_order_release);
+        }
+
+        //claims the longest run of published slots (up to max), a single consumer claim makes one attempt
+        template <bool MC>
+        size_t claim_ready(size_t max, size_t& first) {
+            first = tail_seq.load(std::memory_order_relaxed);
+            size_t count;
+            do {
+                count = ready_run(first, max);
+                if (count == 0) return 0;
+                if (!MC) return tail_seq.compare_exchange_strong(first, first + count, std::memory_order_relaxed) ? count : 0;
+            } while (!tail_seq.compare_exchange_weak(first, first + count, std::memory_order_relaxed));
+            return count;
+        }
+
+        //with no operations in progress, every claimed slot has been published
+        void destroy_items() {
+            size_t end = std::min(head_seq.load(std::memory_order_relaxed), SEGMENT_SIZE);
+            for (size_t seq = tail_seq.load(std::memory_order_relaxed); seq < end; ++seq) {
+                slots.data(seq).destroy();
+            }
+        }
+
+        size_t ready_run(size_t first, size_t max) {
+            size_t count = 0;
+            while (count < max && first + count < SEGMENT_SIZE &&
+                slots.seq(first + count).load(std::memory_order_acquire) == first + count + 1) {
+                ++count;
+            }
+            return count;
+        }
+
+        details::slot_storage<T, slot_layout::packed, ALLOCATOR> slots;
+        char _pad0[details::cache_line_size];
+        std::atomic<size_t> head_seq{ 0 };
+        char _pad1[details::cache_line_size];
+        std::atomic<size_t> tail_seq{ 0 };
+        char _pad2[details::cache_line_size];
+        std::atomic<segment*> next{ nullptr };
+        std::atomic<size_t> users{ 0 };
+        //the number of slots in the segments before this one, only used by size_approx
+        std::atomic<size_t> base{ 0 };
+    };
+
+    template <bool MP, typename... Args>
+    void emplace(Args&&... args) {
+        segment* seg = enter(_head);
+        size_t seq;
+        while (!seg->template claim_free<MP>(1, seq)) {
+            seg = advance_head(seg);
+        }
+        seg->publish(seq, std::forward<Args>(args)...);
+        leave(seg);
+    }
+
+    template <bool MP, typename IT>
+    void enqueue_bulk(IT first, IT last) {
+        size_t remaining = std::distance(first, last);
+        if (!remaining) return;
+        segment* seg = enter(_head);
+        for (;;) {
+            size_t seq;
+            size_t count = seg->template claim_free<MP>(remaining, seq);
+            for (size_t i = 0; i < count; ++i, ++first) {
+                seg->publish(seq + i, *first);
+            }
+            remaining -= count;
+            if (!remaining) break;
+            seg = advance_head(seg);
+        }
+        leave(seg);
+    }
+
+    //items are taken from the tail segment until it runs out of published items, moving on
+    //to the next segment whenever every slot of the tail segment has been consumed
+    template <bool MC, typename IT>
+    size_t dequeue_bulk(IT output, size_t max) {
+        size_t count = 0;
+        segment* seg = enter(_tail);
+        while (count < max) {
+            size_t seq;
+            size_t taken = seg->template claim_ready<MC>(max - count, seq);
+            for (size_t i = 0; i < taken; ++i, ++output) {
+                seg->slots.data(seq + i).move_to(*output);
+            }
+            count += taken;
+            if (seq + taken < SEGMENT_SIZE) break;
+            seg = advance_tail(seg);
+            if (!seg) return count;
+        }
+        leave(seg);
+        return count;
+    }
+
+    //a segment is only used after it has been counted as a user and found to still be the head or tail,
+    //so that it cannot be recycled while it is in use
+    segment* enter(std::atomic<segment*>& end) {
+        segment* seg = end.load();
+        for (;;) {
+            seg->users.fetch_add(1);
+            segment* current = end.load();
+            if (current == seg) return seg;
+            leave(seg);
+            seg = current;
+        }
+    }
+
+    void leave(segment* seg) {
+        if (seg->users.fetch_sub(1) == unlinked + 1) recycle(seg);
+    }
+
+    //a thread with a stale pointer may be counted in the meantime, then it is the one to recycle
+    void recycle(segment* seg) {
+        size_t expected = unlinked;
+        if (!seg->users.compare_exchange_strong(expected, 0)) return;
+        seg->reset();
+        std::lock_guard<std::mutex> lock(_pool_mutex);
+        _pool.push_back(seg);
+    }
+
+    //links a segment after the full head segment if no other producer has, and moves the head on to it
+    segment* advance_head(segment* seg) {
+        segment* next = seg->next.load(std::memory_order_acquire);
+        if (!next) {
+            segment* fresh = acquire();
+            fresh->base.store(seg->base.load(std::memory_order_relaxed) + SEGMENT_SIZE, std::memory_order_relaxed);
+            if (seg->next.compare_exchange_strong(next, fresh, std::memory_order_acq_rel)) {
+                next = fresh;
+            }
+            else {
+                //never linked, so no thread can be using it
+                std::lock_guard<std::mutex> lock(_pool_mutex);
+                _pool.push_back(fresh);
+            }
+        }
+        segment* expected = seg;
+        _head.compare_exchange_strong(expected, next);
+        leave(seg);
+        return enter(_head);
+    }
+
+    //retires the consumed tail segment, returning nullptr if no segment follows it yet
+    segment* advance_tail(segment* seg) {
+        segment* next = seg->next.load(std::memory_order_acquire);
+        if (!next) {
+            leave(seg);
+            return nullptr;
+        }
+        //the producers may not have moved the head on yet, it must not be left on a retired segment
+        segment* expected = seg;
+        _head.compare_exchange_strong(expected, next);
+        expected = seg;
+        if (_tail.compare_exchange_strong(expected, next)) {
+            seg->users.fetch_add(unlinked);
+        }
+        leave(seg);
+        return enter(_tail);
+    }
+
+    segment* acquire() {
+        {
+            std::lock_guard<std::mutex> lock(_pool_mutex);
+            if (!_pool.empty()) {
+                segment* seg = _pool.back();
+                _pool.pop_back();
+                return seg;
+            }
+        }
+        std::unique_ptr<segment> seg(new segment(_allocator));
+        std::lock_guard<std::mutex> lock(_pool_mutex);
+        _segments.push_back(std::move(seg));
+        return _segments.back().get();
+    }
+
+    segment* allocate() {
+        _segments.push_back(std::unique_ptr<segment>(new segment(_allocator)));
+        return _segments.back().get();
+    }
+
+    ALLOCATOR _allocator;
+    char _pad0[details::cache_line_size];
+    std::atomic<segment*> _head;
+    char _pad1[details::cache_line_size];
+    std::atomic<segment*> _tail;
+    char _pad2[details::cache_line_size];
+    //every segment ever allocated, a segment's memory stays valid for threads holding a stale pointer to it
+    std::vector<std::unique_ptr<segment>> _segments;
+    std::vector<segment*> _pool;
+    std::mutex _pool_mutex;
+};
+}//namespace bk_conq
+
+#endif /* BK_CONQ_SEGMENTQUEUE_HPP */
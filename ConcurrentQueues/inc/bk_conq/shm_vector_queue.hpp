@@ -0,0 +1,394 @@
+/*
+ * File:   shm_vector_queue.hpp
+ * Author: Barath Kannan
+ * This is a bounded multi-producer multi-consumer queue that lives in a shared
+ * memory region, so that it can be used between processes. It is the ring of
+ * vector_queue, with the sequence numbers, the head and the tail kept in the region
+ * so that they are independent of the address at which each process maps it.
+ * The region is a named POSIX shared memory object, or any file descriptor that
+ * can be mapped for reading and writing such as a memfd or a file. It begins with
+ * a header recording a version and the layout of the ring, which is checked by
+ * every process that attaches. T must be trivially copyable, and the size of the
+ * queue must be a power of 2, at least 2.
+ * The single-producer and single-consumer operations publish an item before
+ * advancing the head or tail, so a process that dies between the two leaves the
+ * ring consistent, and its successor completes the operation with
+ * reattach_producer or reattach_consumer. An item whose dequeue had not been
+ * published is delivered again. The multi-producer and multi-consumer operations
+ * claim a slot before using it, so they are not safe against a process dying.
+ * Only available on Linux.
+ * Created on 14 October 2026 11:59 PM
+ */
+
+#ifndef BK_CONQ_SHM_VECTORQUEUE_HPP
+#define BK_CONQ_SHM_VECTORQUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cerrno>
+#include <new>
+#include <string>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <algorithm>
+#include <bk_conq/bounded_queue.hpp>
+#include <bk_conq/details/slot_storage.hpp>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace bk_conq {
+#if defined(__linux__)
+template<typename T, producers P = producers::multi, consumers C = consumers::multi>
+class shm_vector_queue : public bounded_queue<T, shm_vector_queue<T, P, C>, P, C> {
+    friend bounded_queue<T, shm_vector_queue<T, P, C>, P, C>;
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable to be shared between processes");
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shm_vector_queue requires lock-free 64 bit atomics");
+public:
+    //incremented whenever the layout of the region changes
+    static constexpr uint32_t version = 1;
+
+    //creates the named region with N slots, or attaches to it if it already exists with N slots
+    shm_vector_queue(const std::string& name, size_t N) {
+        checked_size(N);
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        map_and_close(fd, N);
+    }
+
+    //attaches to an existing named region, taking the number of slots from its header
+    explicit shm_vector_queue(const std::string& name) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        map_and_close(fd, 0);
+    }
+
+    //uses a memfd or a file opened for reading and writing, which is sized and initialised if it is empty
+    //the descriptor remains owned by the caller and may be closed once the queue is constructed
+    shm_vector_queue(int fd, size_t N) {
+        checked_size(N);
+        map(fd, N);
+    }
+
+    //the region itself persists until it is unlinked and every process has unmapped it
+    ~shm_vector_queue() {
+        munmap(_region, _region_size);
+    }
+
+    shm_vector_queue(const shm_vector_queue&) = delete;
+    void operator=(const shm_vector_queue&) = delete;
+
+    //removes the name of a region, processes that have it mapped can keep using it
+    static void unlink(const std::string& name) {
+        shm_unlink(name.c_str());
+    }
+
+    //Completes the single-producer enqueue that a producer process was in the middle of when it died.
+    //Must be called by the next producer before it enqueues, while no other producer is active.
+    void reattach_producer() {
+        uint64_t head_seq = _control->head_seq.load(std::memory_order_relaxed);
+        while ((int64_t)(cell_at(head_seq).seq.load(std::memory_order_acquire) - head_seq) > 0) ++head_seq;
+        _control->head_seq.store(head_seq, std::memory_order_relaxed);
+    }
+
+    //Completes the single-consumer dequeue that a consumer process was in the middle of when it died.
+    //Must be called by the next consumer before it dequeues, while no other consumer is active.
+    void reattach_consumer() {
+        uint64_t tail_seq = _control->tail_seq.load(std::memory_order_relaxed);
+        while ((int64_t)(cell_at(tail_seq).seq.load(std::memory_order_acquire) - tail_seq) > 1) ++tail_seq;
+        _control->tail_seq.store(tail_seq, std::memory_order_release);
+    }
+
+protected:
+    template <typename R>
+    bool sp_enqueue_impl(R&& input) {
+        return sp_emplace_impl(std::forward<R>(input));
+    }
+
+    template <typename R>
+    bool mp_enqueue_impl(R&& input) {
+        return mp_emplace_impl(std::forward<R>(input));
+    }
+
+    //the item is published before the head is advanced, see reattach_producer
+    template <typename... Args>
+    bool sp_emplace_impl(Args&&... args) {
+        uint64_t head_seq = _control->head_seq.load(std::memory_order_relaxed);
+        cell& c = cell_at(head_seq);
+        if (c.seq.load(std::memory_order_acquire) != head_seq) return false;
+        new (&c.storage) T(std::forward<Args>(args)...);
+        c.seq.store(head_seq + 1, std::memory_order_release);
+        _control->head_seq.store(head_seq + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    template <typename... Args>
+    bool mp_emplace_impl(Args&&... args) {
+        while (true) {
+            uint64_t head_seq = _control->head_seq.load(std::memory_order_relaxed);
+            cell& c = cell_at(head_seq);
+            int64_t dif = (int64_t)(c.seq.load(std::memory_order_acquire) - head_seq);
+            if (dif == 0) {
+                if (_control->head_seq.compare_exchange_weak(head_seq, head_seq + 1, std::memory_order_relaxed)) {
+                    new (&c.storage) T(std::forward<Args>(args)...);
+                    c.seq.store(head_seq + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (dif < 0) {
+                return false;
+            }
+        }
+    }
+
+    template <typename IT>
+    size_t sp_enqueue_bulk_impl(IT first, IT last) {
+        size_t count = 0;
+        for (; first != last && sp_emplace_impl(*first); ++first) ++count;
+        return count;
+    }
+
+    template <typename IT>
+    size_t mp_enqueue_bulk_impl(IT first, IT last) {
+        size_t count = 0;
+        for (; first != last && mp_emplace_impl(*first); ++first) ++count;
+        return count;
+    }
+
+    bool sc_dequeue_impl(T& output) {
+        return sc_take(output);
+    }
+
+    bool mc_dequeue_impl(T& output) {
+        return mc_dequeue_one(output);
+    }
+
+    bool mc_dequeue_uncontended_impl(T& output) {
+        uint64_t tail_seq = _control->tail_seq.load(std::memory_order_relaxed);
+        if (cell_at(tail_seq).seq.load(std::memory_order_acquire) != tail_seq + 1) return false;
+        return mc_take(tail_seq, output);
+    }
+
+    template <typename IT>
+    size_t sc_dequeue_bulk_impl(IT output, size_t max) {
+        size_t count = 0;
+        for (; count < max && sc_take(*output); ++output) ++count;
+        return count;
+    }
+
+    template <typename IT>
+    size_t mc_dequeue_bulk_impl(IT output, size_t max) {
+        size_t count = 0;
+        for (; count < max && mc_dequeue_one(*output); ++output) ++count;
+        return count;
+    }
+
+    //the counters are read separately, so the result is clamped to the range of the queue size
+    size_t size_approx_impl() const {
+        uint64_t tail_seq = _control->tail_seq.load(std::memory_order_relaxed);
+        uint64_t head_seq = _control->head_seq.load(std::memory_order_relaxed);
+        return head_seq > tail_seq ? static_cast<size_t>(std::min<uint64_t>(head_seq - tail_seq, _sm1 + 1)) : 0;
+    }
+
+    size_t capacity_impl() const {
+        return _sm1 + 1;
+    }
+
+private:
+    static constexpr uint64_t magic = 0x514e4f434b42ULL; //"BKCONQ"
+    static constexpr uint32_t uninitialised = 0;
+    static constexpr uint32_t initialising = 1;
+    static constexpr uint32_t ready = 2;
+
+    //only fixed width fields, so that the header reads the same in every process
+    struct region_header {
+        std::atomic<uint32_t> state;
+        uint32_t version;
+        uint64_t magic;
+        uint64_t capacity;
+        uint64_t item_size;
+        uint64_t item_align;
+        uint64_t cell_size;
+    };
+
+    struct control_block {
+        region_header header;
+        char _pad0[details::cache_line_size];
+        std::atomic<uint64_t> head_seq;
+        char _pad1[details::cache_line_size];
+        std::atomic<uint64_t> tail_seq;
+        char _pad2[details::cache_line_size];
+    };
+
+    struct cell {
+        std::atomic<uint64_t> seq;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    static constexpr size_t cells_offset() {
+        return (sizeof(control_block) + alignment() - 1) / alignment() * alignment();
+    }
+
+    static constexpr size_t alignment() {
+        return alignof(cell) > details::cache_line_size ? alignof(cell) : details::cache_line_size;
+    }
+
+    static constexpr size_t region_size(size_t N) {
+        return cells_offset() + N * sizeof(cell);
+    }
+
+    static void checked_size(size_t N) {
+        if ((N < 2) || ((N & (~N + 1)) != N)) {
+            throw std::length_error("size of shm_vector_queue must be a power of 2, at least 2");
+        }
+    }
+
+    cell& cell_at(uint64_t seq) const {
+        return _cells[seq & _sm1];
+    }
+
+    //the slot is released before the tail is advanced, see reattach_consumer
+    template <typename R>
+    bool sc_take(R&& output) {
+        uint64_t tail_seq = _control->tail_seq.load(std::memory_order_relaxed);
+        cell& c = cell_at(tail_seq);
+        if (c.seq.load(std::memory_order_acquire) != tail_seq + 1) return false;
+        output = *reinterpret_cast<T*>(&c.storage);
+        c.seq.store(tail_seq + _sm1 + 1, std::memory_order_release);
+        _control->tail_seq.store(tail_seq + 1, std::memory_order_release);
+        return true;
+    }
+
+    //claims the ready slot at tail_seq, returns false if another consumer claimed it first
+    template <typename R>
+    bool mc_take(uint64_t tail_seq, R&& output) {
+        if (!_control->tail_seq.compare_exchange_weak(tail_seq, tail_seq + 1, std::memory_order_relaxed)) return false;
+        cell& c = cell_at(tail_seq);
+        output = *reinterpret_cast<T*>(&c.storage);
+        c.seq.store(tail_seq + _sm1 + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename R>
+    bool mc_dequeue_one(R&& output) {
+        while (true) {
+            uint64_t tail_seq = _control->tail_seq.load(std::memory_order_relaxed);
+            int64_t dif = (int64_t)(cell_at(tail_seq).seq.load(std::memory_order_acquire) - (tail_seq + 1));
+            if (dif == 0) {
+                if (mc_take(tail_seq, output)) return true;
+            }
+            else if (dif < 0) {
+                return false;
+            }
+        }
+    }
+
+    void map_and_close(int fd, size_t N) {
+        try {
+            map(fd, N);
+        }
+        catch (...) {
+            close(fd);
+            throw;
+        }
+        close(fd);
+    }
+
+    //N is 0 when attaching to a region that must already have been created
+    void map(int fd, size_t N) {
+        if (N) {
+            size_t required = region_size(N);
+            if (file_size(fd) < required && ftruncate(fd, required) != 0) {
+                throw std::system_error(errno, std::generic_category(), "ftruncate");
+            }
+        }
+        else if (!wait_for([&]() { return file_size(fd) >= sizeof(control_block); })) {
+            throw std::runtime_error("shm_vector_queue region was not created");
+        }
+        //the header is read first, as an attaching process does not know the number of slots
+        size_t size = N ? region_size(N) : sizeof(control_block);
+        map_region(fd, size);
+        if (N) initialise(N);
+        if (!wait_for([&]() { return _control->header.state.load(std::memory_order_acquire) == ready; })) {
+            munmap(_region, _region_size);
+            throw std::runtime_error("shm_vector_queue region was not initialised");
+        }
+        const region_header& header = _control->header;
+        size_t capacity = static_cast<size_t>(header.capacity);
+        bool valid = header.magic == magic && header.version == version && header.item_size == sizeof(T) &&
+            header.item_align == alignof(T) && header.cell_size == sizeof(cell) && capacity >= 2 &&
+            (capacity & (~capacity + 1)) == capacity && (!N || capacity == N) && file_size(fd) >= region_size(capacity);
+        if (!valid) {
+            munmap(_region, _region_size);
+            throw std::runtime_error("shm_vector_queue region has a different layout");
+        }
+        if (!N) {
+            munmap(_region, _region_size);
+            map_region(fd, region_size(capacity));
+        }
+        _sm1 = capacity - 1;
+        _cells = reinterpret_cast<cell*>(static_cast<char*>(_region) + cells_offset());
+    }
+
+    void map_region(int fd, size_t size) {
+        void* region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (region == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mmap");
+        _region = region;
+        _region_size = size;
+        _control = static_cast<control_block*>(region);
+    }
+
+    //the region is zero filled when it is created, only the first process to attach initialises it
+    void initialise(size_t N) {
+        uint32_t expected = uninitialised;
+        if (!_control->header.state.compare_exchange_strong(expected, initialising, std::memory_order_acq_rel)) return;
+        cell* cells = reinterpret_cast<cell*>(static_cast<char*>(_region) + cells_offset());
+        for (size_t i = 0; i < N; ++i) {
+            new (&cells[i].seq) std::atomic<uint64_t>(i);
+        }
+        new (&_control->head_seq) std::atomic<uint64_t>(0);
+        new (&_control->tail_seq) std::atomic<uint64_t>(0);
+        region_header& header = _control->header;
+        header.version = version;
+        header.magic = magic;
+        header.capacity = N;
+        header.item_size = sizeof(T);
+        header.item_align = alignof(T);
+        header.cell_size = sizeof(cell);
+        header.state.store(ready, std::memory_order_release);
+    }
+
+    static size_t file_size(int fd) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) throw std::system_error(errno, std::generic_category(), "fstat");
+        return static_cast<size_t>(st.st_size);
+    }
+
+    //gives the process creating the region a second to size and initialise it
+    template <typename F>
+    static bool wait_for(F&& condition) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    void* _region{ nullptr };
+    size_t _region_size{ 0 };
+    control_block* _control{ nullptr };
+    cell* _cells{ nullptr };
+    size_t _sm1{ 0 };
+};
+#endif
+} //namespace bk_conq
+
+#endif /* BK_CONQ_SHM_VECTORQUEUE_HPP */
@@ -0,0 +1,248 @@
+/*
+ * File:   spsc_vector_queue.hpp
+ * Author: Barath Kannan
+ * This is a bounded single-producer single-consumer ring buffer. The producer
+ * and consumer each own an index and keep a cached copy of the other's, which is
+ * only reloaded when the ring appears full or empty, so the single-producer and
+ * single-consumer operations use no read-modify-write atomics. Bulk operations
+ * publish a whole batch with a single store. The size of the queue must be a
+ * power of 2.
+ * The multi-producer and multi-consumer operations serialise on a spin lock for
+ * each side, waiting on it with WAIT_STRATEGY, so the queue can also be used as the
+ * subqueue of a multi_bounded_queue. A side declared single (see cardinality.hpp)
+ * has no lock, its multi-threaded operations run the single-threaded algorithm.
+ * Items are constructed in the ring on enqueue and destroyed on dequeue. The
+ * producer can also reserve the next slot, write the item in place and then commit it.
+ * Created on 14 October 2026 11:55 PM
+ */
+
+#ifndef BK_CONQ_SPSC_VECTORQUEUE_HPP
+#define BK_CONQ_SPSC_VECTORQUEUE_HPP
+
+#include <atomic>
+#include <iterator>
+#include <stdexcept>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+#include <bk_conq/bounded_queue.hpp>
+#include <bk_conq/wait_strategy.hpp>
+#include <bk_conq/details/slot_storage.hpp>
+
+namespace bk_conq {
+template<typename T, typename WAIT_STRATEGY = yield_strategy, typename ALLOCATOR = std::allocator<T>, producers P = producers::multi, consumers C = consumers::multi>
+class spsc_vector_queue : public bounded_queue<T, spsc_vector_queue<T, WAIT_STRATEGY, ALLOCATOR, P, C>, P, C> {
+    friend bounded_queue<T, spsc_vector_queue<T, WAIT_STRATEGY, ALLOCATOR, P, C>, P, C>;
+public:
+    spsc_vector_queue(size_t N, const ALLOCATOR& allocator = ALLOCATOR()) : _data(checked_size(N), allocator), _sm1(N - 1) {}
+
+    //items still in the queue are destroyed, no operations may be in progress
+    ~spsc_vector_queue() {
+        size_t head = _head.load(std::memory_order_relaxed);
+        for (size_t tail = _tail.load(std::memory_order_relaxed); tail != head; ++tail) {
+            _data[tail & _sm1].destroy();
+        }
+    }
+
+    spsc_vector_queue(const spsc_vector_queue&) = delete;
+    void operator=(const spsc_vector_queue&) = delete;
+
+    //the next slot of the ring holding an item that has not yet been published to the consumer
+    class write_reservation {
+    public:
+        write_reservation() = default;
+
+        explicit operator bool() const {
+            return _item != nullptr;
+        }
+
+        T& operator*() const {
+            return *_item;
+        }
+
+        T* operator->() const {
+            return _item;
+        }
+
+    private:
+        friend spsc_vector_queue;
+        write_reservation(T* item, size_t head) : _item(item), _head(head) {}
+
+        T* _item{ nullptr };
+        size_t _head{ 0 };
+    };
+
+    //Constructs an item from args in the next slot, so that the producer can write the item in place before
+    //publishing it with commit. Returns an empty reservation if the queue is full. Only the single producer
+    //may reserve, and it must commit each reservation before making the next.
+    template <typename... Args>
+    write_reservation sp_try_reserve_write(Args&&... args) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _cached_tail > _sm1) {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            if (head - _cached_tail > _sm1) return write_reservation();
+        }
+        _data[head & _sm1].construct(std::forward<Args>(args)...);
+        return write_reservation(&_data[head & _sm1].get(), head);
+    }
+
+    void commit(const write_reservation& reservation) {
+        _head.store(reservation._head + 1, std::memory_order_release);
+    }
+
+protected:
+    template <typename R>
+    bool sp_enqueue_impl(R&& input) {
+        return sp_emplace_impl(std::forward<R>(input));
+    }
+
+    template <typename R>
+    bool mp_enqueue_impl(R&& input) {
+        return mp_emplace_impl(std::forward<R>(input));
+    }
+
+    template <typename... Args>
+    bool sp_emplace_impl(Args&&... args) {
+        write_reservation reservation = sp_try_reserve_write(std::forward<Args>(args)...);
+        if (!reservation) return false;
+        commit(reservation);
+        return true;
+    }
+
+    template <typename... Args>
+    bool mp_emplace_impl(Args&&... args) {
+        lock_guard lock(_producer_lock);
+        return sp_emplace_impl(std::forward<Args>(args)...);
+    }
+
+    template <typename IT>
+    size_t sp_enqueue_bulk_impl(IT first, IT last) {
+        size_t requested = std::distance(first, last);
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t count = std::min(requested, _sm1 + 1 - (head - _cached_tail));
+        if (count < requested) {
+            _cached_tail = _tail.load(std::memory_order_acquire);
+            count = std::min(requested, _sm1 + 1 - (head - _cached_tail));
+        }
+        for (size_t i = 0; i < count; ++i, ++first) {
+            _data[(head + i) & _sm1].construct(*first);
+        }
+        if (count) _head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    template <typename IT>
+    size_t mp_enqueue_bulk_impl(IT first, IT last) {
+        lock_guard lock(_producer_lock);
+        return sp_enqueue_bulk_impl(first, last);
+    }
+
+    bool sc_dequeue_impl(T& output) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _cached_head) {
+            _cached_head = _head.load(std::memory_order_acquire);
+            if (tail == _cached_head) return false;
+        }
+        _data[tail & _sm1].move_to(output);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool mc_dequeue_impl(T& output) {
+        lock_guard lock(_consumer_lock);
+        return sc_dequeue_impl(output);
+    }
+
+    //gives up rather than waiting when another consumer holds the lock
+    bool mc_dequeue_uncontended_impl(T& output) {
+        if (_consumer_lock.exchange(true, std::memory_order_acquire)) return false;
+        bool ret = sc_dequeue_impl(output);
+        _consumer_lock.store(false, std::memory_order_release);
+        return ret;
+    }
+
+    template <typename IT>
+    size_t sc_dequeue_bulk_impl(IT output, size_t max) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t count = std::min(max, _cached_head - tail);
+        if (count < max) {
+            _cached_head = _head.load(std::memory_order_acquire);
+            count = std::min(max, _cached_head - tail);
+        }
+        for (size_t i = 0; i < count; ++i, ++output) {
+            _data[(tail + i) & _sm1].move_to(*output);
+        }
+        if (count) _tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    template <typename IT>
+    size_t mc_dequeue_bulk_impl(IT output, size_t max) {
+        lock_guard lock(_consumer_lock);
+        return sc_dequeue_bulk_impl(output, max);
+    }
+
+    //the counters are read separately, so the result is clamped to the range of the queue size
+    size_t size_approx_impl() const {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t head = _head.load(std::memory_order_relaxed);
+        return head > tail ? std::min(head - tail, _sm1 + 1) : 0;
+    }
+
+    size_t capacity_impl() const {
+        return _sm1 + 1;
+    }
+
+private:
+    class lock_guard {
+    public:
+        explicit lock_guard(std::atomic<bool>& lock) : _lock(lock) {
+            WAIT_STRATEGY strategy;
+            while (_lock.exchange(true, std::memory_order_acquire)) {
+                while (_lock.load(std::memory_order_relaxed)) strategy.wait();
+            }
+        }
+
+        ~lock_guard() {
+            _lock.store(false, std::memory_order_release);
+        }
+
+        lock_guard(const lock_guard&) = delete;
+        void operator=(const lock_guard&) = delete;
+
+    private:
+        std::atomic<bool>& _lock;
+    };
+
+    //stands in for the lock of a side declared single, the operations that take the lock are never instantiated
+    class no_lock {
+    public:
+        no_lock(bool) {}
+    };
+
+    typedef std::conditional_t<P == producers::multi, std::atomic<bool>, no_lock> producer_lock_t;
+    typedef std::conditional_t<C == consumers::multi, std::atomic<bool>, no_lock> consumer_lock_t;
+
+    static size_t checked_size(size_t N) {
+        if ((N == 0) || ((N & (~N + 1)) != N)) {
+            throw std::length_error("size of spsc_vector_queue must be power of 2");
+        }
+        return N;
+    }
+
+    details::aligned_array<details::uninitialized<T>, ALLOCATOR> _data;
+    const size_t _sm1;
+    //the producer's and the consumer's state are kept on separate cache lines
+    char _pad0[details::cache_line_size];
+    std::atomic<size_t> _head{ 0 };
+    size_t _cached_tail{ 0 };
+    producer_lock_t _producer_lock{ false };
+    char _pad1[details::cache_line_size];
+    std::atomic<size_t> _tail{ 0 };
+    size_t _cached_head{ 0 };
+    consumer_lock_t _consumer_lock{ false };
+    char _pad2[details::cache_line_size];
+};
+} //namespace bk_conq
+
+#endif /* BK_CONQ_SPSC_VECTORQUEUE_HPP */
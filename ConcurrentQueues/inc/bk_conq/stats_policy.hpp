@@ -0,0 +1,127 @@
+/*
+* File:   stats_policy.hpp
+* Author: Barath Kannan
+* Statistics policies for the queues and multi queues that take a STATS template
+* parameter. A statistics policy provides add(stat, n), which is called on the hot
+* path of the queue, and collect(), which sums the counters on demand.
+* no_stats is the default and compiles away. sharded_stats keeps a cache line of
+* counters per shard, and each thread updates the shard it was given on first use,
+* so threads only contend on a counter when there are more threads than SHARDS.
+* Created on 14 October 2026 11:59 PM
+*/
+
+#ifndef BK_CONQ_STATS_POLICY_HPP
+#define BK_CONQ_STATS_POLICY_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <bk_conq/details/slot_storage.hpp>
+
+namespace bk_conq {
+
+//enqueues, dequeues: items enqueued and dequeued
+//cas_retries: failed compare and swap operations that were retried
+//contention_spins: waits on, or operations abandoned because of, an end of the queue held by another thread
+//empty_failures, full_failures: dequeues that found the queue empty, enqueues that found it full
+//allocations, freelist_hits: storage obtained from the allocator, and recycled from the freelist instead
+//hitlist_reorders: subqueues promoted to the front of a consumer's hit list
+enum class queue_stat : size_t {
+    enqueues,
+    dequeues,
+    cas_retries,
+    contention_spins,
+    empty_failures,
+    full_failures,
+    allocations,
+    freelist_hits,
+    hitlist_reorders
+};
+
+static constexpr size_t queue_stat_count = static_cast<size_t>(queue_stat::hitlist_reorders) + 1;
+
+//a snapshot of the counters, counters not updated by a queue are left at 0
+class queue_stats {
+public:
+    size_t& operator[](queue_stat stat) {
+        return _counters[static_cast<size_t>(stat)];
+    }
+
+    size_t operator[](queue_stat stat) const {
+        return _counters[static_cast<size_t>(stat)];
+    }
+
+    queue_stats& operator+=(const queue_stats& other) {
+        for (size_t i = 0; i < queue_stat_count; ++i) _counters[i] += other._counters[i];
+        return *this;
+    }
+
+private:
+    std::array<size_t, queue_stat_count> _counters{};
+};
+
+class no_stats {
+public:
+    static constexpr bool enabled = false;
+
+    void add(queue_stat, size_t = 1) {}
+
+    queue_stats collect() const {
+        return queue_stats();
+    }
+};
+
+template <size_t SHARDS = 64>
+class sharded_stats {
+    static_assert(SHARDS > 0, "SHARDS must be greater than 0");
+public:
+    static constexpr bool enabled = true;
+
+    void add(queue_stat stat, size_t n = 1) {
+        _shards[shard_index()].counters[static_cast<size_t>(stat)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    //the shards are read while they may be updated, so the snapshot is not taken at a single point in time
+    queue_stats collect() const {
+        queue_stats stats;
+        for (const shard& s : _shards) {
+            for (size_t i = 0; i < queue_stat_count; ++i) {
+                stats[static_cast<queue_stat>(i)] += s.counters[i].load(std::memory_order_relaxed);
+            }
+        }
+        return stats;
+    }
+
+private:
+    struct shard {
+        std::array<std::atomic<size_t>, queue_stat_count> counters{};
+        char _pad[details::cache_line_size];
+    };
+
+    //threads are given shards in the order they first update any sharded_stats
+    static size_t shard_index() {
+        static std::atomic<size_t> next{ 0 };
+        thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+        return index;
+    }
+
+    std::array<shard, SHARDS> _shards;
+};
+
+namespace details {
+
+//the statistics of a queue that has no STATS parameter are empty
+template <typename Q>
+auto stats_of(const Q& q, int) -> decltype(q.stats()) {
+    return q.stats();
+}
+
+template <typename Q>
+queue_stats stats_of(const Q&, long) {
+    return queue_stats();
+}
+
+}//namespace details
+}//namespace bk_conq
+
+#endif // BK_CONQ_STATS_POLICY_HPP
@@ -7,6 +7,16 @@
  * Vyukov's bounded queue and should be used whenever an unbounded queue is not
  * necessary, as it will generally have much better cache locality. The size of
  * the queue must be a power of 2.
+ * LAYOUT selects how slots are laid out in memory (see slot_layout). With
+ * SCRAMBLE, consecutive tickets are mapped to slots on different cache lines
+ * when the queue holds at least as many slots as the square of the number of
+ * sequence numbers that share a cache line.
+ * Slot storage is obtained from ALLOCATOR, see page_allocator for huge page and
+ * NUMA aware storage.
+ * STATS selects whether operations are counted (see stats_policy.hpp).
+ * Items are constructed in their slot on enqueue and destroyed on dequeue, so T
+ * need not be default constructible or copyable. A producer can also reserve a
+ * slot, write the item in place and then commit it.
  * Created on 3 September 2016, 2:49 PM
  */
 
@@ -14,112 +24,372 @@
 #define BK_CONQ_VECTORQUEUE_HPP
 
 #include <atomic>
+#include <iterator>
 #include <type_traits>
-#include <vector>
 #include <stdexcept>
+#include <memory>
+#include <algorithm>
 #include <bk_conq/bounded_queue.hpp>
+#include <bk_conq/stats_policy.hpp>
+#include <bk_conq/details/slot_storage.hpp>
 
 namespace bk_conq {
-template<typename T>
-class vector_queue : public bounded_queue<T, vector_queue<T>> {
-    friend bounded_queue<T, vector_queue<T>>;
+template<typename T, slot_layout LAYOUT = slot_layout::packed, bool SCRAMBLE = false, typename ALLOCATOR = std::allocator<T>, typename STATS = no_stats, producers P = producers::multi, consumers C = consumers::multi>
+class vector_queue : public bounded_queue<T, vector_queue<T, LAYOUT, SCRAMBLE, ALLOCATOR, STATS, P, C>, P, C>, private STATS {
+    friend bounded_queue<T, vector_queue<T, LAYOUT, SCRAMBLE, ALLOCATOR, STATS, P, C>, P, C>;
 public:
 
-    vector_queue(size_t N) : _buffer(N), _sm1(N - 1) {
-        if ((N == 0) || ((N & (~N + 1)) != N)) {
-            throw std::length_error("size of vector_queue must be power of 2");
-        }
+    vector_queue(size_t N, const ALLOCATOR& allocator = ALLOCATOR()) : _slots(checked_size(N), allocator), _sm1(N - 1), _scramble_shift(scramble_shift(N)) {
         for (size_t i = 0; i < N; ++i) {
-            _buffer[i].seq.store(i, std::memory_order_relaxed);
+            _slots.seq(slot(i)).store(i, std::memory_order_relaxed);
+        }
+    }
+
+    //items still in the queue are destroyed, no operations may be in progress
+    ~vector_queue() {
+        size_t head_seq = _head_seq.load(std::memory_order_relaxed);
+        for (size_t seq = _tail_seq.load(std::memory_order_relaxed); seq != head_seq; ++seq) {
+            _slots.data(slot(seq)).destroy();
         }
     }
 
     vector_queue(const vector_queue&) = delete;
     void operator=(const vector_queue&) = delete;
 
-protected:
-    template <typename R>
-    bool sp_enqueue_impl(R&& input) {
+    queue_stats stats() const {
+        return STATS::collect();
+    }
+
+    //a claimed slot holding an item that has not yet been published to consumers
+    class write_reservation {
+    public:
+        write_reservation() = default;
+
+        explicit operator bool() const {
+            return _item != nullptr;
+        }
+
+        T& operator*() const {
+            return *_item;
+        }
+
+        T* operator->() const {
+            return _item;
+        }
+
+    private:
+        friend vector_queue;
+        write_reservation(T* item, size_t seq) : _item(item), _seq(seq) {}
+
+        T* _item{ nullptr };
+        size_t _seq{ 0 };
+    };
+
+    //Claims the next slot and constructs an item in it from args, so that a producer can write the item in
+    //place before publishing it with commit. Returns an empty reservation if the queue is full. Every
+    //reservation must be committed, consumers reaching an uncommitted slot find the queue empty until it is.
+    template <typename... Args>
+    write_reservation sp_try_reserve_write(Args&&... args) {
         size_t head_seq = _head_seq.load(std::memory_order_relaxed);
-        node_t& node = _buffer[head_seq & (_sm1)];
-        size_t node_seq = node.seq.load(std::memory_order_acquire);
-        intptr_t dif = (intptr_t)node_seq - (intptr_t)head_seq;
-        if (dif == 0 && _head_seq.compare_exchange_strong(head_seq, head_seq + 1, std::memory_order_relaxed)) {
-            node.data = std::forward<R>(input);
-            node.seq.store(head_seq + 1, std::memory_order_release);
+        size_t indx = slot(head_seq);
+        size_t node_seq = _slots.seq(indx).load(std::memory_order_acquire);
+        //with a single producer the slot can only be full, so the head needs no read-modify-write
+        if (node_seq != head_seq) {
+            STATS::add(queue_stat::full_failures);
+            return write_reservation();
         }
-        return false;
+        _head_seq.store(head_seq + 1, std::memory_order_relaxed);
+        _slots.data(indx).construct(std::forward<Args>(args)...);
+        return write_reservation(&_slots.data(indx).get(), head_seq);
     }
 
-    template <typename R>
-    bool mp_enqueue_impl(R&& input) {
+    template <typename... Args>
+    write_reservation mp_try_reserve_write(Args&&... args) {
         while (true) {
             size_t head_seq = _head_seq.load(std::memory_order_relaxed);
-            node_t& node = _buffer[head_seq & (_sm1)];
-            size_t node_seq = node.seq.load(std::memory_order_acquire);
+            size_t indx = slot(head_seq);
+            size_t node_seq = _slots.seq(indx).load(std::memory_order_acquire);
             intptr_t dif = (intptr_t)node_seq - (intptr_t)head_seq;
             if (dif == 0) {
                 if (_head_seq.compare_exchange_weak(head_seq, head_seq + 1, std::memory_order_relaxed)) {
-                    node.data = std::forward<R>(input);
-                    node.seq.store(head_seq + 1, std::memory_order_release);
-                    return true;
+                    _slots.data(indx).construct(std::forward<Args>(args)...);
+                    return write_reservation(&_slots.data(indx).get(), head_seq);
                 }
+                STATS::add(queue_stat::cas_retries);
             }
             else if (dif < 0) {
-                return false;
+                STATS::add(queue_stat::full_failures);
+                return write_reservation();
+            }
+            else {
+                //another producer has claimed the slot since the head was loaded
+                STATS::add(queue_stat::contention_spins);
+            }
+        }
+    }
+
+    //publishes the item of a reservation made by either producer operation
+    void commit(const write_reservation& reservation) {
+        _slots.seq(slot(reservation._seq)).store(reservation._seq + 1, std::memory_order_release);
+        STATS::add(queue_stat::enqueues);
+    }
+
+protected:
+    template <typename R>
+    bool sp_enqueue_impl(R&& input) {
+        return sp_emplace_impl(std::forward<R>(input));
+    }
+
+    template <typename R>
+    bool mp_enqueue_impl(R&& input) {
+        return mp_emplace_impl(std::forward<R>(input));
+    }
+
+    template <typename... Args>
+    bool sp_emplace_impl(Args&&... args) {
+        write_reservation reservation = sp_try_reserve_write(std::forward<Args>(args)...);
+        if (!reservation) return false;
+        commit(reservation);
+        return true;
+    }
+
+    template <typename... Args>
+    bool mp_emplace_impl(Args&&... args) {
+        write_reservation reservation = mp_try_reserve_write(std::forward<Args>(args)...);
+        if (!reservation) return false;
+        commit(reservation);
+        return true;
+    }
+
+    //claims the longest run of free slots (up to the size of the range) with a single operation on _head_seq
+    template <typename IT>
+    size_t sp_enqueue_bulk_impl(IT first, IT last) {
+        size_t head_seq = _head_seq.load(std::memory_order_relaxed);
+        size_t count = free_run(head_seq, std::distance(first, last));
+        if (count == 0) {
+            STATS::add(queue_stat::full_failures);
+            return 0;
+        }
+        _head_seq.store(head_seq + count, std::memory_order_relaxed);
+        publish_run(head_seq, count, first);
+        STATS::add(queue_stat::enqueues, count);
+        return count;
+    }
+
+    template <typename IT>
+    size_t mp_enqueue_bulk_impl(IT first, IT last) {
+        size_t requested = std::distance(first, last);
+        if (requested == 0) return 0;
+        size_t head_seq = _head_seq.load(std::memory_order_relaxed);
+        size_t count;
+        while (true) {
+            count = free_run(head_seq, requested);
+            if (count == 0) {
+                intptr_t dif = (intptr_t)_slots.seq(slot(head_seq)).load(std::memory_order_acquire) - (intptr_t)head_seq;
+                if (dif < 0) {
+                    STATS::add(queue_stat::full_failures);
+                    return 0;
+                }
+                //another producer has claimed the slot since the head was loaded
+                STATS::add(queue_stat::contention_spins);
+                head_seq = _head_seq.load(std::memory_order_relaxed);
+                continue;
             }
+            if (_head_seq.compare_exchange_weak(head_seq, head_seq + count, std::memory_order_relaxed)) break;
+            STATS::add(queue_stat::cas_retries);
         }
+        publish_run(head_seq, count, first);
+        STATS::add(queue_stat::enqueues, count);
+        return count;
     }
 
     bool sc_dequeue_impl(T& data) {
         size_t tail_seq = _tail_seq.load(std::memory_order_relaxed);
-        node_t& node = _buffer[tail_seq & (_sm1)];
-        size_t node_seq = node.seq.load(std::memory_order_acquire);
-        intptr_t dif = (intptr_t)node_seq - (intptr_t)(tail_seq + 1);
-        if (dif == 0 && _tail_seq.compare_exchange_strong(tail_seq, tail_seq + 1, std::memory_order_relaxed)) {
-            data = std::move(node.data);
-            node.seq.store(tail_seq + _sm1 + 1, std::memory_order_release);
-            return true;
+        size_t indx = slot(tail_seq);
+        size_t node_seq = _slots.seq(indx).load(std::memory_order_acquire);
+        //with a single consumer the slot can only be empty, so the tail needs no read-modify-write
+        if (node_seq != tail_seq + 1) {
+            STATS::add(queue_stat::empty_failures);
+            return false;
         }
-        return false;
+        _tail_seq.store(tail_seq + 1, std::memory_order_relaxed);
+        _slots.data(indx).move_to(data);
+        _slots.seq(indx).store(tail_seq + _sm1 + 1, std::memory_order_release);
+        STATS::add(queue_stat::dequeues);
+        return true;
     }
 
     bool mc_dequeue_impl(T& data) {
         while (true) {
             size_t tail_seq = _tail_seq.load(std::memory_order_relaxed);
-            node_t& node = _buffer[tail_seq & (_sm1)];
-            size_t node_seq = node.seq.load(std::memory_order_acquire);
+            size_t indx = slot(tail_seq);
+            size_t node_seq = _slots.seq(indx).load(std::memory_order_acquire);
             intptr_t dif = (intptr_t)node_seq - (intptr_t)(tail_seq + 1);
             if (dif == 0) {
                 if (_tail_seq.compare_exchange_weak(tail_seq, tail_seq + 1, std::memory_order_relaxed)) {
-                    data = std::move(node.data);
-                    node.seq.store(tail_seq + _sm1 + 1, std::memory_order_release);
+                    _slots.data(indx).move_to(data);
+                    _slots.seq(indx).store(tail_seq + _sm1 + 1, std::memory_order_release);
+                    STATS::add(queue_stat::dequeues);
                     return true;
                 }
+                STATS::add(queue_stat::cas_retries);
             }
             else if (dif < 0) {
+                STATS::add(queue_stat::empty_failures);
                 return false;
             }
+            else {
+                //another consumer has claimed the slot since the tail was loaded
+                STATS::add(queue_stat::contention_spins);
+            }
         }
     }
 
+    //a single attempt, another consumer may have taken the slot
     bool mc_dequeue_uncontended_impl(T& data) {
-        return this->sc_dequeue(data);
+        size_t tail_seq = _tail_seq.load(std::memory_order_relaxed);
+        size_t indx = slot(tail_seq);
+        size_t node_seq = _slots.seq(indx).load(std::memory_order_acquire);
+        intptr_t dif = (intptr_t)node_seq - (intptr_t)(tail_seq + 1);
+        if (dif == 0 && _tail_seq.compare_exchange_strong(tail_seq, tail_seq + 1, std::memory_order_relaxed)) {
+            _slots.data(indx).move_to(data);
+            _slots.seq(indx).store(tail_seq + _sm1 + 1, std::memory_order_release);
+            STATS::add(queue_stat::dequeues);
+            return true;
+        }
+        STATS::add(dif < 0 ? queue_stat::empty_failures : queue_stat::contention_spins);
+        return false;
+    }
+
+    //claims the longest run of published slots (up to max) with a single operation on _tail_seq
+    template <typename IT>
+    size_t sc_dequeue_bulk_impl(IT output, size_t max) {
+        size_t tail_seq = _tail_seq.load(std::memory_order_relaxed);
+        size_t count = ready_run(tail_seq, max);
+        if (count == 0) {
+            STATS::add(queue_stat::empty_failures);
+            return 0;
+        }
+        _tail_seq.store(tail_seq + count, std::memory_order_relaxed);
+        consume_run(tail_seq, count, output);
+        STATS::add(queue_stat::dequeues, count);
+        return count;
+    }
+
+    template <typename IT>
+    size_t mc_dequeue_bulk_impl(IT output, size_t max) {
+        if (max == 0) return 0;
+        size_t tail_seq = _tail_seq.load(std::memory_order_relaxed);
+        size_t count;
+        while (true) {
+            count = ready_run(tail_seq, max);
+            if (count == 0) {
+                intptr_t dif = (intptr_t)_slots.seq(slot(tail_seq)).load(std::memory_order_acquire) - (intptr_t)(tail_seq + 1);
+                if (dif < 0) {
+                    STATS::add(queue_stat::empty_failures);
+                    return 0;
+                }
+                //another consumer has claimed the slot since the tail was loaded
+                STATS::add(queue_stat::contention_spins);
+                tail_seq = _tail_seq.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (_tail_seq.compare_exchange_weak(tail_seq, tail_seq + count, std::memory_order_relaxed)) break;
+            STATS::add(queue_stat::cas_retries);
+        }
+        consume_run(tail_seq, count, output);
+        STATS::add(queue_stat::dequeues, count);
+        return count;
+    }
+
+    //claimed slots are counted, their items may still be in the process of being enqueued or dequeued
+    //the counters are read separately, so the result is clamped to the range of the queue size
+    size_t size_approx_impl() const {
+        size_t tail_seq = _tail_seq.load(std::memory_order_relaxed);
+        size_t head_seq = _head_seq.load(std::memory_order_relaxed);
+        return head_seq > tail_seq ? std::min(head_seq - tail_seq, _sm1 + 1) : 0;
+    }
+
+    size_t capacity_impl() const {
+        return _sm1 + 1;
     }
 
 private:
-    struct node_t {
-        T                     data;
-        std::atomic<size_t>   seq;
-    };
+    static constexpr size_t log2(size_t n) {
+        return n < 2 ? 0 : 1 + log2(n / 2);
+    }
+
+    //number of bits used to index sequence numbers within a cache line
+    static constexpr size_t line_bits = log2(details::cache_line_size / details::slot_storage<T, LAYOUT, ALLOCATOR>::seq_stride);
+
+    static size_t checked_size(size_t N) {
+        if ((N == 0) || ((N & (~N + 1)) != N)) {
+            throw std::length_error("size of vector_queue must be power of 2");
+        }
+        return N;
+    }
+
+    static size_t scramble_shift(size_t N) {
+        return (SCRAMBLE && line_bits > 0 && log2(N) >= 2 * line_bits) ? line_bits : 0;
+    }
+
+    //maps a ticket to a slot, scrambling swaps the low line_bits of the index with the line_bits above them
+    size_t slot(size_t seq) const {
+        size_t indx = seq & _sm1;
+        if (!SCRAMBLE || !_scramble_shift) return indx;
+        size_t mix = (indx ^ (indx >> _scramble_shift)) & ((size_t(1) << _scramble_shift) - 1);
+        return indx ^ mix ^ (mix << _scramble_shift);
+    }
+
+    //number of consecutive slots from head_seq that are free for this lap, up to max
+    size_t free_run(size_t head_seq, size_t max) {
+        size_t count = 0;
+        while (count < max && count <= _sm1 &&
+            _slots.seq(slot(head_seq + count)).load(std::memory_order_acquire) == head_seq + count) {
+            ++count;
+        }
+        return count;
+    }
+
+    //number of consecutive slots from tail_seq that have been published, up to max
+    size_t ready_run(size_t tail_seq, size_t max) {
+        size_t count = 0;
+        while (count < max && count <= _sm1 &&
+            _slots.seq(slot(tail_seq + count)).load(std::memory_order_acquire) == tail_seq + count + 1) {
+            ++count;
+        }
+        return count;
+    }
+
+    //slots identified by free_run stay free until claimed, so they can be written without further checks
+    template <typename IT>
+    void publish_run(size_t head_seq, size_t count, IT first) {
+        for (size_t i = 0; i < count; ++i, ++first) {
+            size_t indx = slot(head_seq + i);
+            _slots.data(indx).construct(*first);
+            _slots.seq(indx).store(head_seq + i + 1, std::memory_order_release);
+        }
+    }
+
+    template <typename IT>
+    void consume_run(size_t tail_seq, size_t count, IT output) {
+        for (size_t i = 0; i < count; ++i, ++output) {
+            size_t indx = slot(tail_seq + i);
+            _slots.data(indx).move_to(*output);
+            _slots.seq(indx).store(tail_seq + i + _sm1 + 1, std::memory_order_release);
+        }
+    }
 
-    std::vector<node_t> _buffer;
-    char _pad0[64];
+    details::slot_storage<T, LAYOUT, ALLOCATOR> _slots;
+    //a full cache line of padding on either side keeps each counter on its own line
+    //regardless of where the queue itself is allocated
+    char _pad0[details::cache_line_size];
     std::atomic<size_t> _head_seq{ 0 };
-    char _pad1[64];
+    char _pad1[details::cache_line_size];
     std::atomic<size_t> _tail_seq{ 0 };
-    char _pad2[64];
+    char _pad2[details::cache_line_size];
     const size_t _sm1;
+    const size_t _scramble_shift;
 };
 } //namespace bk_conq
 
@@ -0,0 +1,173 @@
+/*
+* File:   wait_policy.hpp
+* Author: Barath Kannan
+* Wait policies used by the blocking queue adapters to park threads until an
+* operation can make progress.
+* A wait policy provides wait(op), which returns once op() has returned true,
+* wait_until(op, deadline), which also gives up at the deadline and returns
+* the result of the final op(), and notify_one()/notify_all(), which are
+* called after the state that op observes has been changed.
+* Created on 14 October 2026 11:05 AM
+*/
+
+#ifndef BK_CONQ_WAIT_POLICY_HPP
+#define BK_CONQ_WAIT_POLICY_HPP
+
+#include <bk_conq/details/futex.hpp>
+#include <bk_conq/wait_strategy.hpp>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+
+namespace bk_conq {
+
+//result of a blocking operation on a blocking adapter
+enum class queue_status {
+    success,
+    timeout,
+    closed
+};
+
+//parks on a condition variable, every notification takes the mutex
+class condition_variable_wait_policy {
+public:
+    template <typename F>
+    void wait(F&& op) {
+        if (op()) return;
+        std::unique_lock<std::mutex> lock(_m);
+        while (!op()) {
+            _cv.wait(lock);
+        }
+    }
+
+    template <typename F, typename Clock, typename Duration>
+    bool wait_until(F&& op, const std::chrono::time_point<Clock, Duration>& deadline) {
+        if (op()) return true;
+        std::unique_lock<std::mutex> lock(_m);
+        while (!op()) {
+            if (_cv.wait_until(lock, deadline) == std::cv_status::timeout) return op();
+        }
+        return true;
+    }
+
+    void notify_one() {
+        { std::lock_guard<std::mutex> lock(_m); }
+        _cv.notify_one();
+    }
+
+    void notify_all() {
+        { std::lock_guard<std::mutex> lock(_m); }
+        _cv.notify_all();
+    }
+
+private:
+    std::mutex _m;
+    std::condition_variable _cv;
+};
+
+//retries op with STRATEGY between attempts and never sleeps in the kernel, so notifications are free
+template <typename STRATEGY = backoff_strategy<>>
+class spin_wait_policy {
+public:
+    template <typename F>
+    void wait(F&& op) {
+        STRATEGY strategy;
+        while (!op()) {
+            strategy.wait();
+        }
+    }
+
+    template <typename F, typename Clock, typename Duration>
+    bool wait_until(F&& op, const std::chrono::time_point<Clock, Duration>& deadline) {
+        STRATEGY strategy;
+        while (!op()) {
+            if (Clock::now() >= deadline) return op();
+            strategy.wait();
+        }
+        return true;
+    }
+
+    void notify_one() {}
+
+    void notify_all() {}
+};
+
+//retries op SPIN_COUNT times, waiting with SPIN_STRATEGY between attempts,
+//before registering as a waiter and parking on a futex
+//notifications only bump the epoch and touch the kernel when a waiter is registered
+template <size_t SPIN_COUNT = 128, typename SPIN_STRATEGY = busy_spin_strategy>
+class eventcount_wait_policy {
+public:
+    template <typename F>
+    void wait(F&& op) {
+        wait_impl(op, [this](uint32_t epoch) {
+            _epoch.wait(epoch);
+            return true;
+        });
+    }
+
+    template <typename F, typename Clock, typename Duration>
+    bool wait_until(F&& op, const std::chrono::time_point<Clock, Duration>& deadline) {
+        return wait_impl(op, [this, &deadline](uint32_t epoch) {
+            auto now = Clock::now();
+            if (now >= deadline) return false;
+            _epoch.wait_for(epoch, std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now));
+            return true;
+        });
+    }
+
+    void notify_one() {
+        if (has_waiters()) {
+            _epoch.fetch_add(1, std::memory_order_release);
+            _epoch.wake_one();
+        }
+    }
+
+    void notify_all() {
+        if (has_waiters()) {
+            _epoch.fetch_add(1, std::memory_order_release);
+            _epoch.wake_all();
+        }
+    }
+
+private:
+    //park(epoch) sleeps until the epoch moves on, or returns false to give up
+    template <typename F, typename P>
+    bool wait_impl(F& op, P&& park) {
+        SPIN_STRATEGY strategy;
+        for (size_t i = 0; i < SPIN_COUNT; ++i) {
+            if (op()) return true;
+            strategy.wait();
+        }
+        while (true) {
+            _waiters.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint32_t epoch = _epoch.load(std::memory_order_acquire);
+            if (op()) {
+                _waiters.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            bool parked = park(epoch);
+            _waiters.fetch_sub(1, std::memory_order_relaxed);
+            if (op()) return true;
+            if (!parked) return false;
+        }
+    }
+
+    //pairs with the fence in wait_impl, so either the notifier sees the waiter
+    //or the waiter's retry of op sees the notifier's change
+    bool has_waiters() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return _waiters.load(std::memory_order_relaxed) != 0;
+    }
+
+    details::futex _epoch;
+    std::atomic<uint32_t> _waiters{ 0 };
+};
+
+}//namespace bk_conq
+
+#endif // BK_CONQ_WAIT_POLICY_HPP
@@ -0,0 +1,99 @@
+/*
+* File:   wait_strategy.hpp
+* Author: Barath Kannan
+* Strategies for waiting between retries of a contended or unsuccessful operation.
+* A strategy is constructed at the start of a wait and wait() is called after
+* each failed attempt, so stateful strategies back off across calls.
+* The base queues take a strategy for their internal contention spins, and
+* spin_wait_policy applies a strategy to the blocking adapters.
+* Created on 14 October 2026 2:40 PM
+*/
+
+#ifndef BK_CONQ_WAIT_STRATEGY_HPP
+#define BK_CONQ_WAIT_STRATEGY_HPP
+
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstddef>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace bk_conq {
+namespace details {
+
+//hints to the processor that this is a spin loop
+inline void cpu_relax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(_MSC_VER) && (defined(_M_ARM) || defined(_M_ARM64))
+    __yield();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+}//namespace details
+
+//spins on the cpu without giving up the time slice
+class busy_spin_strategy {
+public:
+    void wait() {
+        details::cpu_relax();
+    }
+};
+
+//gives up the time slice on every retry
+class yield_strategy {
+public:
+    void wait() {
+        std::this_thread::yield();
+    }
+};
+
+//spins for an exponentially increasing number of iterations, yielding once MAX_SPINS is reached
+template <size_t MAX_SPINS = 1024>
+class backoff_strategy {
+public:
+    void wait() {
+        if (_spins > MAX_SPINS) {
+            std::this_thread::yield();
+            return;
+        }
+        for (size_t i = 0; i < _spins; ++i) {
+            details::cpu_relax();
+        }
+        _spins *= 2;
+    }
+
+private:
+    size_t _spins{ 1 };
+};
+
+//sleeps, starting at MIN_NANOSECONDS and doubling up to MAX_NANOSECONDS
+template <size_t MIN_NANOSECONDS = 1000, size_t MAX_NANOSECONDS = 1000000>
+class park_strategy {
+    static_assert(MIN_NANOSECONDS > 0 && MIN_NANOSECONDS <= MAX_NANOSECONDS, "park_strategy requires 0 < MIN_NANOSECONDS <= MAX_NANOSECONDS");
+public:
+    void wait() {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(_sleep));
+        if (_sleep < MAX_NANOSECONDS) {
+            _sleep = (_sleep > MAX_NANOSECONDS / 2) ? MAX_NANOSECONDS : _sleep * 2;
+        }
+    }
+
+private:
+    size_t _sleep{ MIN_NANOSECONDS };
+};
+
+}//namespace bk_conq
+
+#endif // BK_CONQ_WAIT_STRATEGY_HPP
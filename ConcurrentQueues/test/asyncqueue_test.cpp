@@ -0,0 +1,166 @@
+#include "concurrent_queue_test.h"
+#include <bk_conq/async_queue.hpp>
+
+#ifdef BK_CONQ_HAS_COROUTINES
+
+#include <deque>
+#include <mutex>
+
+namespace AsyncQueue {
+//a coroutine that starts eagerly and frees its frame when it finishes, nothing waits on it
+struct task {
+    struct promise_type {
+        task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+//queues the handles it is given, the test resumes them by running it
+class queued_executor {
+public:
+    void operator()(std::coroutine_handle<> handle) {
+        std::lock_guard<std::mutex> lock(_m);
+        _handles.push_back(handle);
+    }
+
+    size_t run() {
+        size_t count = 0;
+        while (true) {
+            std::coroutine_handle<> handle;
+            {
+                std::lock_guard<std::mutex> lock(_m);
+                if (_handles.empty()) return count;
+                handle = _handles.front();
+                _handles.pop_front();
+            }
+            handle.resume();
+            ++count;
+        }
+    }
+
+private:
+    std::mutex _m;
+    std::deque<std::coroutine_handle<>> _handles;
+};
+
+using qtype = bk_conq::async_queue<bk_conq::vector_queue<QueueTest::queue_test_type_t>>;
+using uqtype = bk_conq::async_queue<bk_conq::list_queue<QueueTest::queue_test_type_t>>;
+using mqtype = bk_conq::async_queue<bk_conq::multi_bounded_queue<bk_conq::vector_queue<QueueTest::queue_test_type_t>>>;
+using eqtype = bk_conq::async_queue<bk_conq::vector_queue<QueueTest::queue_test_type_t>, queued_executor&>;
+
+template <typename Q>
+static task producer(Q& q, size_t first, size_t count, std::atomic<size_t>& done) {
+    for (size_t j = first; j < first + count; ++j) {
+        EXPECT_EQ(co_await q.enqueue(j), bk_conq::queue_status::success);
+    }
+    ++done;
+}
+
+template <typename Q>
+static task consumer(Q& q, std::atomic<size_t>& received, std::atomic<size_t>& sum, std::atomic<size_t>& done) {
+    while (auto item = co_await q.dequeue()) {
+        ++received;
+        sum += *item;
+    }
+    ++done;
+}
+
+template <typename Q>
+static task enqueueOne(Q& q, size_t item, bk_conq::queue_status& status) {
+    status = co_await q.enqueue(item);
+}
+
+//every thread starts a coroutine, which is then resumed on whichever thread makes its operation possible
+template <typename Q, typename... Args>
+static void runAsync(size_t nReaders, size_t nWriters, size_t nElements, Args&&... args) {
+    Q q(bk_conq::inline_executor(), args...);
+    std::atomic<size_t> received{ 0 }, sum{ 0 }, readersDone{ 0 }, writersDone{ 0 };
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < nReaders; ++i) {
+        threads.emplace_back([&]() { consumer(q, received, sum, readersDone); });
+    }
+    for (size_t i = 0; i < nWriters; ++i) {
+        size_t count = nElements / nWriters;
+        size_t first = i * count;
+        if (i == nWriters - 1) count = nElements - first;
+        threads.emplace_back([&, first, count]() { producer(q, first, count, writersDone); });
+    }
+    for (auto& t : threads) t.join();
+    while (writersDone != nWriters) std::this_thread::yield();
+    q.close();
+    while (readersDone != nReaders) std::this_thread::yield();
+    EXPECT_EQ(received.load(), nElements);
+    EXPECT_EQ(sum.load(), nElements * (nElements - 1) / 2);
+}
+
+TEST_P(QueueTest, async_vector_queue) {
+    runAsync<qtype>(_params.nReaders, _params.nWriters, _params.nElements, _params.queueSize);
+}
+
+TEST_P(QueueTest, async_list_queue) {
+    runAsync<uqtype>(_params.nReaders, _params.nWriters, _params.nElements);
+}
+
+TEST_P(QueueTest, async_multi_vector_queue) {
+    runAsync<mqtype>(_params.nReaders, _params.nWriters, _params.nElements, _params.queueSize, _params.subqueueSize);
+}
+
+//parked coroutines are resumed through the executor, not on the thread that notifies them
+TEST_P(QueueTest, async_queue_executor) {
+    if (_params.nReaders != 1 || _params.nWriters != 1) return;
+    queued_executor executor;
+    eqtype q(executor, _params.queueSize);
+    std::atomic<size_t> received{ 0 }, sum{ 0 }, readersDone{ 0 }, writersDone{ 0 };
+    consumer(q, received, sum, readersDone);
+    EXPECT_EQ(executor.run(), size_t(0));
+    EXPECT_TRUE(q.try_enqueue(size_t(7)));
+    EXPECT_EQ(received.load(), size_t(0));
+    EXPECT_EQ(executor.run(), size_t(1));
+    EXPECT_EQ(received.load(), size_t(1));
+    EXPECT_EQ(sum.load(), size_t(7));
+
+    //a producer suspends on the full queue and is resumed once an item is dequeued
+    eqtype pq(executor, _params.queueSize);
+    for (size_t j = 0; j < _params.queueSize; ++j) ASSERT_TRUE(pq.try_enqueue(j));
+    producer(pq, 0, 1, writersDone);
+    EXPECT_EQ(writersDone.load(), size_t(0));
+    size_t res;
+    ASSERT_TRUE(pq.try_dequeue(res));
+    EXPECT_EQ(writersDone.load(), size_t(0));
+    ASSERT_EQ(executor.run(), size_t(1));
+    EXPECT_EQ(writersDone.load(), size_t(1));
+    EXPECT_EQ(pq.size_approx(), _params.queueSize);
+    q.close();
+    EXPECT_EQ(executor.run(), size_t(1));
+    EXPECT_EQ(readersDone.load(), size_t(1));
+}
+
+//closing resumes parked consumers with an empty optional and parked producers with queue_status::closed
+TEST_P(QueueTest, async_queue_close) {
+    if (_params.nReaders != 1 || _params.nWriters != 1) return;
+    qtype q(bk_conq::inline_executor(), 2);
+    std::atomic<size_t> received{ 0 }, sum{ 0 }, readersDone{ 0 };
+    consumer(q, received, sum, readersDone);
+    EXPECT_EQ(readersDone.load(), size_t(0));
+    q.close();
+    EXPECT_EQ(readersDone.load(), size_t(1));
+
+    qtype pq(bk_conq::inline_executor(), 2);
+    EXPECT_TRUE(pq.try_enqueue(size_t(0)));
+    EXPECT_TRUE(pq.try_enqueue(size_t(1)));
+    bk_conq::queue_status status = bk_conq::queue_status::success;
+    enqueueOne(pq, 2, status);
+    EXPECT_EQ(status, bk_conq::queue_status::success);
+    pq.close();
+    EXPECT_EQ(status, bk_conq::queue_status::closed);
+    size_t res;
+    EXPECT_TRUE(pq.try_dequeue(res));
+    EXPECT_TRUE(pq.try_dequeue(res));
+    EXPECT_FALSE(pq.try_dequeue(res));
+}
+}
+
+#endif
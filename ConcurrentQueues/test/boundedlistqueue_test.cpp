@@ -3,8 +3,13 @@
 namespace BoundedListQueue {
 using qtype = bk_conq::bounded_list_queue<QueueTest::queue_test_type_t>;
 using mqtype = bk_conq::multi_bounded_queue<qtype>;
+using eqtype = bk_conq::bounded_list_queue<MoveOnlyThing>;
+using meqtype = bk_conq::multi_bounded_queue<eqtype>;
 using bqtype = bk_conq::blocking_bounded_queue<qtype>;
 using bmqtype = bk_conq::blocking_bounded_queue<mqtype>;
+using hpqtype = bk_conq::bounded_list_queue<QueueTest::queue_test_type_t, bk_conq::yield_strategy, bk_conq::page_allocator<QueueTest::queue_test_type_t>>;
+using cardqtype = bk_conq::bounded_list_queue<QueueTest::queue_test_type_t, bk_conq::yield_strategy, std::allocator<QueueTest::queue_test_type_t>, bk_conq::producers::single, bk_conq::consumers::single>;
+using cardmqtype = bk_conq::multi_bounded_queue<qtype, qtype::value_type, bk_conq::round_robin_assignment, bk_conq::hitlist_dequeue, bk_conq::no_stats, bk_conq::producers::single>;
 
 TEST_P(QueueTest, bounded_list_queue) {
     QueueTest::TemplatedTest<qtype, queue_test_type_t>();
@@ -18,8 +23,53 @@ TEST_P(QueueTest, multi_bounded_list_queue) {
     QueueTest::TemplatedTest<mqtype, queue_test_type_t>(_params.subqueueSize);
 }
 
+TEST_P(QueueTest, bounded_list_queue_size) {
+    QueueTest::SizeTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_bounded_list_queue_size) {
+    QueueTest::SizeTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, bounded_list_queue_emplace) {
+    QueueTest::EmplaceTest<eqtype, MoveOnlyThing>();
+}
+
+TEST_P(QueueTest, multi_bounded_list_queue_emplace) {
+    QueueTest::EmplaceTest<meqtype, MoveOnlyThing>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, bounded_list_queue_consume) {
+    QueueTest::ConsumeTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_bounded_list_queue_consume) {
+    QueueTest::ConsumeTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, bounded_list_queue_cardinality) {
+    QueueTest::CardinalityTest<cardqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_bounded_list_queue_cardinality) {
+    QueueTest::CardinalityTest<cardmqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
 TEST_P(QueueTest, multi_bounded_list_queue_blocking) {
     QueueTest::BlockingTest<bmqtype, queue_test_type_t>(_params.subqueueSize);
 }
 
+TEST_P(QueueTest, bounded_list_queue_bulk) {
+    QueueTest::BulkTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_bounded_list_queue_bulk) {
+    QueueTest::BulkTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+
+TEST_P(QueueTest, bounded_list_queue_huge_pages) {
+    QueueTest::TemplatedTest<hpqtype, queue_test_type_t>(hugePageAllocator());
+}
+
 }
@@ -0,0 +1,129 @@
+#include "concurrent_queue_test.h"
+#include <bk_conq/broadcast_queue.hpp>
+
+namespace BroadcastQueue {
+using qtype = bk_conq::broadcast_queue<QueueTest::queue_test_type_t>;
+using eqtype = bk_conq::broadcast_queue<MoveOnlyThing>;
+
+//items carry the index of their writer in the upper bits
+static const size_t writerShift = 40;
+
+//every subscriber receives every item, in the order each writer enqueued them
+static void runBroadcast(size_t nReaders, size_t nWriters, size_t nElements, size_t queueSize, bool bulk) {
+    qtype q(queueSize);
+    std::vector<qtype::subscriber> subscribers;
+    for (size_t i = 0; i < nReaders; ++i) subscribers.push_back(q.subscribe());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < nReaders; ++i) {
+        threads.emplace_back([&, i]() {
+            std::vector<size_t> next(nWriters, 0);
+            size_t received = 0;
+            auto check = [&](const size_t& item) {
+                size_t writer = item >> writerShift;
+                ASSERT_LT(writer, nWriters);
+                ASSERT_EQ(item & ((size_t(1) << writerShift) - 1), next[writer]);
+                ++next[writer];
+            };
+            while (received < nElements) {
+                size_t count = bulk ? q.consume_bulk(subscribers[i], check, QueueTest::bulkSize) : size_t(q.consume(subscribers[i], check));
+                if (!count) std::this_thread::yield();
+                received += count;
+            }
+        });
+    }
+    for (size_t i = 0; i < nWriters; ++i) {
+        threads.emplace_back([&, i]() {
+            size_t count = nElements / nWriters;
+            if (i == 0) count += nElements - count * nWriters;
+            std::vector<size_t> items(QueueTest::bulkSize);
+            for (size_t j = 0; j < count; ) {
+                if (bulk) {
+                    size_t n = std::min(QueueTest::bulkSize, count - j);
+                    for (size_t k = 0; k < n; ++k) items[k] = (i << writerShift) | (j + k);
+                    size_t enqueued = q.mp_enqueue_bulk(items.begin(), items.begin() + n);
+                    if (!enqueued) std::this_thread::yield();
+                    j += enqueued;
+                }
+                else if (q.mp_enqueue((i << writerShift) | j)) {
+                    ++j;
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+}
+
+TEST_P(QueueTest, broadcast_queue) {
+    runBroadcast(_params.nReaders, _params.nWriters, _params.nElements, _params.queueSize, false);
+}
+
+TEST_P(QueueTest, broadcast_queue_bulk) {
+    runBroadcast(_params.nReaders, _params.nWriters, _params.nElements, _params.queueSize, true);
+}
+
+//the second stage only reads an item once the first stage has processed it
+TEST_P(QueueTest, broadcast_queue_pipeline) {
+    if (_params.nReaders != 1 || _params.nWriters != 1) return;
+    qtype q(_params.queueSize);
+    auto first = q.subscribe();
+    auto second = q.subscribe({ &first });
+    std::vector<char> processed(_params.nElements, 0);
+    std::thread firstStage([&]() {
+        for (size_t j = 0; j < _params.nElements; ) {
+            if (q.consume(first, [&](const size_t& item) { processed[item] = 1; })) ++j;
+        }
+    });
+    std::thread secondStage([&]() {
+        size_t unprocessed = 0;
+        for (size_t j = 0; j < _params.nElements; ) {
+            j += q.consume_bulk(second, [&](const size_t& item) { if (!processed[item]) ++unprocessed; }, QueueTest::bulkSize);
+        }
+        EXPECT_EQ(unprocessed, size_t(0));
+    });
+    for (size_t j = 0; j < _params.nElements; ) {
+        if (q.sp_enqueue(j)) ++j;
+    }
+    firstStage.join();
+    secondStage.join();
+}
+
+//producers are gated by the slowest subscriber until it unsubscribes
+TEST_P(QueueTest, broadcast_queue_unsubscribe) {
+    if (_params.nReaders != 1 || _params.nWriters != 1) return;
+    qtype q(_params.queueSize);
+    auto reader = q.subscribe();
+    {
+        auto idle = q.subscribe();
+        size_t j = 0;
+        while (q.sp_enqueue(j)) ++j;
+        EXPECT_EQ(j, _params.queueSize);
+        size_t res;
+        for (size_t k = 0; k < j; ++k) {
+            ASSERT_TRUE(q.dequeue(reader, res));
+            EXPECT_EQ(res, k);
+        }
+        EXPECT_FALSE(q.sp_enqueue(j));
+        EXPECT_EQ(q.size_approx(idle), _params.queueSize);
+    }
+    EXPECT_TRUE(q.sp_enqueue(0));
+    EXPECT_EQ(q.size_approx(reader), size_t(1));
+}
+
+//items are destroyed when their slot is reused and with the queue
+TEST_P(QueueTest, broadcast_queue_emplace) {
+    if (_params.nReaders != 1 || _params.nWriters != 1) return;
+    {
+        eqtype q(_params.queueSize);
+        auto reader = q.subscribe();
+        for (size_t j = 0; j < _params.queueSize * 3 + _params.queueSize / 2; ++j) {
+            ASSERT_TRUE(q.sp_emplace(j, 1));
+            ASSERT_TRUE(q.consume(reader, [&](const MoveOnlyThing& item) { EXPECT_EQ(*item.value, j + 1); }));
+        }
+    }
+    EXPECT_EQ(MoveOnlyThing::live().load(), 0);
+}
+
+}
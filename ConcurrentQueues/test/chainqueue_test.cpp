@@ -3,8 +3,26 @@
 namespace ChainQueue {
 using qtype = bk_conq::chain_queue<QueueTest::queue_test_type_t>;
 using mqtype = bk_conq::multi_unbounded_queue<qtype>;
+using eqtype = bk_conq::chain_queue<MoveOnlyThing>;
+using meqtype = bk_conq::multi_unbounded_queue<eqtype>;
 using bqtype = bk_conq::blocking_unbounded_queue<qtype>;
 using bmqtype = bk_conq::blocking_unbounded_queue<mqtype>;
+using sbqtype = bk_conq::chain_queue<QueueTest::queue_test_type_t, 64>;
+using msbqtype = bk_conq::multi_unbounded_queue<sbqtype>;
+using fqtype = bk_conq::chain_queue<QueueTest::queue_test_type_t, 1024, std::allocator<QueueTest::queue_test_type_t>, bk_conq::yield_strategy, bk_conq::block_order::fifo>;
+using mfqtype = bk_conq::multi_unbounded_queue<fqtype>;
+using bfqtype = bk_conq::blocking_unbounded_queue<fqtype>;
+using sfqtype = bk_conq::chain_queue<QueueTest::queue_test_type_t, 8, std::allocator<QueueTest::queue_test_type_t>, bk_conq::yield_strategy, bk_conq::block_order::fifo>;
+using stqtype = bk_conq::chain_queue<QueueTest::queue_test_type_t, 1024, std::allocator<QueueTest::queue_test_type_t>, bk_conq::yield_strategy, bk_conq::block_order::lifo, bk_conq::sharded_stats<>>;
+using smstqtype = bk_conq::multi_unbounded_queue<stqtype, stqtype::value_type, bk_conq::round_robin_assignment, bk_conq::hitlist_dequeue, bk_conq::sharded_stats<>>;
+using cardqtype = bk_conq::chain_queue<QueueTest::queue_test_type_t, 1024, std::allocator<QueueTest::queue_test_type_t>, bk_conq::yield_strategy, bk_conq::block_order::lifo, bk_conq::no_stats, bk_conq::producers::single, bk_conq::consumers::single>;
+using cardmqtype = bk_conq::multi_unbounded_queue<qtype, qtype::value_type, bk_conq::round_robin_assignment, bk_conq::hitlist_dequeue, bk_conq::no_stats, bk_conq::producers::single>;
+
+//blocks available up front and retained in the freelist by the pooled tests
+static const size_t poolBlocks = 1024;
+
+//not a multiple of either block size, so the last block is left partially filled
+static const size_t orderItems = 4099;
 
 TEST_P(QueueTest, chain_queue) {
     QueueTest::TemplatedTest<qtype, queue_test_type_t>(false);
@@ -18,6 +36,46 @@ TEST_P(QueueTest, multi_chain_queue) {
     QueueTest::TemplatedTest<mqtype, queue_test_type_t>(false, _params.subqueueSize);
 }
 
+TEST_P(QueueTest, chain_queue_size) {
+    QueueTest::SizeTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_chain_queue_size) {
+    QueueTest::SizeTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, chain_queue_emplace) {
+    QueueTest::EmplaceTest<eqtype, MoveOnlyThing>();
+}
+
+TEST_P(QueueTest, multi_chain_queue_emplace) {
+    QueueTest::EmplaceTest<meqtype, MoveOnlyThing>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, chain_queue_consume) {
+    QueueTest::ConsumeTest<qtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_chain_queue_consume) {
+    QueueTest::ConsumeTest<mqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, chain_queue_cardinality) {
+    QueueTest::CardinalityTest<cardqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_chain_queue_cardinality) {
+    QueueTest::CardinalityTest<cardmqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, chain_queue_stats) {
+    QueueTest::StatsTest<stqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_chain_queue_stats) {
+    QueueTest::StatsTest<smstqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
 TEST_P(QueueTest, multi_chain_queue_blocking) {
     QueueTest::BlockingTest<bmqtype, queue_test_type_t>(false, _params.subqueueSize);
 }
@@ -38,4 +96,68 @@ TEST_P(QueueTest, multi_chain_queue_blocking_prefill) {
     QueueTest::BlockingTest<bmqtype, queue_test_type_t>(true, _params.subqueueSize);
 }
 
+TEST_P(QueueTest, chain_queue_bulk) {
+    QueueTest::BulkTest<qtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_chain_queue_bulk) {
+    QueueTest::BulkTest<mqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, chain_queue_small_block) {
+    QueueTest::TemplatedTest<sbqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_chain_queue_small_block) {
+    QueueTest::TemplatedTest<msbqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, chain_queue_pooled) {
+    QueueTest::TemplatedTest<qtype, queue_test_type_t>(false, poolBlocks, poolBlocks);
+}
+
+TEST_P(QueueTest, chain_queue_pooled_prefill) {
+    QueueTest::TemplatedTest<qtype, queue_test_type_t>(true, poolBlocks, poolBlocks);
+}
+
+TEST_P(QueueTest, chain_queue_fifo) {
+    QueueTest::TemplatedTest<fqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, chain_queue_fifo_blocking) {
+    QueueTest::BlockingTest<bfqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_chain_queue_fifo) {
+    QueueTest::TemplatedTest<mfqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, chain_queue_fifo_prefill) {
+    QueueTest::TemplatedTest<fqtype, queue_test_type_t>(true);
+}
+
+TEST_P(QueueTest, chain_queue_fifo_bulk) {
+    QueueTest::BulkTest<fqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, chain_queue_fifo_order) {
+    QueueTest::OrderTest<fqtype, queue_test_type_t>(orderItems);
+}
+
+TEST_P(QueueTest, chain_queue_fifo_order_small_block) {
+    QueueTest::OrderTest<sfqtype, queue_test_type_t>(orderItems);
+}
+
+TEST_P(QueueTest, chain_queue_fifo_concurrent_order) {
+    QueueTest::ConcurrentOrderTest<fqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, chain_queue_fifo_concurrent_order_small_block) {
+    QueueTest::ConcurrentOrderTest<sfqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_chain_queue_fifo_bulk) {
+    QueueTest::BulkTest<mfqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
 }
\ No newline at end of file
@@ -27,6 +27,8 @@ std::ostream& operator<<(std::ostream& os, const std::chrono::duration<double>&
     return os;
 }
 
+constexpr size_t QueueTest::bulkSize;
+
 void QueueTest::SetUp() {
     auto tupleParams = GetParam();
     _params = TestParameters{ ::testing::get<0>(tupleParams), ::testing::get<1>(tupleParams), ::testing::get<2>(tupleParams), ::testing::get<3>(tupleParams), ::testing::get<4>(tupleParams), ::testing::get<5>(tupleParams) };
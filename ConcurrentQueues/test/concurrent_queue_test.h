@@ -10,14 +10,25 @@
 
 #include <gtest/gtest.h>
 #include <iostream>
+#include <algorithm>
+#include <memory>
+#include <atomic>
 #include <bk_conq/blocking_unbounded_queue.hpp>
 #include <bk_conq/blocking_bounded_queue.hpp>
 #include <bk_conq/multi_bounded_queue.hpp>
 #include <bk_conq/multi_unbounded_queue.hpp>
+#include <bk_conq/multi_priority_queue.hpp>
 #include <bk_conq/bounded_list_queue.hpp>
 #include <bk_conq/vector_queue.hpp>
+#include <bk_conq/spsc_vector_queue.hpp>
 #include <bk_conq/list_queue.hpp>
 #include <bk_conq/chain_queue.hpp>
+#include <bk_conq/segment_queue.hpp>
+#include <bk_conq/wait_strategy.hpp>
+#include <bk_conq/page_allocator.hpp>
+#include <bk_conq/assignment_policy.hpp>
+#include <bk_conq/dequeue_policy.hpp>
+#include <bk_conq/stats_policy.hpp>
 #include "basic_timer.h"
 
 enum QueueTestType : uint32_t {
@@ -48,11 +59,43 @@ struct BigThing {
     BigThing() {}
 };
 
+//move-only and not default constructible, live instances are counted so that items the queues fail to destroy show up
+struct MoveOnlyThing {
+    std::unique_ptr<size_t> value;
+    MoveOnlyThing(size_t v, size_t offset) : value(new size_t(v + offset)) {
+        ++live();
+    }
+    MoveOnlyThing(MoveOnlyThing&& other) : value(std::move(other.value)) {
+        ++live();
+    }
+    MoveOnlyThing& operator=(MoveOnlyThing&& other) = default;
+    ~MoveOnlyThing() {
+        --live();
+    }
+    static std::atomic<int64_t>& live() {
+        static std::atomic<int64_t> count{ 0 };
+        return count;
+    }
+};
+
 
 class QueueTest : public testing::Test,
     public testing::WithParamInterface< ::testing::tuple<size_t, size_t, size_t, size_t, size_t, QueueTestType> > {
 public:
     typedef size_t queue_test_type_t;
+    //fixed 10ns sleep, and a sleep doubling from 1ns up to 1ms
+    typedef bk_conq::park_strategy<10, 10> sleep_strategy;
+    typedef bk_conq::park_strategy<1, 1000000> sleep_backoff_strategy;
+    static constexpr size_t bulkSize = 256;
+
+    //explicit 2MB huge pages (falling back to transparent huge pages), interleaved over node 0 and pre-faulted by 4 threads
+    static bk_conq::page_allocator<queue_test_type_t> hugePageAllocator() {
+        bk_conq::page_options options;
+        options.pages = bk_conq::page_size::huge_2mb;
+        options.numa = bk_conq::numa_policy::interleave;
+        options.prefault_threads = 4;
+        return bk_conq::page_allocator<queue_test_type_t>(options);
+    }
 
     virtual void SetUp();
     virtual void TearDown();
@@ -64,9 +107,9 @@ protected:
     std::atomic<bool> _startFlag{ false };
     std::atomic<size_t> _sync{ 0 };
 
-    template<typename T, typename R, typename ...Args>
-    void GenericTest(std::function<void(T&, R&) > dequeueOperation, std::function<void(T&, R) > enqueueOperation, bool prefill, Args... args) {
-        T q{ args... };
+    //runs the reader and writer bodies concurrently, each body is given the number of elements it must process
+    template<typename T>
+    void RunThreads(T& q, std::function<void(T&, size_t)> readerOperation, std::function<void(T&, size_t)> writerOperation, bool prefill) {
         std::vector<std::thread> l;
         for (int i = 0; i < (prefill ? 2 : 1); ++i) {
             _startFlag.store(false);
@@ -77,19 +120,9 @@ protected:
                     ++_sync;
                     while (!_startFlag.load(std::memory_order_acquire)) { std::this_thread::yield(); };
                     readers[i].start();
-                    queue_test_type_t res;
-                    for (size_t j = 0; j < _params.nElements / _params.nReaders; ++j) {
-                        dequeueOperation(q, res);
-                        //if (j % 100000 == 0) std::cout << "d" << j << std::endl;
-                        //if (_params.nElements/_params.nReaders -j < 100000) std::cout << "z" << j << std::endl;
-                        //if (_params.nElements / _params.nReaders - j < 100000) break;
-                    }
-                    if (i == 0) {
-                        size_t remainder = _params.nElements - ((_params.nElements / _params.nReaders) * _params.nReaders);
-                        for (size_t j = 0; j < remainder; ++j) {
-                            dequeueOperation(q, res);
-                        }
-                    }
+                    size_t count = _params.nElements / _params.nReaders;
+                    if (i == 0) count += _params.nElements - ((_params.nElements / _params.nReaders) * _params.nReaders);
+                    readerOperation(q, count);
                     readers[i].stop();
                 });
             }
@@ -98,16 +131,9 @@ protected:
                     ++_sync;
                     while (!_startFlag.load(std::memory_order_acquire)) { std::this_thread::yield(); };
                     writers[i].start();
-                    for (size_t j = 0; j < _params.nElements / _params.nWriters; ++j) {
-                        enqueueOperation(q, j);
-                        //if (j % 100000 == 0) std::cout << "e" << j << std::endl;
-                    }
-                    if (i == 0) {
-                        size_t remainder = _params.nElements - ((_params.nElements / _params.nWriters) * _params.nWriters);
-                        for (size_t j = 0; j < remainder; ++j) {
-                            enqueueOperation(q, j);
-                        }
-                    }
+                    size_t count = _params.nElements / _params.nWriters;
+                    if (i == 0) count += _params.nElements - ((_params.nElements / _params.nWriters) * _params.nWriters);
+                    writerOperation(q, count);
                     writers[i].stop();
                 });
             }
@@ -117,70 +143,91 @@ protected:
                 l[i].join();
             }
         }
-
-    }
-
-    auto generateBusyDequeue() {
-        return ([](auto& q, auto& item) {
-            while (!q.mc_dequeue(item));
-        });
     }
 
-    auto generateYieldDequeue() {
-        return ([](auto& q, auto& item) {
-            while (!q.mc_dequeue(item)) { std::this_thread::yield(); }
-        });
+    template<typename T, typename R, typename ...Args>
+    void GenericTest(std::function<void(T&, R&) > dequeueOperation, std::function<void(T&, R) > enqueueOperation, bool prefill, Args... args) {
+        T q{ args... };
+        RunThreads<T>(q, [&](T& q, size_t count) {
+            queue_test_type_t res;
+            for (size_t j = 0; j < count; ++j) {
+                dequeueOperation(q, res);
+            }
+        }, [&](T& q, size_t count) {
+            for (size_t j = 0; j < count; ++j) {
+                enqueueOperation(q, j);
+            }
+        }, prefill);
     }
 
-    auto generateSleepDequeue() {
-        return ([](auto& q, auto& item) {
-            while (!q.mc_dequeue(item)) { std::this_thread::sleep_for(std::chrono::nanoseconds(10)); }
-        });
+    //items are enqueued in bursts of bulkSize and dequeued in batches of up to bulkSize
+    template<typename T, typename R, typename ...Args>
+    void GenericBulkTest(std::function<size_t(T&, R*, size_t) > dequeueOperation, std::function<void(T&, R*, R*) > enqueueOperation, bool prefill, Args... args) {
+        T q{ args... };
+        RunThreads<T>(q, [&](T& q, size_t count) {
+            std::vector<R> res(bulkSize);
+            for (size_t j = 0; j < count; ) {
+                j += dequeueOperation(q, res.data(), std::min(bulkSize, count - j));
+            }
+        }, [&](T& q, size_t count) {
+            std::vector<R> items(bulkSize);
+            for (size_t j = 0; j < count; j += bulkSize) {
+                size_t n = std::min(bulkSize, count - j);
+                for (size_t k = 0; k < n; ++k) items[k] = j + k;
+                enqueueOperation(q, items.data(), items.data() + n);
+            }
+        }, prefill);
     }
 
-    auto generateBackoffDequeue() {
+    //retries a failed operation, waiting with the given strategy between attempts
+    template <typename STRATEGY>
+    auto generateStrategyDequeue() {
         return ([](auto& q, auto& item) {
-            auto wait_time = std::chrono::nanoseconds(1);
-            while (!q.mc_dequeue(item)) {
-                std::this_thread::sleep_for(wait_time);
-                wait_time *= 2;
-            }
+            STRATEGY strategy;
+            while (!q.mc_dequeue(item)) { strategy.wait(); }
         });
     }
 
-    auto generateBusyEnqueue() {
+    template <typename STRATEGY>
+    auto generateStrategyEnqueue() {
         return ([](auto& q, auto item) {
-            while (!q.mp_enqueue(item));
+            STRATEGY strategy;
+            while (!q.mp_enqueue(item)) { strategy.wait(); }
         });
     }
 
-    auto generateYieldEnqueue() {
-        return ([](auto& q, auto item) {
-            while (!q.mp_enqueue(item)) { std::this_thread::yield(); }
+    auto generateBulkDequeue() {
+        return ([](auto& q, auto* items, size_t max) {
+            size_t count;
+            while (!(count = q.mc_dequeue_bulk(items, max))) { std::this_thread::yield(); }
+            return count;
         });
     }
 
-    auto generateSleepEnqueue() {
-        return ([](auto& q, auto item) {
-            while (!q.mp_enqueue(item)) { std::this_thread::sleep_for(std::chrono::nanoseconds(10)); }
+    auto generateBoundedBulkEnqueue() {
+        return ([](auto& q, auto* first, auto* last) {
+            while (first != last) {
+                size_t count = q.mp_enqueue_bulk(first, last);
+                if (!count) std::this_thread::yield();
+                first += count;
+            }
         });
     }
 
-    auto generateBackoffEnqueue() {
-        return ([](auto& q, auto item) {
-            auto wait_time = std::chrono::nanoseconds(1);
-            while (!q.mp_enqueue(item)) { std::this_thread::sleep_for(wait_time); wait_time *= 2; }
+    auto generateUnboundedBulkEnqueue() {
+        return ([](auto& q, auto* first, auto* last) {
+            q.mp_enqueue_bulk(first, last);
         });
     }
 
     template<typename T, typename R>
     std::function<void(T&, R&)> generateDequeueFunctionNonblocking() {
         switch (_params.testType) {
-        case BUSY_TEST: return generateBusyDequeue();
-        case YIELD_TEST: return generateYieldDequeue();
-        case SLEEP_TEST: return generateSleepDequeue();
-        case BACKOFF_TEST: return generateBackoffDequeue();
-        default: return generateBusyDequeue();
+        case BUSY_TEST: return generateStrategyDequeue<bk_conq::busy_spin_strategy>();
+        case YIELD_TEST: return generateStrategyDequeue<bk_conq::yield_strategy>();
+        case SLEEP_TEST: return generateStrategyDequeue<sleep_strategy>();
+        case BACKOFF_TEST: return generateStrategyDequeue<sleep_backoff_strategy>();
+        default: return generateStrategyDequeue<bk_conq::busy_spin_strategy>();
         }
     }
 
@@ -191,14 +238,29 @@ protected:
         });
     }
 
+    //waits in short timed slices, retrying on timeout
+    template<typename T, typename R>
+    std::function<void(T&, R&)> generateDequeueFunctionTimed() {
+        return ([](T& q, R& item) {
+            while (q.mc_dequeue_for(item, std::chrono::milliseconds(1)) != bk_conq::queue_status::success);
+        });
+    }
+
+    template<typename T, typename R>
+    std::function<void(T&, R)> generateEnqueueFunctionTimed() {
+        return ([](T& q, R item) {
+            while (q.mp_enqueue_for(item, std::chrono::milliseconds(1)) != bk_conq::queue_status::success);
+        });
+    }
+
     template<typename T, typename R>
     std::function<void(T&, R)> generateEnqueueFunctionNonblocking() {
         switch (_params.testType) {
-        case BUSY_TEST: return generateBusyEnqueue();
-        case YIELD_TEST: return generateYieldEnqueue();
-        case SLEEP_TEST: return generateSleepEnqueue();
-        case BACKOFF_TEST: return generateBackoffEnqueue();
-        default: return generateBusyEnqueue();
+        case BUSY_TEST: return generateStrategyEnqueue<bk_conq::busy_spin_strategy>();
+        case YIELD_TEST: return generateStrategyEnqueue<bk_conq::yield_strategy>();
+        case SLEEP_TEST: return generateStrategyEnqueue<sleep_strategy>();
+        case BACKOFF_TEST: return generateStrategyEnqueue<sleep_backoff_strategy>();
+        default: return generateStrategyEnqueue<bk_conq::busy_spin_strategy>();
         }
     }
 
@@ -234,6 +296,44 @@ protected:
     }
 
 
+    template<typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
+        BulkTest(bool prefill, Args&&... args) {
+        std::function<size_t(T&, R*, size_t)> dequeueFunction = generateBulkDequeue();
+        std::function<void(T&, R*, R*)> enqueueFunction = generateUnboundedBulkEnqueue();
+        GenericBulkTest(dequeueFunction, enqueueFunction, prefill, args...);
+    }
+
+    template<typename T, typename R, typename ...Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::bounded_queue_typed_tag<R>, T>::value>
+        BulkTest(Args&&... args) {
+        std::function<size_t(T&, R*, size_t)> dequeueFunction = generateBulkDequeue();
+        std::function<void(T&, R*, R*)> enqueueFunction = generateBoundedBulkEnqueue();
+        GenericBulkTest(dequeueFunction, enqueueFunction, false, _params.queueSize, args...);
+    }
+
+    //writers fill the queue with bulk enqueues until one fails, then readers drain it with bulk dequeues until one fails.
+    //a bulk operation only fails on a full or empty queue, however the operations of the other threads interleave with it
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::bounded_queue_typed_tag<R>, T>::value>
+        BulkFillTest(Args&&... args) {
+        T q{ _params.queueSize, args... };
+        std::atomic<size_t> enqueued{ 0 };
+        std::atomic<size_t> dequeued{ 0 };
+        std::atomic<size_t> filled{ 0 };
+        RunThreads<T>(q, [&](T& q, size_t) {
+            while (filled.load(std::memory_order_acquire) != _params.nWriters) { std::this_thread::yield(); }
+            std::vector<R> res(bulkSize);
+            while (size_t n = q.mc_dequeue_bulk(res.data(), bulkSize)) dequeued += n;
+        }, [&](T& q, size_t) {
+            std::vector<R> items(bulkSize);
+            while (size_t n = q.mp_enqueue_bulk(items.data(), items.data() + bulkSize)) enqueued += n;
+            filled.fetch_add(1, std::memory_order_release);
+        }, false);
+        EXPECT_EQ(enqueued.load(), q.capacity());
+        EXPECT_EQ(dequeued.load(), q.capacity());
+    }
+
     template <typename T, typename R, typename... Args>
     typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
         BlockingTest(bool prefill, Args&&... args) {
@@ -250,5 +350,605 @@ protected:
         GenericTest(dequeueFunction, enqueueFunction, false, _params.queueSize, args...);
     }
 
+    //single-producer single-consumer operations, only run with one reader and one writer
+    template<typename T, typename R, typename ...Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::bounded_queue_typed_tag<R>, T>::value>
+        SpscTest(Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        std::function<void(T&, R&)> dequeueFunction = [](T& q, R& item) {
+            bk_conq::yield_strategy strategy;
+            while (!q.sc_dequeue(item)) { strategy.wait(); }
+        };
+        std::function<void(T&, R)> enqueueFunction = [](T& q, R item) {
+            bk_conq::yield_strategy strategy;
+            while (!q.sp_enqueue(item)) { strategy.wait(); }
+        };
+        GenericTest(dequeueFunction, enqueueFunction, false, _params.queueSize, args...);
+    }
+
+    //the operations selected by the declared cardinality, only run with as many readers and writers as T allows
+    template <typename T>
+    bool CardinalityAllows() {
+        if (T::producer_cardinality == bk_conq::producers::single && _params.nWriters != 1) return false;
+        if (T::consumer_cardinality == bk_conq::consumers::single && _params.nReaders != 1) return false;
+        return true;
+    }
+
+    template<typename T, typename R, typename ...Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::bounded_queue_typed_tag<R>, T>::value>
+        CardinalityTest(Args&&... args) {
+        if (!CardinalityAllows<T>()) return;
+        std::function<void(T&, R&)> dequeueFunction = [](T& q, R& item) {
+            bk_conq::yield_strategy strategy;
+            while (!q.dequeue(item)) { strategy.wait(); }
+        };
+        std::function<void(T&, R)> enqueueFunction = [](T& q, R item) {
+            bk_conq::yield_strategy strategy;
+            while (!q.enqueue(item)) { strategy.wait(); }
+        };
+        GenericTest(dequeueFunction, enqueueFunction, false, _params.queueSize, args...);
+    }
+
+    template<typename T, typename R, typename ...Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
+        CardinalityTest(bool prefill, Args&&... args) {
+        if (!CardinalityAllows<T>()) return;
+        std::function<void(T&, R&)> dequeueFunction = [](T& q, R& item) {
+            bk_conq::yield_strategy strategy;
+            while (!q.dequeue(item)) { strategy.wait(); }
+        };
+        std::function<void(T&, R)> enqueueFunction = [](T& q, R item) {
+            q.enqueue(item);
+        };
+        GenericTest(dequeueFunction, enqueueFunction, prefill, args...);
+    }
+
+    //every reader and writer creates a token once and uses it for all of its operations
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
+        TokenTest(bool prefill, Args&&... args) {
+        T q{ args... };
+        RunThreads<T>(q, [&](T& q, size_t count) {
+            auto token = q.make_consumer_token();
+            R res;
+            for (size_t j = 0; j < count; ++j) {
+                while (!q.dequeue(token, res)) { std::this_thread::yield(); }
+            }
+        }, [&](T& q, size_t count) {
+            auto token = q.make_producer_token();
+            for (size_t j = 0; j < count; ++j) {
+                q.enqueue(token, j);
+            }
+        }, prefill);
+    }
+
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::bounded_queue_typed_tag<R>, T>::value>
+        TokenTest(Args&&... args) {
+        T q{ _params.queueSize, args... };
+        RunThreads<T>(q, [&](T& q, size_t count) {
+            auto token = q.make_consumer_token();
+            R res;
+            for (size_t j = 0; j < count; ++j) {
+                while (!q.dequeue(token, res)) { std::this_thread::yield(); }
+            }
+        }, [&](T& q, size_t count) {
+            auto token = q.make_producer_token();
+            for (size_t j = 0; j < count; ++j) {
+                while (!q.enqueue(token, j)) { std::this_thread::yield(); }
+            }
+        }, false);
+    }
+
+    //items are spread over the priority levels, enqueues onto a full bounded level are retried
+    template <typename T, typename R, size_t LEVELS, typename... Args>
+    void PriorityTest(Args&&... args) {
+        T q{ args... };
+        RunThreads<T>(q, [&](T& q, size_t count) {
+            R res;
+            for (size_t j = 0; j < count; ++j) {
+                while (!q.mc_dequeue(res)) { std::this_thread::yield(); }
+            }
+        }, [&](T& q, size_t count) {
+            for (size_t j = 0; j < count; ++j) {
+                while (!q.mp_enqueue(j % LEVELS, j)) { std::this_thread::yield(); }
+            }
+        }, false);
+    }
+
+    //single threaded, one subqueue per level of a 3 level queue. Level 0 holds 0 to 5, level 1 holds 100
+    //and 101, level 2 holds 200 to 202, and the exact dequeue order is checked for strict priority and for
+    //a starvation ratio of 2, under which levels 1 and 2 are each served after being passed over twice,
+    //the higher priority first. Levels outside the queue are rejected, and a level that was found empty
+    //and cleared is found again once an item is enqueued onto it
+    template <typename T, typename R, typename... Args>
+    void PriorityOrderTest(Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        const std::vector<R> strict{ 0, 1, 2, 3, 4, 5, 100, 101, 200, 201, 202 };
+        const std::vector<R> ratio{ 0, 1, 100, 200, 2, 3, 101, 201, 4, 5, 202 };
+        for (size_t starvation : { size_t(0), size_t(2) }) {
+            T q{ size_t(1), starvation, args... };
+            for (R j = 0; j < 6; ++j) ASSERT_TRUE(q.sp_enqueue(0, j));
+            for (R j = 100; j < 102; ++j) ASSERT_TRUE(q.sp_enqueue(1, j));
+            for (R j = 200; j < 203; ++j) ASSERT_TRUE(q.sp_enqueue(2, j));
+            EXPECT_FALSE(q.sp_enqueue(3, R(300)));
+            R rejected[] = { 300, 301 };
+            EXPECT_EQ(q.sp_enqueue_bulk(64, std::begin(rejected), std::end(rejected)), size_t(0));
+            R res;
+            for (R expected : starvation ? ratio : strict) {
+                ASSERT_TRUE(q.sc_dequeue(res));
+                EXPECT_EQ(res, expected);
+            }
+            EXPECT_FALSE(q.sc_dequeue(res));
+            ASSERT_TRUE(q.sp_enqueue(1, R(102)));
+            ASSERT_TRUE(q.sc_dequeue(res));
+            EXPECT_EQ(res, R(102));
+            EXPECT_FALSE(q.sc_dequeue(res));
+        }
+    }
+
+    //a producer and a consumer take turns with one item at a time on rotating levels, so the consumer keeps
+    //finding levels empty and clearing them from the bitmask while the producer marks them. A level left
+    //cleared with an item in it would never be visited again, which the consumer reports after a timeout
+    template <typename T, typename R, size_t LEVELS, typename... Args>
+    void PriorityRecoveryTest(size_t items, Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        T q{ args... };
+        std::atomic<size_t> consumed{ 0 };
+        std::atomic<bool> lost{ false };
+        std::thread producer([&]() {
+            for (size_t j = 0; j < items && !lost.load(); ++j) {
+                while (!q.mp_enqueue(j % LEVELS, j)) { std::this_thread::yield(); }
+                while (consumed.load() == j && !lost.load()) { std::this_thread::yield(); }
+            }
+        });
+        R res;
+        for (size_t j = 0; j < items; ++j) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            bool found = false;
+            while (!(found = q.mc_dequeue(res)) && std::chrono::steady_clock::now() < deadline) { std::this_thread::yield(); }
+            if (!found) {
+                lost.store(true);
+                break;
+            }
+            EXPECT_EQ(res, j);
+            consumed.store(j + 1);
+        }
+        producer.join();
+        EXPECT_FALSE(lost.load());
+    }
+
+    //every item is counted once by a queue with a statistics policy
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
+        StatsTest(Args&&... args) {
+        T q{ args... };
+        RunThreads<T>(q, [&](T& q, size_t count) {
+            R res;
+            for (size_t j = 0; j < count; ++j) {
+                while (!q.mc_dequeue(res)) { std::this_thread::yield(); }
+            }
+        }, [&](T& q, size_t count) {
+            for (size_t j = 0; j < count; ++j) {
+                q.mp_enqueue(j);
+            }
+        }, false);
+        bk_conq::queue_stats stats = q.stats();
+        EXPECT_EQ(stats[bk_conq::queue_stat::enqueues], _params.nElements);
+        EXPECT_EQ(stats[bk_conq::queue_stat::dequeues], _params.nElements);
+    }
+
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::bounded_queue_typed_tag<R>, T>::value>
+        StatsTest(Args&&... args) {
+        T q{ _params.queueSize, args... };
+        RunThreads<T>(q, [&](T& q, size_t count) {
+            R res;
+            for (size_t j = 0; j < count; ++j) {
+                while (!q.mc_dequeue(res)) { std::this_thread::yield(); }
+            }
+        }, [&](T& q, size_t count) {
+            for (size_t j = 0; j < count; ++j) {
+                while (!q.mp_enqueue(j)) { std::this_thread::yield(); }
+            }
+        }, false);
+        bk_conq::queue_stats stats = q.stats();
+        EXPECT_EQ(stats[bk_conq::queue_stat::enqueues], _params.nElements);
+        EXPECT_EQ(stats[bk_conq::queue_stat::dequeues], _params.nElements);
+    }
+
+    //adapt() runs throughout on another thread, growing and retiring subqueues while items pass through them
+    template <typename T, typename R, typename... Args>
+    void AdaptiveTest(Args&&... args) {
+        T q{ args... };
+        std::atomic<bool> done{ false };
+        std::thread adapter([&]() {
+            while (!done.load()) {
+                EXPECT_GE(q.adapt(), size_t(1));
+                std::this_thread::yield();
+            }
+        });
+        RunThreads<T>(q, [&](T& q, size_t count) {
+            R res;
+            for (size_t j = 0; j < count; ++j) {
+                while (!q.mc_dequeue(res)) { std::this_thread::yield(); }
+            }
+        }, [&](T& q, size_t count) {
+            for (size_t j = 0; j < count; ++j) {
+                q.mp_enqueue(j);
+            }
+        }, false);
+        done.store(true);
+        adapter.join();
+        EXPECT_EQ(q.size_approx(), size_t(0));
+    }
+
+    //single threaded, the approximate size is exact once the queue is quiescent. one item more than the queue size is
+    //enqueued so that the last item is left in a partially filled block or segment
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
+        SizeTest(Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        T q{ args... };
+        EXPECT_TRUE(q.empty_approx());
+        for (size_t j = 0; j <= _params.queueSize; ++j) q.sp_enqueue(j);
+        EXPECT_EQ(q.size_approx(), _params.queueSize + 1);
+        R res;
+        for (size_t j = 0; j < _params.queueSize; ++j) ASSERT_TRUE(q.sc_dequeue(res));
+        EXPECT_EQ(q.size_approx(), size_t(1));
+        EXPECT_FALSE(q.empty_approx());
+        while (q.sc_dequeue(res));
+        EXPECT_TRUE(q.empty_approx());
+    }
+
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::bounded_queue_typed_tag<R>, T>::value>
+        SizeTest(Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        T q{ _params.queueSize, args... };
+        EXPECT_TRUE(q.empty_approx());
+        size_t count = 0;
+        while (q.sp_enqueue(count)) ++count;
+        EXPECT_EQ(q.size_approx(), count);
+        EXPECT_LE(count, q.capacity());
+        R res;
+        while (q.sc_dequeue(res));
+        EXPECT_TRUE(q.empty_approx());
+    }
+
+    //single threaded, the items enqueued by one thread are dequeued in the order they were enqueued, both when the queue
+    //is drained after the enqueues and when dequeues are interleaved with them
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
+        OrderTest(size_t count, Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        T q{ args... };
+        R res;
+        for (size_t j = 0; j < count; ++j) q.sp_enqueue(j);
+        for (size_t j = 0; j < count; ++j) {
+            ASSERT_TRUE(q.sc_dequeue(res));
+            ASSERT_EQ(res, j);
+        }
+        EXPECT_FALSE(q.sc_dequeue(res));
+        for (size_t j = 0; j < count; ++j) q.mp_enqueue(j);
+        for (size_t j = 0; j < count; ++j) {
+            ASSERT_TRUE(q.mc_dequeue(res));
+            ASSERT_EQ(res, j);
+        }
+        EXPECT_FALSE(q.mc_dequeue(res));
+        size_t next = 0;
+        for (size_t j = 0; j < count; ++j) {
+            q.mp_enqueue(2 * j);
+            q.mp_enqueue(2 * j + 1);
+            ASSERT_TRUE(q.mc_dequeue(res));
+            ASSERT_EQ(res, next++);
+        }
+        while (q.mc_dequeue(res)) ASSERT_EQ(res, next++);
+        EXPECT_EQ(next, 2 * count);
+    }
+
+    //one writer and one reader run concurrently, the reader alternates between single item and bulk dequeues and must
+    //see the items in the order they were enqueued
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
+        ConcurrentOrderTest(Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        T q{ args... };
+        std::atomic<size_t> misordered{ 0 };
+        RunThreads<T>(q, [&](T& q, size_t count) {
+            R res[bulkSize];
+            for (size_t next = 0; next < count; ) {
+                size_t n = (next & 1) ? q.mc_dequeue_bulk(res, std::min(bulkSize, count - next)) : size_t(q.mc_dequeue(res[0]));
+                for (size_t k = 0; k < n; ++k, ++next) {
+                    if (res[k] != next) ++misordered;
+                }
+                if (!n) std::this_thread::yield();
+            }
+        }, [&](T& q, size_t count) {
+            for (size_t j = 0; j < count; ++j) q.mp_enqueue(j);
+        }, false);
+        EXPECT_EQ(misordered.load(), size_t(0));
+    }
+
+    //single threaded, each subqueue is given one item in turn through its own producer token, and a single
+    //consumer must find every item wherever it is queued, with single item and bulk dequeues
+    template <typename T, typename R>
+    void SweepTest(size_t subqueues) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        T q{ subqueues };
+        std::vector<typename T::producer_token> producers;
+        for (size_t i = 0; i < subqueues; ++i) producers.push_back(q.make_producer_token());
+        auto consumer = q.make_consumer_token();
+        R res;
+        for (size_t j = 0; j < subqueues; ++j) {
+            q.enqueue(producers[j], j);
+            ASSERT_TRUE(q.dequeue(consumer, res));
+            EXPECT_EQ(res, j);
+        }
+        for (size_t j = 0; j < subqueues; ++j) {
+            q.enqueue(producers[j], j);
+            ASSERT_EQ(q.dequeue_bulk(consumer, &res, 1), size_t(1));
+            EXPECT_EQ(res, j);
+        }
+        EXPECT_FALSE(q.dequeue(consumer, res));
+    }
+
+    //short lived threads use the queue and then exit while it is being destroyed, so the returners they invoke
+    //on exit race with the destructor, which must wait for them rather than be left with a dangling owner
+    template <typename T, typename R, typename... Args>
+    void ExitDuringDestructionTest(size_t rounds, size_t threads, Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        for (size_t round = 0; round < rounds; ++round) {
+            std::unique_ptr<T> q(new T{ args... });
+            std::atomic<size_t> ready{ 0 };
+            std::atomic<bool> exit{ false };
+            std::vector<std::thread> l;
+            for (size_t i = 0; i < threads; ++i) {
+                l.emplace_back([&, i]() {
+                    R res;
+                    q->mp_enqueue(i);
+                    q->mp_enqueue(i);
+                    q->mc_dequeue(res);
+                    ready.fetch_add(1);
+                    while (!exit.load()) std::this_thread::yield();
+                });
+            }
+            while (ready.load() != threads) std::this_thread::yield();
+            exit.store(true);
+            q.reset();
+            for (auto& t : l) t.join();
+        }
+    }
+
+    //single threaded, R is a MoveOnlyThing, and half the items are left in the queue to be destroyed with it
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
+        EmplaceTest(Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        {
+            T q{ args... };
+            for (size_t j = 0; j < _params.queueSize; ++j) q.sp_emplace(j, 1);
+            R res(0, 0);
+            for (size_t j = 0; j < _params.queueSize / 2; ++j) {
+                ASSERT_TRUE(q.sc_dequeue(res));
+                ASSERT_NE(res.value, nullptr);
+                EXPECT_GE(*res.value, size_t(1));
+            }
+        }
+        EXPECT_EQ(R::live().load(), 0);
+    }
+
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::bounded_queue_typed_tag<R>, T>::value>
+        EmplaceTest(Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        {
+            T q{ _params.queueSize, args... };
+            size_t count = 0;
+            while (q.sp_emplace(count, 1)) ++count;
+            EXPECT_EQ(q.size_approx(), count);
+            R res(0, 0);
+            for (size_t j = 0; j < count / 2; ++j) {
+                ASSERT_TRUE(q.sc_dequeue(res));
+                ASSERT_NE(res.value, nullptr);
+                EXPECT_GE(*res.value, size_t(1));
+            }
+        }
+        EXPECT_EQ(R::live().load(), 0);
+    }
+
+    //readers alternate between single item and bulk consumes, the sums of the items produced and consumed must match
+    template<typename T, typename R, typename ...Args>
+    void GenericConsumeTest(std::function<void(T&, R)> enqueueOperation, bool prefill, Args... args) {
+        T q{ args... };
+        std::atomic<size_t> produced{ 0 };
+        std::atomic<size_t> consumed{ 0 };
+        RunThreads<T>(q, [&](T& q, size_t count) {
+            size_t sum = 0;
+            auto f = [&sum](R& item) { sum += item; };
+            for (size_t j = 0; j < count; ) {
+                size_t n = (j & 1) ? q.mc_consume_bulk(f, std::min(bulkSize, count - j)) : size_t(q.mc_consume(f));
+                if (!n) std::this_thread::yield();
+                j += n;
+            }
+            consumed += sum;
+        }, [&](T& q, size_t count) {
+            size_t sum = 0;
+            for (size_t j = 0; j < count; ++j) {
+                enqueueOperation(q, j);
+                sum += j;
+            }
+            produced += sum;
+        }, prefill);
+        EXPECT_EQ(consumed.load(), produced.load());
+    }
+
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
+        ConsumeTest(bool prefill, Args&&... args) {
+        GenericConsumeTest<T, R>(generateEnqueueFunctionBlocking<T, R>(), prefill, args...);
+    }
+
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::bounded_queue_typed_tag<R>, T>::value>
+        ConsumeTest(Args&&... args) {
+        GenericConsumeTest<T, R>(generateEnqueueFunctionNonblocking<T, R>(), false, _params.queueSize, args...);
+    }
+
+    //single threaded, shrink releases the chunks whose nodes are all free and leaves the items in the other chunks intact
+    template <typename T, typename R>
+    void ShrinkTest(size_t chunkSize) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        T q{ chunkSize };
+        R res;
+        for (size_t j = 0; j < _params.queueSize; ++j) q.sp_enqueue(j);
+        size_t peak = q.allocated_nodes();
+        EXPECT_GE(peak, _params.queueSize);
+        for (size_t j = 0; j < _params.queueSize / 2; ++j) {
+            ASSERT_TRUE(q.sc_dequeue(res));
+            ASSERT_EQ(res, j);
+        }
+        size_t released = q.shrink();
+        EXPECT_GT(released, size_t(0));
+        for (size_t j = _params.queueSize / 2; j < _params.queueSize; ++j) {
+            ASSERT_TRUE(q.sc_dequeue(res));
+            ASSERT_EQ(res, j);
+        }
+        EXPECT_FALSE(q.sc_dequeue(res));
+        released += q.shrink();
+        EXPECT_EQ(q.allocated_nodes(), peak - released);
+        //only the newest chunk and those holding the queue and freelist sentinels are left
+        EXPECT_LE(q.allocated_nodes(), 3 * chunkSize + 2);
+        for (size_t j = 0; j < _params.queueSize; ++j) q.sp_enqueue(j);
+        for (size_t j = 0; j < _params.queueSize; ++j) {
+            ASSERT_TRUE(q.sc_dequeue(res));
+            ASSERT_EQ(res, j);
+        }
+    }
+
+    //single threaded, chunks are released automatically while the queue is drained past the reclaim threshold
+    template <typename T, typename R>
+    void ReclaimTest(size_t chunkSize, size_t reclaimThreshold) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        T q{ chunkSize, reclaimThreshold };
+        R res;
+        size_t count = 4 * reclaimThreshold;
+        for (size_t j = 0; j < count; ++j) q.sp_enqueue(j);
+        size_t peak = q.allocated_nodes();
+        for (size_t j = 0; j < count; ++j) {
+            ASSERT_TRUE(q.sc_dequeue(res));
+            ASSERT_EQ(res, j);
+        }
+        EXPECT_LE(q.allocated_nodes(), 2 * reclaimThreshold + 4 * chunkSize);
+        EXPECT_LT(q.allocated_nodes(), peak);
+    }
+
+    //readers and writers run while another thread repeatedly shrinks the queue, the sums of the items produced and
+    //consumed must match
+    template <typename T, typename R, typename... Args>
+    void ShrinkWhileRunningTest(Args&&... args) {
+        T q{ args... };
+        std::atomic<size_t> produced{ 0 };
+        std::atomic<size_t> consumed{ 0 };
+        std::atomic<bool> done{ false };
+        std::thread shrinker([&]() {
+            while (!done.load(std::memory_order_acquire)) {
+                q.shrink();
+                std::this_thread::yield();
+            }
+        });
+        RunThreads<T>(q, [&](T& q, size_t count) {
+            size_t sum = 0;
+            R res;
+            for (size_t j = 0; j < count; ++j) {
+                while (!q.mc_dequeue(res)) { std::this_thread::yield(); }
+                sum += res;
+            }
+            consumed += sum;
+        }, [&](T& q, size_t count) {
+            size_t sum = 0;
+            for (size_t j = 0; j < count; ++j) {
+                q.mp_enqueue(j);
+                sum += j;
+            }
+            produced += sum;
+        }, false);
+        done.store(true, std::memory_order_release);
+        shrinker.join();
+        EXPECT_EQ(consumed.load(), produced.load());
+    }
+
+    //writers reserve a slot, write the item in place and commit it
+    template <typename T, typename R, typename... Args>
+    void ReserveTest(Args&&... args) {
+        std::function<void(T&, R)> enqueueFunction = [](T& q, R item) {
+            typename T::write_reservation reservation;
+            while (!(reservation = q.mp_try_reserve_write())) { std::this_thread::yield(); }
+            *reservation = item;
+            q.commit(reservation);
+        };
+        GenericConsumeTest<T, R>(enqueueFunction, false, _params.queueSize, args...);
+    }
+
+    //as ReserveTest for queues that only support single producer reservations, only run with one writer
+    template <typename T, typename R, typename... Args>
+    void SpscReserveTest(Args&&... args) {
+        if (_params.nWriters != 1) return;
+        std::function<void(T&, R)> enqueueFunction = [](T& q, R item) {
+            typename T::write_reservation reservation;
+            while (!(reservation = q.sp_try_reserve_write())) { std::this_thread::yield(); }
+            *reservation = item;
+            q.commit(reservation);
+        };
+        GenericConsumeTest<T, R>(enqueueFunction, false, _params.queueSize, args...);
+    }
+
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
+        TimedTest(bool prefill, Args&&... args) {
+        auto dequeueFunction = generateDequeueFunctionTimed<T, R>();
+        auto enqueueFunction = generateEnqueueFunctionBlocking<T, R>();
+        GenericTest(dequeueFunction, enqueueFunction, prefill, args...);
+    }
+
+    template <typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::bounded_queue_typed_tag<R>, T>::value>
+        TimedTest(Args&&... args) {
+        auto dequeueFunction = generateDequeueFunctionTimed<T, R>();
+        auto enqueueFunction = generateEnqueueFunctionTimed<T, R>();
+        GenericTest(dequeueFunction, enqueueFunction, false, _params.queueSize, args...);
+    }
+
+    //readers collect batches of up to bulkSize items, each returned once full or 100us after it was started
+    template <typename T, typename R, typename... Args>
+    void BatchTest(bool prefill, Args&&... args) {
+        std::function<size_t(T&, R*, size_t)> dequeueFunction = [](T& q, R* items, size_t max) {
+            return q.mc_dequeue_batch_for(items, max, std::chrono::microseconds(100));
+        };
+        std::function<void(T&, R*, R*)> enqueueFunction = [](T& q, R* first, R* last) {
+            for (; first != last; ++first) q.mp_enqueue(*first);
+        };
+        GenericBulkTest(dequeueFunction, enqueueFunction, prefill, args...);
+    }
+
+    //single threaded, a batch is returned at the deadline with the items that arrived, and at once when full or closed
+    template <typename T, typename R, typename... Args>
+    void BatchDeadlineTest(Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        T q{ args... };
+        std::vector<R> items(bulkSize);
+        auto start = std::chrono::steady_clock::now();
+        EXPECT_EQ(q.mc_dequeue_batch_for(items.begin(), bulkSize, std::chrono::milliseconds(5)), size_t(0));
+        EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(5));
+        for (size_t j = 0; j < 3; ++j) q.mp_enqueue(R(j));
+        EXPECT_EQ(q.sc_dequeue_batch_for(items.begin(), bulkSize, std::chrono::milliseconds(5)), size_t(3));
+        EXPECT_EQ(items[2], R(2));
+        for (size_t j = 0; j < 3; ++j) q.mp_enqueue(R(j));
+        EXPECT_EQ(q.mc_dequeue_batch_for(items.begin(), 2, std::chrono::hours(1)), size_t(2));
+        q.close();
+        EXPECT_EQ(q.mc_dequeue_batch_for(items.begin(), bulkSize, std::chrono::hours(1)), size_t(1));
+        EXPECT_EQ(q.mc_dequeue_batch_for(items.begin(), bulkSize, std::chrono::hours(1)), size_t(0));
+    }
+
 };
 #endif /* CONCURRENT_QUEUE_TEST_H */
@@ -0,0 +1,294 @@
+/*
+ * File:   external_queue.h
+ * Author: Barath Kannan
+ * Adapters that give queues from other libraries the bk_conq interface, so the tests,
+ * the latency benchmark and QueueBenchmark run them exactly as they run the bk_conq queues.
+ * A binding wraps one external queue and provides:
+ *   value_type, the item type
+ *   bounded, true if the queue has a fixed capacity, given to its constructor
+ *   producer_cardinality and consumer_cardinality, as declared by the bk_conq queues
+ *   template <typename R> bool push(R&& item), false if a bounded queue is full
+ *   bool pop(value_type& item), false if the queue is empty
+ * external_queue<B> is the bounded or unbounded adapter of binding B.
+ * Bindings are only compiled for the libraries the build found, BK_CONQ_EXTERNAL_MOODYCAMEL,
+ * BK_CONQ_EXTERNAL_FOLLY and BK_CONQ_EXTERNAL_BOOST are defined for each of them.
+ * Created on 14 October 2026 11:59 PM
+ */
+
+#ifndef EXTERNAL_QUEUE_H
+#define EXTERNAL_QUEUE_H
+
+#include <memory>
+#include <type_traits>
+#include <bk_conq/bounded_queue.hpp>
+#include <bk_conq/unbounded_queue.hpp>
+#include <bk_conq/details/fast_tlos.hpp>
+#if defined(BK_CONQ_EXTERNAL_MOODYCAMEL)
+#include "concurrentqueue.h"
+#include "readerwriterqueue.h"
+#endif
+#if defined(BK_CONQ_EXTERNAL_FOLLY)
+#include <folly/MPMCQueue.h>
+#endif
+#if defined(BK_CONQ_EXTERNAL_BOOST)
+#include <boost/lockfree/queue.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#endif
+
+namespace external {
+
+//the single and multi operations are the same, an external queue only has the algorithm it was built with
+template <typename B>
+class bounded_adapter : public bk_conq::bounded_queue<typename B::value_type, bounded_adapter<B>, B::producer_cardinality, B::consumer_cardinality> {
+    friend bk_conq::bounded_queue<typename B::value_type, bounded_adapter<B>, B::producer_cardinality, B::consumer_cardinality>;
+    typedef typename B::value_type T;
+
+public:
+    explicit bounded_adapter(size_t capacity) : _q(capacity) {}
+
+    bounded_adapter(const bounded_adapter&) = delete;
+    void operator=(const bounded_adapter&) = delete;
+
+protected:
+    template <typename R>
+    bool sp_enqueue_impl(R&& item) {
+        return _q.push(std::forward<R>(item));
+    }
+
+    template <typename R>
+    bool mp_enqueue_impl(R&& item) {
+        return _q.push(std::forward<R>(item));
+    }
+
+    bool sc_dequeue_impl(T& item) {
+        return _q.pop(item);
+    }
+
+    bool mc_dequeue_impl(T& item) {
+        return _q.pop(item);
+    }
+
+    bool mc_dequeue_uncontended_impl(T& item) {
+        return _q.pop(item);
+    }
+
+private:
+    B _q;
+};
+
+template <typename B>
+class unbounded_adapter : public bk_conq::unbounded_queue<typename B::value_type, unbounded_adapter<B>, B::producer_cardinality, B::consumer_cardinality> {
+    friend bk_conq::unbounded_queue<typename B::value_type, unbounded_adapter<B>, B::producer_cardinality, B::consumer_cardinality>;
+    typedef typename B::value_type T;
+
+public:
+    unbounded_adapter() = default;
+
+    unbounded_adapter(const unbounded_adapter&) = delete;
+    void operator=(const unbounded_adapter&) = delete;
+
+protected:
+    template <typename R>
+    void sp_enqueue_impl(R&& item) {
+        _q.push(std::forward<R>(item));
+    }
+
+    template <typename R>
+    void mp_enqueue_impl(R&& item) {
+        _q.push(std::forward<R>(item));
+    }
+
+    bool sc_dequeue_impl(T& item) {
+        return _q.pop(item);
+    }
+
+    bool mc_dequeue_impl(T& item) {
+        return _q.pop(item);
+    }
+
+    bool mc_dequeue_uncontended_impl(T& item) {
+        return _q.pop(item);
+    }
+
+private:
+    B _q;
+};
+
+template <typename B>
+using external_queue = std::conditional_t<B::bounded, bounded_adapter<B>, unbounded_adapter<B>>;
+
+#if defined(BK_CONQ_EXTERNAL_MOODYCAMEL)
+template <typename T>
+class moodycamel_queue {
+public:
+    typedef T value_type;
+    static constexpr bool bounded = false;
+    static constexpr bk_conq::producers producer_cardinality = bk_conq::producers::multi;
+    static constexpr bk_conq::consumers consumer_cardinality = bk_conq::consumers::multi;
+
+    template <typename R>
+    bool push(R&& item) {
+        return _q.enqueue(std::forward<R>(item));
+    }
+
+    bool pop(T& item) {
+        return _q.try_dequeue(item);
+    }
+
+private:
+    moodycamel::ConcurrentQueue<T> _q;
+};
+
+//every thread holds a producer and a consumer token for each queue, created on its first operation
+template <typename T>
+class moodycamel_token_queue {
+public:
+    typedef T value_type;
+    static constexpr bool bounded = false;
+    static constexpr bk_conq::producers producer_cardinality = bk_conq::producers::multi;
+    static constexpr bk_conq::consumers consumer_cardinality = bk_conq::consumers::multi;
+
+    moodycamel_token_queue() :
+        _producer(*this, [](moodycamel_token_queue& q) { return std::make_unique<moodycamel::ProducerToken>(q._q); }),
+        _consumer(*this, [](moodycamel_token_queue& q) { return std::make_unique<moodycamel::ConsumerToken>(q._q); })
+    {}
+
+    template <typename R>
+    bool push(R&& item) {
+        return _q.enqueue(*_producer.get(), std::forward<R>(item));
+    }
+
+    bool pop(T& item) {
+        return _q.try_dequeue(*_consumer.get(), item);
+    }
+
+private:
+    moodycamel::ConcurrentQueue<T> _q;
+    bk_conq::details::fast_tlos<std::unique_ptr<moodycamel::ProducerToken>, moodycamel_token_queue> _producer;
+    bk_conq::details::fast_tlos<std::unique_ptr<moodycamel::ConsumerToken>, moodycamel_token_queue> _consumer;
+};
+
+//the blocks for capacity items are allocated up front and try_enqueue never allocates more,
+//the queue can report full before it holds capacity items when they are spread over many producers
+template <typename T>
+class moodycamel_bounded_queue {
+public:
+    typedef T value_type;
+    static constexpr bool bounded = true;
+    static constexpr bk_conq::producers producer_cardinality = bk_conq::producers::multi;
+    static constexpr bk_conq::consumers consumer_cardinality = bk_conq::consumers::multi;
+
+    explicit moodycamel_bounded_queue(size_t capacity) : _q(capacity) {}
+
+    template <typename R>
+    bool push(R&& item) {
+        return _q.try_enqueue(std::forward<R>(item));
+    }
+
+    bool pop(T& item) {
+        return _q.try_dequeue(item);
+    }
+
+private:
+    moodycamel::ConcurrentQueue<T> _q;
+};
+
+template <typename T>
+class moodycamel_reader_writer_queue {
+public:
+    typedef T value_type;
+    static constexpr bool bounded = false;
+    static constexpr bk_conq::producers producer_cardinality = bk_conq::producers::single;
+    static constexpr bk_conq::consumers consumer_cardinality = bk_conq::consumers::single;
+
+    template <typename R>
+    bool push(R&& item) {
+        return _q.enqueue(std::forward<R>(item));
+    }
+
+    bool pop(T& item) {
+        return _q.try_dequeue(item);
+    }
+
+private:
+    moodycamel::ReaderWriterQueue<T> _q;
+};
+#endif
+
+#if defined(BK_CONQ_EXTERNAL_FOLLY)
+template <typename T>
+class folly_mpmc_queue {
+public:
+    typedef T value_type;
+    static constexpr bool bounded = true;
+    static constexpr bk_conq::producers producer_cardinality = bk_conq::producers::multi;
+    static constexpr bk_conq::consumers consumer_cardinality = bk_conq::consumers::multi;
+
+    explicit folly_mpmc_queue(size_t capacity) : _q(capacity) {}
+
+    template <typename R>
+    bool push(R&& item) {
+        return _q.write(std::forward<R>(item));
+    }
+
+    bool pop(T& item) {
+        return _q.read(item);
+    }
+
+private:
+    folly::MPMCQueue<T> _q;
+};
+#endif
+
+#if defined(BK_CONQ_EXTERNAL_BOOST)
+template <typename T>
+class boost_lockfree_queue {
+public:
+    typedef T value_type;
+    static constexpr bool bounded = true;
+    static constexpr bk_conq::producers producer_cardinality = bk_conq::producers::multi;
+    static constexpr bk_conq::consumers consumer_cardinality = bk_conq::consumers::multi;
+
+    //the nodes are allocated up front, bounded_push never allocates more
+    explicit boost_lockfree_queue(size_t capacity) : _q(capacity) {}
+
+    template <typename R>
+    bool push(R&& item) {
+        return _q.bounded_push(item);
+    }
+
+    bool pop(T& item) {
+        return _q.pop(item);
+    }
+
+private:
+    boost::lockfree::queue<T> _q;
+};
+
+template <typename T>
+class boost_spsc_queue {
+public:
+    typedef T value_type;
+    static constexpr bool bounded = true;
+    static constexpr bk_conq::producers producer_cardinality = bk_conq::producers::single;
+    static constexpr bk_conq::consumers consumer_cardinality = bk_conq::consumers::single;
+
+    explicit boost_spsc_queue(size_t capacity) : _q(capacity) {}
+
+    template <typename R>
+    bool push(R&& item) {
+        return _q.push(item);
+    }
+
+    bool pop(T& item) {
+        return _q.pop(item);
+    }
+
+private:
+    boost::lockfree::spsc_queue<T> _q;
+};
+#endif
+
+}//namespace external
+
+#endif /* EXTERNAL_QUEUE_H */
@@ -0,0 +1,60 @@
+#include "concurrent_queue_test.h"
+#include "external_queue.h"
+
+namespace ExternalQueue {
+#if defined(BK_CONQ_EXTERNAL_MOODYCAMEL)
+    using qtype = external::external_queue<external::moodycamel_queue<QueueTest::queue_test_type_t>>;
+    using tqtype = external::external_queue<external::moodycamel_token_queue<QueueTest::queue_test_type_t>>;
+    using boundqtype = external::external_queue<external::moodycamel_bounded_queue<QueueTest::queue_test_type_t>>;
+    using rwqtype = external::external_queue<external::moodycamel_reader_writer_queue<QueueTest::queue_test_type_t>>;
+
+    TEST_P(QueueTest, moody_queue) {
+        QueueTest::TemplatedTest<qtype, queue_test_type_t>(false);
+    }
+
+    TEST_P(QueueTest, moody_queue_prefill) {
+        QueueTest::TemplatedTest<qtype, queue_test_type_t>(true);
+    }
+
+    TEST_P(QueueTest, moody_queue_tokenized) {
+        QueueTest::TemplatedTest<tqtype, queue_test_type_t>(false);
+    }
+
+    TEST_P(QueueTest, moody_queue_tokenized_prefill) {
+        QueueTest::TemplatedTest<tqtype, queue_test_type_t>(true);
+    }
+
+    TEST_P(QueueTest, moody_queue_bounded) {
+        QueueTest::TemplatedTest<boundqtype, queue_test_type_t>();
+    }
+
+    TEST_P(QueueTest, moody_reader_writer_queue) {
+        QueueTest::CardinalityTest<rwqtype, queue_test_type_t>(false);
+    }
+
+    TEST_P(QueueTest, moody_reader_writer_queue_prefill) {
+        QueueTest::CardinalityTest<rwqtype, queue_test_type_t>(true);
+    }
+#endif
+
+#if defined(BK_CONQ_EXTERNAL_FOLLY)
+    using fqtype = external::external_queue<external::folly_mpmc_queue<QueueTest::queue_test_type_t>>;
+
+    TEST_P(QueueTest, folly_mpmc_queue) {
+        QueueTest::TemplatedTest<fqtype, queue_test_type_t>();
+    }
+#endif
+
+#if defined(BK_CONQ_EXTERNAL_BOOST)
+    using bqtype = external::external_queue<external::boost_lockfree_queue<QueueTest::queue_test_type_t>>;
+    using bsqtype = external::external_queue<external::boost_spsc_queue<QueueTest::queue_test_type_t>>;
+
+    TEST_P(QueueTest, boost_lockfree_queue) {
+        QueueTest::TemplatedTest<bqtype, queue_test_type_t>();
+    }
+
+    TEST_P(QueueTest, boost_spsc_queue) {
+        QueueTest::SpscTest<bsqtype, queue_test_type_t>();
+    }
+#endif
+}
@@ -0,0 +1,79 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <iomanip>
+
+constexpr size_t latency_histogram::exact_bits;
+constexpr size_t latency_histogram::exact_count;
+constexpr size_t latency_histogram::sub_count;
+constexpr size_t latency_histogram::bucket_count;
+
+latency_histogram::latency_histogram()
+    : counts(bucket_count, 0) {}
+
+void latency_histogram::record(uint64_t nanoseconds) {
+    ++counts[bucketIndex(nanoseconds)];
+    ++count;
+    total += static_cast<double>(nanoseconds);
+    if (nanoseconds > max) max = nanoseconds;
+}
+
+void latency_histogram::merge(const latency_histogram& other) {
+    for (size_t i = 0; i < bucket_count; ++i) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    total += other.total;
+    max = std::max(max, other.max);
+}
+
+uint64_t latency_histogram::getCount() const {
+    return count;
+}
+
+uint64_t latency_histogram::getMax() const {
+    return max;
+}
+
+double latency_histogram::getMean() const {
+    return count ? total / static_cast<double>(count) : 0.0;
+}
+
+uint64_t latency_histogram::getValueAtPercentile(double percentile) const {
+    if (!count) return 0;
+    uint64_t target = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count) + 0.5);
+    target = std::min(std::max(target, uint64_t(1)), count);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+        seen += counts[i];
+        if (seen >= target) return std::min(bucketHighest(i), max);
+    }
+    return max;
+}
+
+//values of 2^exact_bits and above keep their top exact_bits - 1 bits below the leading bit
+size_t latency_histogram::bucketIndex(uint64_t value) {
+    if (value < exact_count) return static_cast<size_t>(value);
+    size_t msb = 0;
+    for (uint64_t v = value; v >>= 1; ) ++msb;
+    size_t shift = msb - (exact_bits - 1);
+    return exact_count + (shift - 1) * sub_count + static_cast<size_t>((value >> shift) - sub_count);
+}
+
+uint64_t latency_histogram::bucketHighest(size_t index) {
+    if (index < exact_count) return index;
+    size_t shift = (index - exact_count) / sub_count + 1;
+    uint64_t mantissa = (index - exact_count) % sub_count + sub_count;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+std::ostream& operator<< (std::ostream& os, const latency_histogram& lh) {
+    static const double percentiles[] = { 50.0, 90.0, 99.0, 99.9, 99.99, 99.999 };
+    os << "Samples: " << lh.getCount() << std::endl;
+    os << "Mean: " << lh.getMean() << " ns" << std::endl;
+    os << std::setw(12) << "Percentile" << std::setw(16) << "Latency (ns)" << std::endl;
+    for (double p : percentiles) {
+        os << std::setw(12) << p << std::setw(16) << lh.getValueAtPercentile(p) << std::endl;
+    }
+    os << std::setw(12) << "Max" << std::setw(16) << lh.getMax() << std::endl;
+    return os;
+}
@@ -0,0 +1,51 @@
+/*
+ * File:   latency_histogram.h
+ * Author: Barath Kannan
+ * Log-linear histogram of latencies in nanoseconds, in the style of HdrHistogram.
+ * Values below 128 are recorded exactly, larger values in 64 sub-buckets per power
+ * of 2, so a recorded value is reported to within 1/64 of itself. Recording is a
+ * single increment, histograms are kept per thread and merged once a run has ended.
+ * Created on 14 October 2026 11:59 PM
+ */
+
+#ifndef BK_CONQ_LATENCYHISTOGRAM_H
+#define BK_CONQ_LATENCYHISTOGRAM_H
+
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+
+class latency_histogram {
+public:
+    latency_histogram();
+
+    void record(uint64_t nanoseconds);
+    void merge(const latency_histogram& other);
+
+    uint64_t getCount() const;
+    uint64_t getMax() const;
+    double getMean() const;
+
+    //the highest value that is equivalent to the value at the given percentile (0 to 100)
+    uint64_t getValueAtPercentile(double percentile) const;
+
+    //prints a percentile table
+    friend std::ostream& operator<< (std::ostream& os, const latency_histogram& lh);
+
+private:
+    static constexpr size_t exact_bits = 7;
+    static constexpr size_t exact_count = size_t(1) << exact_bits;
+    static constexpr size_t sub_count = exact_count / 2;
+    static constexpr size_t bucket_count = exact_count + (64 - exact_bits) * sub_count;
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketHighest(size_t index);
+
+    std::vector<uint64_t> counts;
+    uint64_t count{ 0 };
+    uint64_t max{ 0 };
+    double total{ 0 };
+};
+
+#endif /* BK_CONQ_LATENCYHISTOGRAM_H */
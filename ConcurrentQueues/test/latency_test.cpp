@@ -0,0 +1,180 @@
+#include "latency_test.h"
+#include "external_queue.h"
+#include <iostream>
+
+using ::testing::Values;
+using ::testing::Combine;
+using std::cout;
+using std::endl;
+
+void LatencyTest::SetUp() {
+    auto tupleParams = GetParam();
+    _params = LatencyParameters{ ::testing::get<0>(tupleParams), ::testing::get<1>(tupleParams), ::testing::get<2>(tupleParams), ::testing::get<3>(tupleParams), ::testing::get<4>(tupleParams), ::testing::get<5>(tupleParams), ::testing::get<6>(tupleParams) };
+    histograms.resize(_params.nReaders);
+    cout << "Readers: " << _params.nReaders << endl;
+    cout << "Writers: " << _params.nWriters << endl;
+    cout << "Elements: " << _params.nElements << endl;
+    cout << "Queue Size: " << _params.queueSize << endl;
+    cout << "Subqueue Size: " << _params.subqueueSize << endl;
+    cout << "Rate: ";
+    if (_params.rate) cout << _params.rate << " items/second/writer (open loop)";
+    else cout << "saturated (closed loop)";
+    cout << endl;
+    cout << "Test Type: ";
+    switch (_params.testType) {
+    case BUSY_TEST: cout << "Busy Test"; break;
+    case YIELD_TEST: cout << "Yield Test"; break;
+    case SLEEP_TEST: cout << "Sleep Test"; break;
+    case BACKOFF_TEST: cout << "Backoff Test"; break;
+    default: break;
+    }
+    cout << endl;
+}
+
+void LatencyTest::TearDown() {
+    latency_histogram merged;
+    for (const latency_histogram& h : histograms) {
+        merged.merge(h);
+    }
+    cout << "Enqueue to dequeue latency:" << endl;
+    cout << merged;
+}
+
+namespace Latency {
+using vqtype = bk_conq::vector_queue<LatencyTest::latency_test_type_t>;
+using svqtype = bk_conq::spsc_vector_queue<LatencyTest::latency_test_type_t>;
+using blqtype = bk_conq::bounded_list_queue<LatencyTest::latency_test_type_t>;
+using lqtype = bk_conq::list_queue<LatencyTest::latency_test_type_t>;
+using cqtype = bk_conq::chain_queue<LatencyTest::latency_test_type_t>;
+using sqtype = bk_conq::segment_queue<LatencyTest::latency_test_type_t>;
+using mvqtype = bk_conq::multi_bounded_queue<vqtype>;
+using mlqtype = bk_conq::multi_unbounded_queue<lqtype>;
+using mcqtype = bk_conq::multi_unbounded_queue<cqtype>;
+using bvqtype = bk_conq::blocking_bounded_queue<vqtype>;
+using bcvqtype = bk_conq::blocking_bounded_queue<vqtype, bk_conq::condition_variable_wait_policy>;
+using bsvqtype = bk_conq::blocking_bounded_queue<vqtype, bk_conq::spin_wait_policy<>>;
+using blqbtype = bk_conq::blocking_unbounded_queue<lqtype>;
+using bclqtype = bk_conq::blocking_unbounded_queue<lqtype, bk_conq::condition_variable_wait_policy>;
+using bslqtype = bk_conq::blocking_unbounded_queue<lqtype, bk_conq::spin_wait_policy<>>;
+#if defined(BK_CONQ_EXTERNAL_MOODYCAMEL)
+using moodyqtype = external::external_queue<external::moodycamel_queue<LatencyTest::latency_test_type_t>>;
+using moodytqtype = external::external_queue<external::moodycamel_token_queue<LatencyTest::latency_test_type_t>>;
+using moodybqtype = external::external_queue<external::moodycamel_bounded_queue<LatencyTest::latency_test_type_t>>;
+using moodyrwqtype = external::external_queue<external::moodycamel_reader_writer_queue<LatencyTest::latency_test_type_t>>;
+#endif
+#if defined(BK_CONQ_EXTERNAL_FOLLY)
+using follyqtype = external::external_queue<external::folly_mpmc_queue<LatencyTest::latency_test_type_t>>;
+#endif
+#if defined(BK_CONQ_EXTERNAL_BOOST)
+using boostqtype = external::external_queue<external::boost_lockfree_queue<LatencyTest::latency_test_type_t>>;
+using boostsqtype = external::external_queue<external::boost_spsc_queue<LatencyTest::latency_test_type_t>>;
+#endif
+
+TEST_P(LatencyTest, vector_queue) {
+    LatencyTest::LatencyBenchmark<vqtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, spsc_vector_queue) {
+    LatencyTest::SpscLatencyBenchmark<svqtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, bounded_list_queue) {
+    LatencyTest::LatencyBenchmark<blqtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, list_queue) {
+    LatencyTest::LatencyBenchmark<lqtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, chain_queue) {
+    LatencyTest::LatencyBenchmark<cqtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, segment_queue) {
+    LatencyTest::LatencyBenchmark<sqtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, multi_vector_queue) {
+    LatencyTest::LatencyBenchmark<mvqtype, latency_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(LatencyTest, multi_list_queue) {
+    LatencyTest::LatencyBenchmark<mlqtype, latency_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(LatencyTest, multi_chain_queue) {
+    LatencyTest::LatencyBenchmark<mcqtype, latency_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(LatencyTest, vector_queue_blocking) {
+    LatencyTest::BlockingLatencyBenchmark<bvqtype, latency_test_type_t>(_params.queueSize);
+}
+
+TEST_P(LatencyTest, vector_queue_blocking_condvar) {
+    LatencyTest::BlockingLatencyBenchmark<bcvqtype, latency_test_type_t>(_params.queueSize);
+}
+
+TEST_P(LatencyTest, vector_queue_blocking_spin) {
+    LatencyTest::BlockingLatencyBenchmark<bsvqtype, latency_test_type_t>(_params.queueSize);
+}
+
+TEST_P(LatencyTest, list_queue_blocking) {
+    LatencyTest::BlockingLatencyBenchmark<blqbtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, list_queue_blocking_condvar) {
+    LatencyTest::BlockingLatencyBenchmark<bclqtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, list_queue_blocking_spin) {
+    LatencyTest::BlockingLatencyBenchmark<bslqtype, latency_test_type_t>();
+}
+
+#if defined(BK_CONQ_EXTERNAL_MOODYCAMEL)
+TEST_P(LatencyTest, moody_queue) {
+    LatencyTest::LatencyBenchmark<moodyqtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, moody_queue_tokenized) {
+    LatencyTest::LatencyBenchmark<moodytqtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, moody_queue_bounded) {
+    LatencyTest::LatencyBenchmark<moodybqtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, moody_reader_writer_queue) {
+    LatencyTest::LatencyBenchmark<moodyrwqtype, latency_test_type_t>();
+}
+#endif
+
+#if defined(BK_CONQ_EXTERNAL_FOLLY)
+TEST_P(LatencyTest, folly_mpmc_queue) {
+    LatencyTest::LatencyBenchmark<follyqtype, latency_test_type_t>();
+}
+#endif
+
+#if defined(BK_CONQ_EXTERNAL_BOOST)
+TEST_P(LatencyTest, boost_lockfree_queue) {
+    LatencyTest::LatencyBenchmark<boostqtype, latency_test_type_t>();
+}
+
+TEST_P(LatencyTest, boost_spsc_queue) {
+    LatencyTest::LatencyBenchmark<boostsqtype, latency_test_type_t>();
+}
+#endif
+
+}
+
+INSTANTIATE_TEST_CASE_P(
+    latency_benchmark,
+    LatencyTest,
+    testing::Combine(
+        Values(1, 2, 4, 8, 16), //readers
+        Values(1, 2, 4, 8, 16), //writers
+        Values(size_t(1e5), size_t(1e6), size_t(1e7)), //elements
+        Values(8192, 131072, 2097152), //queue size (bounded only)
+        Values(4, 16), //subqueue size (multiqueue only)
+        Values(0, 10000, 100000, 1000000), //rate per writer, 0 for closed loop
+        Values(QueueTestType::BUSY_TEST, QueueTestType::YIELD_TEST, QueueTestType::SLEEP_TEST, QueueTestType::BACKOFF_TEST)) //test type
+);
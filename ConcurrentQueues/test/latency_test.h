@@ -0,0 +1,178 @@
+/*
+ * File:   latency_test.h
+ * Author: Barath Kannan
+ * Enqueue to dequeue latency benchmark. Each item is the steady_clock time at which
+ * it was meant to be enqueued, and every reader records the time from then until it
+ * dequeued the item into its own latency_histogram.
+ * With a rate of 0 the writers enqueue as fast as they can (closed loop). Otherwise
+ * each writer enqueues on a fixed schedule of rate items per second (open loop), and
+ * items are stamped with their scheduled time rather than the time they were actually
+ * enqueued, so that a writer held up by the queue does not hide the delay it caused.
+ * Created on 14 October 2026 11:59 PM
+ */
+
+#ifndef LATENCY_TEST_H
+#define LATENCY_TEST_H
+
+#include "concurrent_queue_test.h"
+#include "latency_histogram.h"
+#include <chrono>
+#include <cstdint>
+
+struct LatencyParameters {
+    size_t nReaders;
+    size_t nWriters;
+    size_t nElements;
+    size_t queueSize;
+    size_t subqueueSize;
+    size_t rate;
+    QueueTestType testType;
+};
+
+class LatencyTest : public testing::Test,
+    public testing::WithParamInterface< ::testing::tuple<size_t, size_t, size_t, size_t, size_t, size_t, QueueTestType> > {
+public:
+    typedef uint64_t latency_test_type_t;
+
+    virtual void SetUp();
+    virtual void TearDown();
+protected:
+    std::vector<latency_histogram> histograms;
+    LatencyParameters _params;
+    std::atomic<bool> _startFlag{ false };
+    std::atomic<size_t> _sync{ 0 };
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    //the writers share a start time, so their schedules are aligned
+    template<typename T>
+    void RunLatencyThreads(T& q, std::function<void(T&, latency_test_type_t&)> dequeueOperation, std::function<void(T&, latency_test_type_t)> enqueueOperation) {
+        std::vector<std::thread> l;
+        std::atomic<uint64_t> start{ 0 };
+        for (size_t i = 0; i < _params.nReaders; ++i) {
+            l.emplace_back([&, i]() {
+                ++_sync;
+                while (!_startFlag.load(std::memory_order_acquire)) { std::this_thread::yield(); };
+                size_t count = _params.nElements / _params.nReaders;
+                if (i == 0) count += _params.nElements - ((_params.nElements / _params.nReaders) * _params.nReaders);
+                latency_test_type_t stamp;
+                for (size_t j = 0; j < count; ++j) {
+                    dequeueOperation(q, stamp);
+                    uint64_t t = now();
+                    histograms[i].record(t > stamp ? t - stamp : 0);
+                }
+            });
+        }
+        for (size_t i = 0; i < _params.nWriters; ++i) {
+            l.emplace_back([&, i]() {
+                ++_sync;
+                while (!_startFlag.load(std::memory_order_acquire)) { std::this_thread::yield(); };
+                size_t count = _params.nElements / _params.nWriters;
+                if (i == 0) count += _params.nElements - ((_params.nElements / _params.nWriters) * _params.nWriters);
+                uint64_t begin = start.load(std::memory_order_relaxed);
+                for (size_t j = 0; j < count; ++j) {
+                    if (_params.rate) {
+                        uint64_t scheduled = begin + (j * 1000000000ull) / _params.rate;
+                        while (now() < scheduled) { std::this_thread::yield(); }
+                        enqueueOperation(q, scheduled);
+                    }
+                    else {
+                        enqueueOperation(q, now());
+                    }
+                }
+            });
+        }
+        while (_sync.load() != _params.nWriters + _params.nReaders) { std::this_thread::yield(); };
+        start.store(now(), std::memory_order_relaxed);
+        _startFlag.store(true, std::memory_order_release);
+        for (auto& t : l) {
+            t.join();
+        }
+    }
+
+    template <typename STRATEGY>
+    auto generateStrategyDequeue() {
+        return ([](auto& q, auto& item) {
+            STRATEGY strategy;
+            while (!q.mc_dequeue(item)) { strategy.wait(); }
+        });
+    }
+
+    template <typename STRATEGY>
+    auto generateStrategyEnqueue() {
+        return ([](auto& q, auto item) {
+            STRATEGY strategy;
+            while (!q.mp_enqueue(item)) { strategy.wait(); }
+        });
+    }
+
+    template<typename T, typename R>
+    std::function<void(T&, R&)> generateDequeueFunction() {
+        switch (_params.testType) {
+        case BUSY_TEST: return generateStrategyDequeue<bk_conq::busy_spin_strategy>();
+        case YIELD_TEST: return generateStrategyDequeue<bk_conq::yield_strategy>();
+        case SLEEP_TEST: return generateStrategyDequeue<QueueTest::sleep_strategy>();
+        case BACKOFF_TEST: return generateStrategyDequeue<QueueTest::sleep_backoff_strategy>();
+        default: return generateStrategyDequeue<bk_conq::busy_spin_strategy>();
+        }
+    }
+
+    template<typename T, typename R>
+    std::function<void(T&, R)> generateEnqueueFunction() {
+        switch (_params.testType) {
+        case BUSY_TEST: return generateStrategyEnqueue<bk_conq::busy_spin_strategy>();
+        case YIELD_TEST: return generateStrategyEnqueue<bk_conq::yield_strategy>();
+        case SLEEP_TEST: return generateStrategyEnqueue<QueueTest::sleep_strategy>();
+        case BACKOFF_TEST: return generateStrategyEnqueue<QueueTest::sleep_backoff_strategy>();
+        default: return generateStrategyEnqueue<bk_conq::busy_spin_strategy>();
+        }
+    }
+
+    //a queue declared with a single producer or consumer only runs with one writer or reader
+    template <typename T>
+    bool CardinalityAllows() {
+        if (T::producer_cardinality == bk_conq::producers::single && _params.nWriters != 1) return false;
+        if (T::consumer_cardinality == bk_conq::consumers::single && _params.nReaders != 1) return false;
+        return true;
+    }
+
+    template<typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::unbounded_queue_typed_tag<R>, T>::value>
+        LatencyBenchmark(Args&&... args) {
+        if (!CardinalityAllows<T>()) return;
+        T q{ args... };
+        RunLatencyThreads<T>(q, generateDequeueFunction<T, R>(), [](T& q, R item) { q.mp_enqueue(item); });
+    }
+
+    template<typename T, typename R, typename... Args>
+    typename std::enable_if_t<std::is_base_of<bk_conq::bounded_queue_typed_tag<R>, T>::value>
+        LatencyBenchmark(Args&&... args) {
+        if (!CardinalityAllows<T>()) return;
+        T q{ _params.queueSize, args... };
+        RunLatencyThreads<T>(q, generateDequeueFunction<T, R>(), generateEnqueueFunction<T, R>());
+    }
+
+    //the spsc queue only supports a single reader and writer
+    template<typename T, typename R, typename... Args>
+    void SpscLatencyBenchmark(Args&&... args) {
+        if (_params.nReaders != 1 || _params.nWriters != 1) return;
+        T q{ _params.queueSize, args... };
+        RunLatencyThreads<T>(q, [](T& q, R& item) {
+            bk_conq::yield_strategy strategy;
+            while (!q.sc_dequeue(item)) { strategy.wait(); }
+        }, [](T& q, R item) {
+            bk_conq::yield_strategy strategy;
+            while (!q.sp_enqueue(item)) { strategy.wait(); }
+        });
+    }
+
+    //blocking adapters wait with their wait policy rather than the test type's strategy
+    template<typename T, typename R, typename... Args>
+    void BlockingLatencyBenchmark(Args&&... args) {
+        T q{ args... };
+        RunLatencyThreads<T>(q, [](T& q, R& item) { q.mc_dequeue(item); }, [](T& q, R item) { q.mp_enqueue(item); });
+    }
+};
+#endif /* LATENCY_TEST_H */
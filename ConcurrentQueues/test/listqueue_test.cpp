@@ -3,8 +3,44 @@
 namespace ListQueue {
 using qtype = bk_conq::list_queue<QueueTest::queue_test_type_t>;
 using mqtype = bk_conq::multi_unbounded_queue<qtype>;
+using eqtype = bk_conq::list_queue<MoveOnlyThing>;
+using meqtype = bk_conq::multi_unbounded_queue<eqtype>;
+using smeqtype = bk_conq::multi_unbounded_queue<eqtype, eqtype::value_type, bk_conq::round_robin_assignment, bk_conq::stealing_dequeue<>>;
 using bqtype = bk_conq::blocking_unbounded_queue<qtype>;
 using bmqtype = bk_conq::blocking_unbounded_queue<mqtype>;
+using bcqtype = bk_conq::blocking_unbounded_queue<qtype, bk_conq::condition_variable_wait_policy>;
+using bsqtype = bk_conq::blocking_unbounded_queue<qtype, bk_conq::spin_wait_policy<>>;
+using spqtype = bk_conq::list_queue<QueueTest::queue_test_type_t, bk_conq::busy_spin_strategy>;
+using nmqtype = bk_conq::multi_unbounded_queue<qtype, qtype::value_type, bk_conq::numa_assignment>;
+using smqtype = bk_conq::multi_unbounded_queue<qtype, qtype::value_type, bk_conq::round_robin_assignment, bk_conq::stealing_dequeue<>>;
+using rmqtype = bk_conq::multi_unbounded_queue<qtype, qtype::value_type, bk_conq::random_assignment, bk_conq::two_choice_dequeue>;
+using prqtype = bk_conq::multi_priority_queue<qtype, 3>;
+using stqtype = bk_conq::list_queue<QueueTest::queue_test_type_t, bk_conq::yield_strategy, bk_conq::sharded_stats<>>;
+using smstqtype = bk_conq::multi_unbounded_queue<stqtype, stqtype::value_type, bk_conq::round_robin_assignment, bk_conq::hitlist_dequeue, bk_conq::sharded_stats<>>;
+using amqtype = bk_conq::multi_unbounded_queue<stqtype, stqtype::value_type, bk_conq::round_robin_assignment, bk_conq::hitlist_dequeue>;
+using asmqtype = bk_conq::multi_unbounded_queue<stqtype, stqtype::value_type, bk_conq::round_robin_assignment, bk_conq::stealing_dequeue<>>;
+using cardqtype = bk_conq::list_queue<QueueTest::queue_test_type_t, bk_conq::yield_strategy, bk_conq::no_stats, bk_conq::producers::single, bk_conq::consumers::single>;
+using cardmqtype = bk_conq::multi_unbounded_queue<qtype, qtype::value_type, bk_conq::round_robin_assignment, bk_conq::hitlist_dequeue, bk_conq::no_stats, bk_conq::producers::single>;
+
+//chunk size and free node threshold used by the reclaiming tests
+static const size_t reclaimChunkSize = 256;
+static const size_t reclaimThreshold = 65536;
+
+//small chunks, so that the shrink tests release many of them
+static const size_t shrinkChunkSize = 32;
+
+//several times the number of subqueues a stealing consumer probes before sweeping
+static const size_t sweepSubqueues = 16;
+
+//queues destroyed while short lived threads exit, and the threads exiting each time
+static const size_t exitRounds = 64;
+static const size_t exitThreads = 16;
+
+//starvation ratio used by the priority tests
+static const size_t starvationRatio = 4;
+
+//items handed between a producer and a consumer one at a time by the priority recovery tests
+static const size_t priorityItems = 10000;
 
 TEST_P(QueueTest, list_queue) {
     QueueTest::TemplatedTest<qtype, queue_test_type_t>(false);
@@ -14,10 +50,78 @@ TEST_P(QueueTest, list_queue_blocking) {
     QueueTest::BlockingTest<bqtype, queue_test_type_t>(false);
 }
 
+TEST_P(QueueTest, list_queue_blocking_condvar) {
+    QueueTest::BlockingTest<bcqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, list_queue_blocking_spin) {
+    QueueTest::BlockingTest<bsqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, list_queue_busy_spin) {
+    QueueTest::TemplatedTest<spqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, list_queue_blocking_timed) {
+    QueueTest::TimedTest<bqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, list_queue_blocking_batch) {
+    QueueTest::BatchTest<bqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_list_queue_blocking_batch) {
+    QueueTest::BatchTest<bmqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, list_queue_blocking_batch_deadline) {
+    QueueTest::BatchDeadlineTest<bqtype, queue_test_type_t>();
+}
+
 TEST_P(QueueTest, multi_list_queue) {
     QueueTest::TemplatedTest<mqtype, queue_test_type_t>(false, _params.subqueueSize);
 }
 
+TEST_P(QueueTest, list_queue_size) {
+    QueueTest::SizeTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_list_queue_size) {
+    QueueTest::SizeTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, list_queue_emplace) {
+    QueueTest::EmplaceTest<eqtype, MoveOnlyThing>();
+}
+
+TEST_P(QueueTest, multi_list_queue_emplace) {
+    QueueTest::EmplaceTest<meqtype, MoveOnlyThing>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, list_queue_consume) {
+    QueueTest::ConsumeTest<qtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_list_queue_consume) {
+    QueueTest::ConsumeTest<mqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, list_queue_cardinality) {
+    QueueTest::CardinalityTest<cardqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_list_queue_cardinality) {
+    QueueTest::CardinalityTest<cardmqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, list_queue_stats) {
+    QueueTest::StatsTest<stqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_list_queue_stats) {
+    QueueTest::StatsTest<smstqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
 TEST_P(QueueTest, multi_list_queue_blocking) {
     QueueTest::BlockingTest<bmqtype, queue_test_type_t>(false, _params.subqueueSize);
 }
@@ -38,4 +142,113 @@ TEST_P(QueueTest, multi_list_queue_blocking_prefill) {
     QueueTest::BlockingTest<bmqtype, queue_test_type_t>(true, _params.subqueueSize);
 }
 
-}
\ No newline at end of file
+TEST_P(QueueTest, list_queue_bulk) {
+    QueueTest::BulkTest<qtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_list_queue_bulk) {
+    QueueTest::BulkTest<mqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, list_queue_reclaim) {
+    QueueTest::TemplatedTest<qtype, queue_test_type_t>(false, reclaimChunkSize, reclaimThreshold);
+}
+
+TEST_P(QueueTest, list_queue_reclaim_prefill) {
+    QueueTest::TemplatedTest<qtype, queue_test_type_t>(true, reclaimChunkSize, reclaimThreshold);
+}
+
+TEST_P(QueueTest, list_queue_reclaim_release) {
+    QueueTest::ReclaimTest<qtype, queue_test_type_t>(reclaimChunkSize, reclaimThreshold);
+}
+
+TEST_P(QueueTest, list_queue_shrink) {
+    QueueTest::ShrinkTest<qtype, queue_test_type_t>(shrinkChunkSize);
+}
+
+TEST_P(QueueTest, list_queue_shrink_concurrent) {
+    QueueTest::ShrinkWhileRunningTest<qtype, queue_test_type_t>(shrinkChunkSize, shrinkChunkSize * 4);
+}
+
+TEST_P(QueueTest, multi_list_queue_numa) {
+    QueueTest::TemplatedTest<nmqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_list_queue_stealing) {
+    QueueTest::TemplatedTest<smqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_list_queue_stealing_bulk) {
+    QueueTest::BulkTest<smqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_list_queue_stealing_sweep) {
+    QueueTest::SweepTest<smqtype, queue_test_type_t>(sweepSubqueues);
+}
+
+TEST_P(QueueTest, multi_list_queue_stealing_emplace) {
+    QueueTest::EmplaceTest<smeqtype, MoveOnlyThing>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_list_queue_exit_during_destruction) {
+    QueueTest::ExitDuringDestructionTest<smqtype, queue_test_type_t>(exitRounds, exitThreads, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_list_queue_token) {
+    QueueTest::TokenTest<mqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_list_queue_priority) {
+    QueueTest::PriorityTest<prqtype, queue_test_type_t, 3>(_params.subqueueSize, starvationRatio);
+}
+
+TEST_P(QueueTest, multi_list_queue_priority_order) {
+    QueueTest::PriorityOrderTest<prqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_list_queue_priority_recovery) {
+    QueueTest::PriorityRecoveryTest<prqtype, queue_test_type_t, 3>(priorityItems, _params.subqueueSize, starvationRatio);
+}
+
+TEST_P(QueueTest, multi_list_queue_priority_strict) {
+    QueueTest::PriorityTest<prqtype, queue_test_type_t, 3>(_params.subqueueSize, size_t(0));
+}
+
+TEST_P(QueueTest, multi_list_queue_relaxed) {
+    QueueTest::TemplatedTest<rmqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_list_queue_relaxed_bulk) {
+    QueueTest::BulkTest<rmqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_list_queue_adaptive) {
+    QueueTest::AdaptiveTest<amqtype, queue_test_type_t>(size_t(1), _params.subqueueSize, size_t(0));
+}
+
+TEST_P(QueueTest, multi_list_queue_adaptive_stealing) {
+    QueueTest::AdaptiveTest<asmqtype, queue_test_type_t>(size_t(1), _params.subqueueSize, size_t(0));
+}
+
+//a subqueue is retired once its producer leaves, and consumers stop visiting it once it is empty
+TEST_P(QueueTest, multi_list_queue_adaptive_retire) {
+    if (_params.nReaders != 1 || _params.nWriters != 1) return;
+    amqtype q(2, 4, 0);
+    auto first = q.make_producer_token();
+    {
+        auto second = q.make_producer_token();
+        q.enqueue(second, queue_test_type_t(7));
+    }
+    EXPECT_EQ(q.adapt(), size_t(1));
+    queue_test_type_t res;
+    ASSERT_TRUE(q.mc_dequeue(res));
+    EXPECT_EQ(res, queue_test_type_t(7));
+    EXPECT_EQ(q.adapt(), size_t(1));
+    EXPECT_EQ(q.active_subqueues(), size_t(1));
+    q.enqueue(first, queue_test_type_t(8));
+    ASSERT_TRUE(q.mc_dequeue(res));
+    EXPECT_EQ(res, queue_test_type_t(8));
+    EXPECT_FALSE(q.mc_dequeue(res));
+}
+
+}
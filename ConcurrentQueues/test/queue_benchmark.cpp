@@ -0,0 +1,310 @@
+/*
+ * File:   queue_benchmark.cpp
+ * Author: Barath Kannan
+ * Google Benchmark microbenchmarks for every queue type, with a size_t and a 264 byte payload:
+ * single_op: one enqueue and one dequeue per iteration on an otherwise idle queue
+ * uncontended_throughput: batches of single producer enqueues followed by single consumer dequeues
+ * contended_pairs: every thread enqueues and then dequeues an item per iteration, over 1 to 16 threads
+ * (all but the spsc queue)
+ * Benchmark threads are pinned to cpus in order of their thread index, --pin_threads=false disables it.
+ * Results can be written as JSON with --benchmark_out=<file> --benchmark_out_format=json.
+ * The external queues the build found (see external_queue.h) run the same scenarios, and
+ * --comparison_report=<file> writes a markdown table of every queue's items per second with
+ * one column per scenario and contended_pairs thread count, the scaling curve of each queue.
+ * Created on 14 October 2026 11:59 PM
+ */
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <thread>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <type_traits>
+#include <bk_conq/multi_bounded_queue.hpp>
+#include <bk_conq/multi_unbounded_queue.hpp>
+#include <bk_conq/bounded_list_queue.hpp>
+#include <bk_conq/vector_queue.hpp>
+#include <bk_conq/spsc_vector_queue.hpp>
+#include <bk_conq/list_queue.hpp>
+#include <bk_conq/chain_queue.hpp>
+#include <bk_conq/segment_queue.hpp>
+#include <map>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include "external_queue.h"
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+const size_t queue_size = 8192;
+const size_t subqueues = 8;
+const size_t batch_size = 256;
+bool pin_threads = true;
+
+//the same layout as BigThing in concurrent_queue_test.h
+struct big_thing {
+    size_t value;
+    char padding[256];
+    big_thing() {}
+    big_thing(const size_t& v) : value(v) {}
+};
+
+void pin_thread(size_t index) {
+#if defined(__linux__)
+    if (!pin_threads) return;
+    size_t cpus = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % cpus, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)index;
+#endif
+}
+
+//factories construct the queue under test, Q::value_type is the payload
+template <typename Q>
+struct bounded {
+    typedef Q queue_type;
+    static std::unique_ptr<Q> make() { return std::make_unique<Q>(queue_size); }
+};
+
+template <typename Q>
+struct unbounded {
+    typedef Q queue_type;
+    static std::unique_ptr<Q> make() { return std::make_unique<Q>(); }
+};
+
+template <typename Q>
+struct multi_bounded {
+    typedef Q queue_type;
+    static std::unique_ptr<Q> make() { return std::make_unique<Q>(queue_size, subqueues); }
+};
+
+template <typename Q>
+struct multi_unbounded {
+    typedef Q queue_type;
+    static std::unique_ptr<Q> make() { return std::make_unique<Q>(subqueues); }
+};
+
+//bounded enqueues are retried until there is space
+template <typename Q, typename R>
+void enqueue(Q& q, R&& item, bool single, std::true_type) {
+    while (!(single ? q.sp_enqueue(item) : q.mp_enqueue(item))) { std::this_thread::yield(); }
+}
+
+template <typename Q, typename R>
+void enqueue(Q& q, R&& item, bool single, std::false_type) {
+    if (single) q.sp_enqueue(std::forward<R>(item));
+    else q.mp_enqueue(std::forward<R>(item));
+}
+
+template <typename Q, typename R>
+void enqueue(Q& q, R&& item, bool single) {
+    enqueue(q, std::forward<R>(item), single, typename std::is_base_of<bk_conq::bounded_queue_tag, Q>::type());
+}
+
+template <typename Q, typename T>
+void dequeue(Q& q, T& item, bool single) {
+    while (!(single ? q.sc_dequeue(item) : q.mc_dequeue(item))) { std::this_thread::yield(); }
+}
+
+template <typename FACTORY>
+void single_op(benchmark::State& state) {
+    typedef typename FACTORY::queue_type Q;
+    pin_thread(0);
+    auto q = FACTORY::make();
+    typename Q::value_type item(0);
+    for (auto _ : state) {
+        enqueue(*q, item, false);
+        dequeue(*q, item, false);
+        benchmark::DoNotOptimize(item);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename FACTORY>
+void uncontended_throughput(benchmark::State& state) {
+    typedef typename FACTORY::queue_type Q;
+    pin_thread(0);
+    auto q = FACTORY::make();
+    typename Q::value_type item(0);
+    for (auto _ : state) {
+        for (size_t i = 0; i < batch_size; ++i) enqueue(*q, item, true);
+        for (size_t i = 0; i < batch_size; ++i) dequeue(*q, item, true);
+        benchmark::DoNotOptimize(item);
+    }
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+//the queue is shared by the benchmark threads, thread 0 creates it before the timing loop, which no thread
+//enters until every thread has reached it
+template <typename FACTORY>
+void contended_pairs(benchmark::State& state) {
+    typedef typename FACTORY::queue_type Q;
+    static std::unique_ptr<Q> q;
+    pin_thread(state.thread_index());
+    if (state.thread_index() == 0) q = FACTORY::make();
+    typename Q::value_type item(0);
+    for (auto _ : state) {
+        enqueue(*q, item, false);
+        dequeue(*q, item, false);
+        benchmark::DoNotOptimize(item);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) q.reset();
+}
+
+template <typename T> using vector_queue = bk_conq::vector_queue<T>;
+template <typename T> using spsc_vector_queue = bk_conq::spsc_vector_queue<T>;
+template <typename T> using bounded_list_queue = bk_conq::bounded_list_queue<T>;
+template <typename T> using list_queue = bk_conq::list_queue<T>;
+template <typename T> using chain_queue = bk_conq::chain_queue<T>;
+template <typename T> using segment_queue = bk_conq::segment_queue<T>;
+template <typename T> using multi_vector_queue = bk_conq::multi_bounded_queue<bk_conq::vector_queue<T>>;
+template <typename T> using multi_list_queue = bk_conq::multi_unbounded_queue<bk_conq::list_queue<T>>;
+template <typename T> using multi_chain_queue = bk_conq::multi_unbounded_queue<bk_conq::chain_queue<T>>;
+#if defined(BK_CONQ_EXTERNAL_MOODYCAMEL)
+template <typename T> using moody_queue = external::external_queue<external::moodycamel_queue<T>>;
+template <typename T> using moody_token_queue = external::external_queue<external::moodycamel_token_queue<T>>;
+template <typename T> using moody_bounded_queue = external::external_queue<external::moodycamel_bounded_queue<T>>;
+template <typename T> using moody_reader_writer_queue = external::external_queue<external::moodycamel_reader_writer_queue<T>>;
+#endif
+#if defined(BK_CONQ_EXTERNAL_FOLLY)
+template <typename T> using folly_mpmc_queue = external::external_queue<external::folly_mpmc_queue<T>>;
+#endif
+#if defined(BK_CONQ_EXTERNAL_BOOST)
+template <typename T> using boost_lockfree_queue = external::external_queue<external::boost_lockfree_queue<T>>;
+template <typename T> using boost_spsc_queue = external::external_queue<external::boost_spsc_queue<T>>;
+#endif
+
+//passes every run on to the console and keeps the items per second of each queue for the comparison report,
+//runs are named scenario<factory<queue<payload>>>, each factory<queue<payload>> is a row and repetitions are averaged
+class comparison_reporter : public benchmark::ConsoleReporter {
+public:
+    void ReportRuns(const std::vector<Run>& reports) override {
+        benchmark::ConsoleReporter::ReportRuns(reports);
+        for (const Run& run : reports) {
+            if (run.error_occurred || run.run_type != Run::RT_Iteration) continue;
+            auto rate = run.counters.find("items_per_second");
+            if (rate == run.counters.end()) continue;
+            const std::string& name = run.run_name.function_name;
+            size_t open = name.find('<');
+            if (open == std::string::npos) continue;
+            std::string column = name.substr(0, open);
+            if (column == "contended_pairs") column += "/" + std::to_string(run.threads);
+            std::string row = name.substr(open + 1, name.size() - open - 2);
+            if (_rows.emplace(row, _order.size()).second) _order.push_back(row);
+            if (_columns.emplace(column, _column_order.size()).second) _column_order.push_back(column);
+            auto& cell = _cells[row][column];
+            cell.first += rate->second.value;
+            ++cell.second;
+        }
+    }
+
+    //millions of items per second, - where a queue did not run a scenario
+    void write(std::ostream& out) const {
+        out << "| queue |";
+        for (auto& column : _column_order) out << " " << column << " |";
+        out << "\n|---|";
+        for (size_t i = 0; i < _column_order.size(); ++i) out << "---|";
+        out << "\n" << std::fixed << std::setprecision(2);
+        for (auto& row : _order) {
+            out << "| " << row << " |";
+            auto& cells = _cells.at(row);
+            for (auto& column : _column_order) {
+                auto cell = cells.find(column);
+                if (cell == cells.end()) out << " - |";
+                else out << " " << cell->second.first / cell->second.second / 1e6 << " |";
+            }
+            out << "\n";
+        }
+    }
+
+private:
+    //rows and columns in the order they were first reported
+    std::map<std::string, size_t> _rows;
+    std::vector<std::string> _order;
+    std::map<std::string, size_t> _columns;
+    std::vector<std::string> _column_order;
+    //the sum of the items per second and the number of runs
+    std::map<std::string, std::map<std::string, std::pair<double, size_t>>> _cells;
+};
+
+}
+
+#define BK_CONQ_UNCONTENDED_BENCHMARKS(FACTORY) \
+    BENCHMARK_TEMPLATE(single_op, FACTORY); \
+    BENCHMARK_TEMPLATE(uncontended_throughput, FACTORY)
+
+#define BK_CONQ_QUEUE_BENCHMARKS(FACTORY) \
+    BK_CONQ_UNCONTENDED_BENCHMARKS(FACTORY); \
+    BENCHMARK_TEMPLATE(contended_pairs, FACTORY)->ThreadRange(1, 16)->UseRealTime()
+
+#define BK_CONQ_PAYLOAD_BENCHMARKS(FACTORY, QUEUE) \
+    BK_CONQ_QUEUE_BENCHMARKS(FACTORY<QUEUE<size_t>>); \
+    BK_CONQ_QUEUE_BENCHMARKS(FACTORY<QUEUE<big_thing>>)
+
+//the spsc queue only supports a single producer and consumer, so it is not contended
+#define BK_CONQ_SPSC_PAYLOAD_BENCHMARKS(FACTORY, QUEUE) \
+    BK_CONQ_UNCONTENDED_BENCHMARKS(FACTORY<QUEUE<size_t>>); \
+    BK_CONQ_UNCONTENDED_BENCHMARKS(FACTORY<QUEUE<big_thing>>)
+
+BK_CONQ_PAYLOAD_BENCHMARKS(bounded, vector_queue);
+BK_CONQ_SPSC_PAYLOAD_BENCHMARKS(bounded, spsc_vector_queue);
+BK_CONQ_PAYLOAD_BENCHMARKS(bounded, bounded_list_queue);
+BK_CONQ_PAYLOAD_BENCHMARKS(unbounded, list_queue);
+BK_CONQ_PAYLOAD_BENCHMARKS(unbounded, chain_queue);
+BK_CONQ_PAYLOAD_BENCHMARKS(unbounded, segment_queue);
+BK_CONQ_PAYLOAD_BENCHMARKS(multi_bounded, multi_vector_queue);
+BK_CONQ_PAYLOAD_BENCHMARKS(multi_unbounded, multi_list_queue);
+BK_CONQ_PAYLOAD_BENCHMARKS(multi_unbounded, multi_chain_queue);
+#if defined(BK_CONQ_EXTERNAL_MOODYCAMEL)
+BK_CONQ_PAYLOAD_BENCHMARKS(unbounded, moody_queue);
+BK_CONQ_PAYLOAD_BENCHMARKS(unbounded, moody_token_queue);
+BK_CONQ_PAYLOAD_BENCHMARKS(bounded, moody_bounded_queue);
+BK_CONQ_SPSC_PAYLOAD_BENCHMARKS(unbounded, moody_reader_writer_queue);
+#endif
+#if defined(BK_CONQ_EXTERNAL_FOLLY)
+BK_CONQ_PAYLOAD_BENCHMARKS(bounded, folly_mpmc_queue);
+#endif
+#if defined(BK_CONQ_EXTERNAL_BOOST)
+BK_CONQ_PAYLOAD_BENCHMARKS(bounded, boost_lockfree_queue);
+BK_CONQ_SPSC_PAYLOAD_BENCHMARKS(bounded, boost_spsc_queue);
+#endif
+
+//--pin_threads=false and --comparison_report=<file> are consumed here, every other argument is passed to google benchmark
+int main(int argc, char** argv) {
+    const char report_flag[] = "--comparison_report=";
+    std::string report_file;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--pin_threads=false") == 0) pin_threads = false;
+        else if (std::strcmp(argv[i], "--pin_threads=true") == 0) pin_threads = true;
+        else if (std::strncmp(argv[i], report_flag, sizeof(report_flag) - 1) == 0) report_file = argv[i] + sizeof(report_flag) - 1;
+        else args.push_back(argv[i]);
+    }
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+    if (report_file.empty()) {
+        benchmark::RunSpecifiedBenchmarks();
+    }
+    else {
+        comparison_reporter reporter;
+        benchmark::RunSpecifiedBenchmarks(&reporter);
+        std::ofstream out(report_file);
+        reporter.write(out);
+        if (!out) {
+            std::cerr << "could not write " << report_file << std::endl;
+            return 1;
+        }
+    }
+    benchmark::Shutdown();
+    return 0;
+}
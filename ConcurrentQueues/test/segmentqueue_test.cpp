@@ -0,0 +1,94 @@
+#include "concurrent_queue_test.h"
+
+namespace SegmentQueue {
+using qtype = bk_conq::segment_queue<QueueTest::queue_test_type_t>;
+using mqtype = bk_conq::multi_unbounded_queue<qtype>;
+using eqtype = bk_conq::segment_queue<MoveOnlyThing>;
+using meqtype = bk_conq::multi_unbounded_queue<eqtype>;
+using bqtype = bk_conq::blocking_unbounded_queue<qtype>;
+using bmqtype = bk_conq::blocking_unbounded_queue<mqtype>;
+using ssqtype = bk_conq::segment_queue<QueueTest::queue_test_type_t, 64>;
+using mssqtype = bk_conq::multi_unbounded_queue<ssqtype>;
+using cardqtype = bk_conq::segment_queue<QueueTest::queue_test_type_t, 1024, std::allocator<QueueTest::queue_test_type_t>, bk_conq::producers::single, bk_conq::consumers::single>;
+using cardmqtype = bk_conq::multi_unbounded_queue<qtype, qtype::value_type, bk_conq::round_robin_assignment, bk_conq::hitlist_dequeue, bk_conq::no_stats, bk_conq::producers::single>;
+
+//segments available in the pool up front for the pooled tests
+static const size_t poolSegments = 64;
+
+TEST_P(QueueTest, segment_queue) {
+    QueueTest::TemplatedTest<qtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, segment_queue_blocking) {
+    QueueTest::BlockingTest<bqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_segment_queue) {
+    QueueTest::TemplatedTest<mqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, segment_queue_size) {
+    QueueTest::SizeTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_segment_queue_size) {
+    QueueTest::SizeTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, segment_queue_emplace) {
+    QueueTest::EmplaceTest<eqtype, MoveOnlyThing>();
+}
+
+TEST_P(QueueTest, multi_segment_queue_emplace) {
+    QueueTest::EmplaceTest<meqtype, MoveOnlyThing>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, segment_queue_consume) {
+    QueueTest::ConsumeTest<qtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_segment_queue_consume) {
+    QueueTest::ConsumeTest<mqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, segment_queue_cardinality) {
+    QueueTest::CardinalityTest<cardqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_segment_queue_cardinality) {
+    QueueTest::CardinalityTest<cardmqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_segment_queue_blocking) {
+    QueueTest::BlockingTest<bmqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, segment_queue_prefill) {
+    QueueTest::TemplatedTest<qtype, queue_test_type_t>(true);
+}
+
+TEST_P(QueueTest, multi_segment_queue_prefill) {
+    QueueTest::TemplatedTest<mqtype, queue_test_type_t>(true, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, segment_queue_bulk) {
+    QueueTest::BulkTest<qtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_segment_queue_bulk) {
+    QueueTest::BulkTest<mqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, segment_queue_small_segment) {
+    QueueTest::TemplatedTest<ssqtype, queue_test_type_t>(false);
+}
+
+TEST_P(QueueTest, multi_segment_queue_small_segment) {
+    QueueTest::TemplatedTest<mssqtype, queue_test_type_t>(false, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, segment_queue_pooled) {
+    QueueTest::TemplatedTest<qtype, queue_test_type_t>(false, poolSegments);
+}
+
+}
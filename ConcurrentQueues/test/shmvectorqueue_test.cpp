@@ -0,0 +1,140 @@
+#include "concurrent_queue_test.h"
+#include <bk_conq/shm_vector_queue.hpp>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#include <string>
+
+namespace ShmVectorQueue {
+using shmtype = bk_conq::shm_vector_queue<QueueTest::queue_test_type_t>;
+
+//each queue gets a region of its own, which is unlinked once mapped so that none outlive the test
+static std::string uniqueName() {
+    static std::atomic<size_t> counter{ 0 };
+    return "/bk_conq_test_" + std::to_string(getpid()) + "_" + std::to_string(counter++);
+}
+
+class test_queue : public shmtype {
+public:
+    explicit test_queue(size_t N) : test_queue(uniqueName(), N) {}
+
+private:
+    test_queue(const std::string& name, size_t N) : shmtype(name, N) {
+        shmtype::unlink(name);
+    }
+};
+
+using qtype = test_queue;
+using bqtype = bk_conq::blocking_bounded_queue<qtype>;
+
+TEST_P(QueueTest, shm_vector_queue) {
+    QueueTest::TemplatedTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, shm_vector_queue_blocking) {
+    QueueTest::BlockingTest<bqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, shm_vector_queue_bulk) {
+    QueueTest::BulkTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, shm_vector_queue_spsc) {
+    QueueTest::SpscTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, shm_vector_queue_size) {
+    QueueTest::SizeTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, shm_vector_queue_consume) {
+    QueueTest::ConsumeTest<qtype, queue_test_type_t>();
+}
+
+//a second mapping of the region, attached by name, sees the items of the first
+TEST_P(QueueTest, shm_vector_queue_attach) {
+    if (_params.nReaders != 1 || _params.nWriters != 1) return;
+    std::string name = uniqueName();
+    shmtype creator(name, _params.queueSize);
+    shmtype attached(name);
+    shmtype::unlink(name);
+    EXPECT_EQ(attached.capacity(), _params.queueSize);
+    for (size_t j = 0; j < _params.queueSize; ++j) ASSERT_TRUE(creator.sp_enqueue(j));
+    EXPECT_FALSE(attached.sp_enqueue(0));
+    queue_test_type_t res;
+    for (size_t j = 0; j < _params.queueSize; ++j) {
+        ASSERT_TRUE(attached.sc_dequeue(res));
+        EXPECT_EQ(res, j);
+    }
+    EXPECT_FALSE(creator.sc_dequeue(res));
+}
+
+//attaching with a different number of slots or a different item type is refused
+TEST_P(QueueTest, shm_vector_queue_layout) {
+    if (_params.nReaders != 1 || _params.nWriters != 1) return;
+    std::string name = uniqueName();
+    shmtype creator(name, _params.queueSize);
+    EXPECT_THROW(shmtype(name, _params.queueSize * 2), std::runtime_error);
+    EXPECT_THROW(bk_conq::shm_vector_queue<uint32_t>(name, _params.queueSize), std::runtime_error);
+    shmtype::unlink(name);
+    EXPECT_THROW(shmtype{ name }, std::system_error);
+}
+
+//a forked producer process hands the items over through the shared mapping
+TEST_P(QueueTest, shm_vector_queue_process) {
+    if (_params.nReaders != 1 || _params.nWriters != 1) return;
+    qtype q(_params.queueSize);
+    const size_t count = _params.queueSize * 4;
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        for (size_t j = 0; j < count; ++j) {
+            while (!q.sp_enqueue(j)) {}
+        }
+        _exit(0);
+    }
+    queue_test_type_t res;
+    for (size_t j = 0; j < count; ++j) {
+        while (!q.sc_dequeue(res)) {}
+        ASSERT_EQ(res, j);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+//a consumer process is killed while it dequeues, the consumer that takes over reattaches and receives
+//every item from the first one the dead consumer had not released, in order
+TEST_P(QueueTest, shm_vector_queue_reattach) {
+    if (_params.nReaders != 1 || _params.nWriters != 1) return;
+    qtype q(_params.queueSize);
+    const size_t count = _params.queueSize * 4;
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        queue_test_type_t res;
+        while (true) q.sc_dequeue(res);
+    }
+    size_t j = 0;
+    for (; j < count / 2; ++j) {
+        while (!q.sp_enqueue(j)) {}
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    q.reattach_consumer();
+    queue_test_type_t res;
+    bool first = true;
+    queue_test_type_t expected = 0;
+    while (j < count || q.size_approx()) {
+        if (j < count && q.sp_enqueue(j)) ++j;
+        if (q.sc_dequeue(res)) {
+            if (first) EXPECT_LE(res, count / 2);
+            else ASSERT_EQ(res, expected);
+            first = false;
+            expected = res + 1;
+        }
+    }
+    EXPECT_EQ(expected, count);
+}
+
+}
@@ -0,0 +1,72 @@
+#include "concurrent_queue_test.h"
+
+namespace SpscVectorQueue {
+using qtype = bk_conq::spsc_vector_queue<QueueTest::queue_test_type_t>;
+using mqtype = bk_conq::multi_bounded_queue<qtype>;
+using eqtype = bk_conq::spsc_vector_queue<MoveOnlyThing>;
+using meqtype = bk_conq::multi_bounded_queue<eqtype>;
+using bqtype = bk_conq::blocking_bounded_queue<qtype>;
+using cardqtype = bk_conq::spsc_vector_queue<QueueTest::queue_test_type_t, bk_conq::yield_strategy, std::allocator<QueueTest::queue_test_type_t>, bk_conq::producers::single, bk_conq::consumers::single>;
+using cardmqtype = bk_conq::multi_bounded_queue<qtype, qtype::value_type, bk_conq::round_robin_assignment, bk_conq::hitlist_dequeue, bk_conq::no_stats, bk_conq::producers::single>;
+
+TEST_P(QueueTest, spsc_vector_queue) {
+    QueueTest::SpscTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, spsc_vector_queue_locked) {
+    QueueTest::TemplatedTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, spsc_vector_queue_blocking) {
+    QueueTest::BlockingTest<bqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, spsc_vector_queue_bulk) {
+    QueueTest::BulkTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_spsc_vector_queue) {
+    QueueTest::TemplatedTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, spsc_vector_queue_size) {
+    QueueTest::SizeTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_spsc_vector_queue_size) {
+    QueueTest::SizeTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, spsc_vector_queue_emplace) {
+    QueueTest::EmplaceTest<eqtype, MoveOnlyThing>();
+}
+
+TEST_P(QueueTest, multi_spsc_vector_queue_emplace) {
+    QueueTest::EmplaceTest<meqtype, MoveOnlyThing>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, spsc_vector_queue_consume) {
+    QueueTest::ConsumeTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_spsc_vector_queue_consume) {
+    QueueTest::ConsumeTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, spsc_vector_queue_cardinality) {
+    QueueTest::CardinalityTest<cardqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_spsc_vector_queue_cardinality) {
+    QueueTest::CardinalityTest<cardmqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, spsc_vector_queue_reserve) {
+    QueueTest::SpscReserveTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_spsc_vector_queue_bulk) {
+    QueueTest::BulkTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+}
@@ -3,8 +3,31 @@
 namespace VectorQueue {
 using qtype = bk_conq::vector_queue<QueueTest::queue_test_type_t>;
 using mqtype = bk_conq::multi_bounded_queue<qtype>;
+using eqtype = bk_conq::vector_queue<MoveOnlyThing>;
+using meqtype = bk_conq::multi_bounded_queue<eqtype>;
 using bqtype = bk_conq::blocking_bounded_queue<qtype>;
 using bmqtype = bk_conq::blocking_bounded_queue<mqtype>;
+using bcqtype = bk_conq::blocking_bounded_queue<qtype, bk_conq::condition_variable_wait_policy>;
+using bsqtype = bk_conq::blocking_bounded_queue<qtype, bk_conq::spin_wait_policy<>>;
+using pqtype = bk_conq::vector_queue<QueueTest::queue_test_type_t, bk_conq::slot_layout::padded>;
+using sqtype = bk_conq::vector_queue<QueueTest::queue_test_type_t, bk_conq::slot_layout::split>;
+using scqtype = bk_conq::vector_queue<QueueTest::queue_test_type_t, bk_conq::slot_layout::split, true>;
+using pcqtype = bk_conq::vector_queue<QueueTest::queue_test_type_t, bk_conq::slot_layout::packed, true>;
+using hpqtype = bk_conq::vector_queue<QueueTest::queue_test_type_t, bk_conq::slot_layout::packed, false, bk_conq::page_allocator<QueueTest::queue_test_type_t>>;
+using nmqtype = bk_conq::multi_bounded_queue<qtype, qtype::value_type, bk_conq::numa_assignment>;
+using smqtype = bk_conq::multi_bounded_queue<qtype, qtype::value_type, bk_conq::round_robin_assignment, bk_conq::stealing_dequeue<>>;
+using rmqtype = bk_conq::multi_bounded_queue<qtype, qtype::value_type, bk_conq::random_assignment, bk_conq::two_choice_dequeue>;
+using prqtype = bk_conq::multi_priority_queue<qtype, 3>;
+using stqtype = bk_conq::vector_queue<QueueTest::queue_test_type_t, bk_conq::slot_layout::packed, false, std::allocator<QueueTest::queue_test_type_t>, bk_conq::sharded_stats<>>;
+using smstqtype = bk_conq::multi_bounded_queue<stqtype, stqtype::value_type, bk_conq::round_robin_assignment, bk_conq::hitlist_dequeue, bk_conq::sharded_stats<>>;
+using cardqtype = bk_conq::vector_queue<QueueTest::queue_test_type_t, bk_conq::slot_layout::packed, false, std::allocator<QueueTest::queue_test_type_t>, bk_conq::no_stats, bk_conq::producers::single, bk_conq::consumers::single>;
+using cardmqtype = bk_conq::multi_bounded_queue<qtype, qtype::value_type, bk_conq::round_robin_assignment, bk_conq::hitlist_dequeue, bk_conq::no_stats, bk_conq::producers::single>;
+
+//starvation ratio used by the priority tests
+static const size_t starvationRatio = 4;
+
+//items handed between a producer and a consumer one at a time by the priority recovery tests
+static const size_t priorityItems = 10000;
 
 TEST_P(QueueTest, vector_queue) {
     QueueTest::TemplatedTest<qtype, queue_test_type_t>();
@@ -14,12 +37,156 @@ TEST_P(QueueTest, vector_queue_blocking) {
     QueueTest::BlockingTest<bqtype, queue_test_type_t>();
 }
 
+TEST_P(QueueTest, vector_queue_blocking_condvar) {
+    QueueTest::BlockingTest<bcqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, vector_queue_blocking_spin) {
+    QueueTest::BlockingTest<bsqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, vector_queue_blocking_timed) {
+    QueueTest::TimedTest<bqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, vector_queue_blocking_batch) {
+    QueueTest::BatchTest<bqtype, queue_test_type_t>(false, _params.queueSize);
+}
+
+TEST_P(QueueTest, multi_vector_queue_blocking_batch) {
+    QueueTest::BatchTest<bmqtype, queue_test_type_t>(false, _params.queueSize, _params.subqueueSize);
+}
+
+TEST_P(QueueTest, vector_queue_blocking_batch_deadline) {
+    QueueTest::BatchDeadlineTest<bqtype, queue_test_type_t>(_params.queueSize);
+}
+
 TEST_P(QueueTest, multi_vector_queue) {
     QueueTest::TemplatedTest<mqtype, queue_test_type_t>(_params.subqueueSize);
 }
 
+TEST_P(QueueTest, vector_queue_size) {
+    QueueTest::SizeTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_vector_queue_size) {
+    QueueTest::SizeTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, vector_queue_emplace) {
+    QueueTest::EmplaceTest<eqtype, MoveOnlyThing>();
+}
+
+TEST_P(QueueTest, multi_vector_queue_emplace) {
+    QueueTest::EmplaceTest<meqtype, MoveOnlyThing>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, vector_queue_consume) {
+    QueueTest::ConsumeTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_vector_queue_consume) {
+    QueueTest::ConsumeTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, vector_queue_cardinality) {
+    QueueTest::CardinalityTest<cardqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_vector_queue_cardinality) {
+    QueueTest::CardinalityTest<cardmqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, vector_queue_reserve) {
+    QueueTest::ReserveTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, vector_queue_stats) {
+    QueueTest::StatsTest<stqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_vector_queue_stats) {
+    QueueTest::StatsTest<smstqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
 TEST_P(QueueTest, multi_vector_queue_blocking) {
     QueueTest::BlockingTest<bmqtype, queue_test_type_t>(_params.subqueueSize);
 }
 
-}
\ No newline at end of file
+TEST_P(QueueTest, vector_queue_bulk) {
+    QueueTest::BulkTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, vector_queue_bulk_fill) {
+    QueueTest::BulkFillTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, multi_vector_queue_bulk) {
+    QueueTest::BulkTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, vector_queue_spsc) {
+    QueueTest::SpscTest<qtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, vector_queue_padded) {
+    QueueTest::TemplatedTest<pqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, vector_queue_split) {
+    QueueTest::TemplatedTest<sqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, vector_queue_split_scrambled) {
+    QueueTest::TemplatedTest<scqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, vector_queue_packed_scrambled) {
+    QueueTest::TemplatedTest<pcqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, vector_queue_split_scrambled_bulk) {
+    QueueTest::BulkTest<scqtype, queue_test_type_t>();
+}
+
+TEST_P(QueueTest, vector_queue_huge_pages) {
+    QueueTest::TemplatedTest<hpqtype, queue_test_type_t>(hugePageAllocator());
+}
+
+TEST_P(QueueTest, multi_vector_queue_numa) {
+    QueueTest::TemplatedTest<nmqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_vector_queue_stealing) {
+    QueueTest::TemplatedTest<smqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_vector_queue_stealing_bulk) {
+    QueueTest::BulkTest<smqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_vector_queue_token) {
+    QueueTest::TokenTest<mqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_vector_queue_priority) {
+    QueueTest::PriorityTest<prqtype, queue_test_type_t, 3>(_params.subqueueSize, starvationRatio, _params.queueSize);
+}
+
+TEST_P(QueueTest, multi_vector_queue_priority_order) {
+    QueueTest::PriorityOrderTest<prqtype, queue_test_type_t>(_params.queueSize);
+}
+
+TEST_P(QueueTest, multi_vector_queue_priority_recovery) {
+    QueueTest::PriorityRecoveryTest<prqtype, queue_test_type_t, 3>(priorityItems, _params.subqueueSize, starvationRatio, _params.queueSize);
+}
+
+TEST_P(QueueTest, multi_vector_queue_relaxed) {
+    QueueTest::TemplatedTest<rmqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+TEST_P(QueueTest, multi_vector_queue_relaxed_bulk) {
+    QueueTest::BulkTest<rmqtype, queue_test_type_t>(_params.subqueueSize);
+}
+
+}